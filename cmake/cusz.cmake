@@ -1,6 +1,7 @@
 add_compile_definitions(PSZ_USE_CUDA)
 
 find_package(CUDAToolkit REQUIRED)
+find_package(Threads REQUIRED)
 
 include(GNUInstallDirs)
 include(CTest)
@@ -35,8 +36,9 @@ option(PSZ_REACTIVATE_THRUSTGPU
 add_library(psztime src/utils/timer_cpu.cc src/utils/timer_gpu.cc)
 target_link_libraries(psztime PUBLIC pszcompile_settings CUDA::cudart)
 
-add_library(pszstat_ser src/stat/compare_cpu.cc)
-target_link_libraries(pszstat_ser PUBLIC pszcompile_settings)
+add_library(pszstat_ser src/stat/compare_cpu.cc
+            src/stat/compare_stream.cc src/stat/spatial_cpu.cc)
+target_link_libraries(pszstat_ser PUBLIC pszcompile_settings Threads::Threads)
 
 if(PSZ_REACTIVATE_THRUSTGPU)
   add_compile_definitions(REACTIVATE_THRUSTGPU)
@@ -63,6 +65,15 @@ add_library(pszkernel_ser src/kernel/l23_ser.cc src/kernel/hist_ser.cc
                           src/kernel/histsp_ser.cc)
 target_link_libraries(pszkernel_ser PUBLIC pszcompile_settings)
 
+add_library(pszkernel_cpu src/kernel/rle_cpu.cc src/kernel/l23_int_cpu.cc
+                          src/kernel/l23_half_cpu.cc src/kernel/logtr_cpu.cc
+                          src/kernel/binning_cpu.cc src/kernel/prog_cpu.cc
+                          src/kernel/dryrun_cpu.cc src/kernel/estimate_cpu.cc
+                          src/kernel/tile_cpu.cc)
+target_link_libraries(pszkernel_cpu PUBLIC pszcompile_settings pszhfbook_ser
+                                           pszkernel_ser pszans_cpu
+                                           Threads::Threads)
+
 add_library(
   pszkernel_cu
   src/kernel/dryrun.cu
@@ -77,8 +88,9 @@ target_link_libraries(pszkernel_cu PUBLIC pszcompile_settings)
 add_library(pszmem src/mem/memseg.cc src/mem/memseg_cu.cc)
 target_link_libraries(pszmem PUBLIC pszcompile_settings CUDA::cudart)
 
-add_library(pszutils_ser src/utils/vis_stat.cc src/context.cc)
-target_link_libraries(pszutils_ser PUBLIC pszcompile_settings)
+add_library(pszutils_ser src/utils/vis_stat.cc src/context.cc
+                         src/utils/subdomain.cc)
+target_link_libraries(pszutils_ser PUBLIC pszcompile_settings pszstat_ser)
 
 add_library(pszspv_cu src/kernel/spv.cu)
 target_link_libraries(pszspv_cu PUBLIC pszcompile_settings)
@@ -105,20 +117,26 @@ add_library(
                 src/hf/hf_bk_internal.cc src/hf/hf_bk.cc src/hf/hf_canon.cc)
 target_link_libraries(pszhfbook_ser PUBLIC pszcompile_settings)
 
+add_library(pszans_cpu src/ans/ans_cpu.cc)
+target_link_libraries(pszans_cpu PUBLIC pszcompile_settings Threads::Threads)
+
 add_library(pszhf_cu src/hf/hf_obj.cu src/hf/hf_codec.cu)
 if(PSZ_RESEARCH_HUFFBK_CUDA)
   target_link_libraries(pszhf_cu PUBLIC pszcompile_settings pszstat_cu
-                                        pszhfbook_cu pszhfbook_ser)
+                                        pszhfbook_cu pszhfbook_ser pszans_cpu)
 else()
-  target_link_libraries(pszhf_cu PUBLIC pszcompile_settings pszstat_cu
-                                        pszhfbook_ser CUDA::cuda_driver)
+  target_link_libraries(
+    pszhf_cu PUBLIC pszcompile_settings pszstat_cu pszhfbook_ser pszans_cpu
+                    CUDA::cuda_driver)
 endif(PSZ_RESEARCH_HUFFBK_CUDA)
 # unset(PSZ_RESEARCH_HUFFBK_CUDA CACHE)
 
 # [TODO] maybe a standalone libpszdbg
 add_library(psz_comp src/compressor.cc src/log/sanitize.cc)
-target_link_libraries(psz_comp PUBLIC pszcompile_settings pszkernel_cu
-                                      pszstat_cu pszhf_cu CUDA::cudart)
+target_link_libraries(
+  psz_comp PUBLIC pszcompile_settings pszkernel_cu pszstat_cu pszhf_cu
+                  pszans_cpu pszkernel_cpu pszkernel_ser pszutils_ser
+                  CUDA::cudart)
 
 add_library(cusz src/cusz_lib.cc)
 target_link_libraries(cusz PUBLIC psz_comp pszhf_cu pszspv_cu pszstat_ser
@@ -128,6 +146,9 @@ add_executable(cusz-bin src/cli_cusz.cc)
 target_link_libraries(cusz-bin PRIVATE cusz)
 set_target_properties(cusz-bin PROPERTIES OUTPUT_NAME cusz)
 
+add_executable(cusz-merge src/cli_merge.cc)
+target_link_libraries(cusz-merge PRIVATE pszutils_ser)
+
 # enable examples and testing
 if(PSZ_BUILD_EXAMPLES)
   add_subdirectory(example)
@@ -141,6 +162,7 @@ endif()
 install(TARGETS pszcompile_settings EXPORT CUSZTargets)
 
 install(TARGETS pszkernel_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
+install(TARGETS pszkernel_cpu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszkernel_cu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszstat_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszstat_cu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
@@ -149,10 +171,12 @@ install(TARGETS pszutils_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INST
 install(TARGETS psztime EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszspv_cu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszhfbook_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
+install(TARGETS pszans_cpu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszhf_cu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS psz_comp EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS cusz EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS cusz-bin EXPORT CUSZTargets)
+install(TARGETS cusz-merge EXPORT CUSZTargets)
 if(PSZ_RESEARCH_HUFFBK_CUDA)
   install(TARGETS pszhfbook_cu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 endif(PSZ_RESEARCH_HUFFBK_CUDA)
@@ -1,6 +1,7 @@
 add_compile_definitions(PSZ_USE_HIP)
 
 find_package(hip REQUIRED)
+find_package(Threads REQUIRED)
 
 find_package(rocthrust REQUIRED)
 if(rocthrust_FOUND)
@@ -54,8 +55,9 @@ target_include_directories(
             $<INSTALL_INTERFACE:${CMAKE_INSTALL_INCLUDEDIR}>
             $<INSTALL_INTERFACE:${CMAKE_INSTALL_INCLUDEDIR}/cusz>)
 
-add_library(pszstat_ser src/stat/compare_cpu.cc)
-target_link_libraries(pszstat_ser PUBLIC pszcompile_settings)
+add_library(pszstat_ser src/stat/compare_cpu.cc
+            src/stat/compare_stream.cc src/stat/spatial_cpu.cc)
+target_link_libraries(pszstat_ser PUBLIC pszcompile_settings Threads::Threads)
 
 add_library(
   pszstat_hip src/stat/extrema.hip src/stat/cmpg2.hip src/stat/cmpg4_1.hip
@@ -67,6 +69,15 @@ add_library(pszkernel_ser src/kernel/l23_ser.cc src/kernel/hist_ser.cc
                           src/kernel/histsp_ser.cc)
 target_link_libraries(pszkernel_ser PUBLIC pszcompile_settings)
 
+add_library(pszkernel_cpu src/kernel/rle_cpu.cc src/kernel/l23_int_cpu.cc
+                          src/kernel/l23_half_cpu.cc src/kernel/logtr_cpu.cc
+                          src/kernel/binning_cpu.cc src/kernel/prog_cpu.cc
+                          src/kernel/dryrun_cpu.cc src/kernel/estimate_cpu.cc
+                          src/kernel/tile_cpu.cc)
+target_link_libraries(pszkernel_cpu PUBLIC pszcompile_settings pszhfbook_ser
+                                           pszkernel_ser pszans_cpu
+                                           Threads::Threads)
+
 add_library(pszkernel_hip src/kernel/l23.hip src/kernel/l23r.hip
                           src/kernel/hist.hip src/kernel/histsp.hip
                           src/kernel/dryrun.hip)
@@ -75,8 +86,9 @@ target_link_libraries(pszkernel_hip PUBLIC pszcompile_settings)
 add_library(pszmem src/mem/memseg.cc src/mem/memseg_hip.cc)
 target_link_libraries(pszmem PUBLIC pszcompile_settings hip::host)
 
-add_library(pszutils_ser src/utils/vis_stat.cc src/context.cc)
-target_link_libraries(pszutils_ser PUBLIC pszcompile_settings)
+add_library(pszutils_ser src/utils/vis_stat.cc src/context.cc
+                         src/utils/subdomain.cc)
+target_link_libraries(pszutils_ser PUBLIC pszcompile_settings pszstat_ser)
 
 add_library(pszspv_hip src/kernel/spv.hip)
 target_link_libraries(pszspv_hip PUBLIC pszcompile_settings ${rocthrust_LIBRARIES})
@@ -86,13 +98,18 @@ add_library(
                 src/hf/hf_bk_internal.cc src/hf/hf_bk.cc src/hf/hf_canon.cc)
 target_link_libraries(pszhfbook_ser PUBLIC pszcompile_settings)
 
+add_library(pszans_cpu src/ans/ans_cpu.cc)
+target_link_libraries(pszans_cpu PUBLIC pszcompile_settings Threads::Threads)
+
 add_library(pszhf_hip src/hf/hf_obj.hip src/hf/hf_codec.hip)
 target_link_libraries(pszhf_hip PUBLIC pszcompile_settings pszstat_hip
-                                       pszhfbook_ser hip::device)
+                                       pszhfbook_ser pszans_cpu hip::device)
 
 add_library(psz_comp src/compressor.cc)
-target_link_libraries(psz_comp PUBLIC pszcompile_settings pszkernel_hip
-                                      pszstat_hip pszhf_hip hip::host)
+target_link_libraries(
+  psz_comp PUBLIC pszcompile_settings pszkernel_hip pszstat_hip pszhf_hip
+                  pszans_cpu pszkernel_cpu pszkernel_ser pszutils_ser
+                  hip::host)
 
 add_library(hipsz src/cusz_lib.cc)
 target_link_libraries(hipsz PUBLIC psz_comp pszhf_hip pszspv_hip pszstat_ser
@@ -102,6 +119,9 @@ add_executable(hipsz-bin src/cli_hipsz.cpp)
 target_link_libraries(hipsz-bin PRIVATE hipsz)
 set_target_properties(hipsz-bin PROPERTIES OUTPUT_NAME hipsz)
 
+add_executable(hipsz-merge src/cli_merge.cc)
+target_link_libraries(hipsz-merge PRIVATE pszutils_ser)
+
 # enable examples and testing
 if(PSZ_BUILD_EXAMPLES)
   add_subdirectory(example)
@@ -115,6 +135,7 @@ endif()
 install(TARGETS pszcompile_settings EXPORT CUSZTargets)
 
 install(TARGETS pszkernel_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
+install(TARGETS pszkernel_cpu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszkernel_hip EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszstat_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszstat_hip EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
@@ -122,10 +143,12 @@ install(TARGETS pszmem EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LI
 install(TARGETS pszutils_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszspv_hip EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszhfbook_ser EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
+install(TARGETS pszans_cpu EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS pszhf_hip EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS psz_comp EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS hipsz EXPORT CUSZTargets LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR})
 install(TARGETS hipsz-bin EXPORT CUSZTargets)
+install(TARGETS hipsz-merge EXPORT CUSZTargets)
 
 install(
   EXPORT CUSZTargets
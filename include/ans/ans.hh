@@ -0,0 +1,69 @@
+/**
+ * @file ans.hh
+ * @author Jiannan Tian
+ * @brief Interleaved rANS codec for quant-codes (CPU).
+ * @version 0.4
+ * @date 2023-09-12
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef F3B0C2D6_1A8E_4C55_8E0F_7D1B9A6E2C31
+#define F3B0C2D6_1A8E_4C55_8E0F_7D1B9A6E2C31
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+// Symbol i of a chunk goes to state (lane) i % ANS_LANES. States are 32-bit
+// and renormalized by 16-bit words, so that a symbol emits at most one word.
+constexpr int ANS_LANES = 8;
+constexpr int ANS_PROB_BITS = 15;
+constexpr u4 ANS_LOWER = 1u << 16;
+// Each chunk carries ANS_LANES flushed states; keep chunks long enough.
+constexpr int ANS_MIN_SUBLEN = 1 << 16;
+
+struct alignas(8) ans_header {
+  static const int HEADER = 0;
+  static const int FREQ = 1;
+  static const int PAR_ENTRY = 2;
+  static const int BITSTREAM = 3;
+  static const int END = 4;
+
+  u4 self_bytes : 16;
+  u4 prob_bits : 8;
+  u4 lanes : 8;
+  u4 bklen;
+  u4 sublen;
+  u4 pardeg;
+  u8 original_len;
+  u4 entry[END + 1];
+
+  u4 compressed_size() const { return entry[END]; }
+};
+
+// Chunk length to occupy all CPU threads, no shorter than ANS_MIN_SUBLEN.
+int ans_tune_sublen(size_t const len);
+
+// Upper bound of the encoded size in bytes, for allocating output space.
+size_t ans_encoded_bound(size_t const len, int const bklen, int const sublen);
+
+// Model-implied bits per symbol after normalizing `freq` to 2^ANS_PROB_BITS.
+f8 ans_avg_bits(u4* freq, int const bklen);
+
+// `freq` is the histogram of `in`, e.g., the output of `psz::histogram`.
+template <cusz_execution_policy P, typename E>
+void ans_encode(
+    E* in, size_t const len, u4* freq, int const bklen, int const sublen,
+    u1* out, size_t* outlen, float* time);
+
+template <cusz_execution_policy P, typename E>
+void ans_decode(u1* in, E* out, float* time);
+
+}  // namespace psz
+
+#endif /* F3B0C2D6_1A8E_4C55_8E0F_7D1B9A6E2C31 */
@@ -62,19 +62,36 @@ class Compressor {
   // external codec that has standalone internals
   Codec* codec;
 
-  float time_pred, time_hist, time_sp;
+  float time_pred, time_hist, time_sp, time_ans, time_rle{0}, time_log{0};
+  float time_preview{0}, time_prog{0};
 
   // sizes
   dim3 len3;
   size_t len;
   int splen;
+  szt nrun{0};  // nonzero if the run-length stage is applied
+  szt logmap_bytes{0};  // nonzero if point-wise relative
+  szt preview_bytes{0};  // nonzero if a binned preview is archived
+  int nlayer{0};         // residual layers applied in decompression
 
   // configs
   float outlier_density{0.2};
+  pszcodec codec1_type{Huffman};
 
   // buffers
 
   pszmempool_cxx<T, E, H>* mem;
+  pszmem_cxx<BYTE>* ans_out{nullptr};  // rANS runs on host
+  pszmem_cxx<E>* rle_val{nullptr};
+  pszmem_cxx<u2>* rle_len{nullptr};
+  pszmem_cxx<BYTE>* logmap{nullptr};  // flags, sign and zero bitmaps
+  pszmem_cxx<T>* bin{nullptr};        // binned input of the preview
+  Compressor* preview{nullptr};       // the same pipeline on `bin`
+  Compressor* layer{nullptr};         // the same pipeline on residuals
+  pszmem_cxx<f8>* prog_rec{nullptr};  // reconstruction so far
+  pszmem_cxx<T>* prog_res{nullptr};   // residual of a layer
+  pszmem_cxx<BYTE>* prog_out{nullptr};
+  psz_book const* book{nullptr};      // shared Huffman book, if given
 
  public:
   Compressor() = default;
@@ -86,7 +103,9 @@ class Compressor {
   Compressor* compress(
       cusz_context*, T*, BYTE*&, size_t&, void* = nullptr, bool = false);
   Compressor* decompress(
-      cusz_header*, BYTE*, T*, void* = nullptr, bool = true);
+      cusz_header*, BYTE*, szt, T*, void* = nullptr, bool = true);
+  Compressor* export_histogram(cusz_context*, T*, u4*, void* = nullptr);
+  Compressor* use_book(psz_book const*);
   Compressor* clear_buffer();
   Compressor* dump(std::vector<pszmem_dump>, char const*);
   Compressor* destroy();
@@ -100,8 +119,22 @@ class Compressor {
   // helper
   Compressor* collect_comp_time();
   Compressor* collect_decomp_time();
+  Compressor* predict(cusz_context*, T*, double const, void*);
   Compressor* merge_subfiles(
-      pszpredictor_type, T*, szt, BYTE*, szt, T*, M*, szt, void*);
+      pszpredictor_type, T*, szt, BYTE*, szt, T*, M*, szt, u2*, szt, BYTE*,
+      szt, BYTE*, szt, void*);
+  Compressor* ans_encode(pszmem_cxx<E>*, szt, BYTE**, size_t*, void*);
+  Compressor* ans_decode(BYTE*, szt, pszmem_cxx<E>*, void*);
+  Compressor* rle_reserve(szt);
+  Compressor* rle_encode(pszmem_cxx<E>*, szt, bool, void*);
+  Compressor* rle_decode(pszmem_cxx<E>*, szt, u2*, void*);
+  Compressor* log_reserve(szt);
+  Compressor* log_encode(T*&, double&, void*);
+  Compressor* log_decode(BYTE*, szt, T*, void*);
+  Compressor* preview_encode(cusz_context*, T*, BYTE**, void*);
+  Compressor* prog_reserve();
+  Compressor* prog_encode(cusz_context*, T*, BYTE*&, size_t&, void*);
+  Compressor* prog_decode(BYTE*, szt, T*, void*);
 };
 
 }  // namespace cusz
@@ -27,14 +27,28 @@ struct cusz_context {
   bool task_reconstruct{false};
   bool task_dryrun{false};
   bool task_experiment{false};
+  bool task_compare{false};  // `infile` against `original_file`, streamed
 
-  bool prep_binning{false};
+  bool prep_binning{false};  // also archive a binned preview
+  pszpreprocess binning{Binning2x2};
+  int prog_layers{1};      // progressive if more than 1
+  double prog_ratio{10};   // eb of a layer over that of the next
   //   bool prep_logtransform{false};
   bool prep_prescan{false};
 
   bool use_demodata{false};
   bool use_autotune_hf{true};
   bool use_gpu_verify{false};
+  bool use_rle{false};         // applied only when beneficial
+  bool use_rle_force{false};   // applied regardless
+  bool use_preview{false};     // reconstruct the binned preview only
+  bool use_cpu_dryrun{false};  // also the fallback if no GPU is present
+  bool use_auto_pred{false};   // `pred_type` set from sampled estimates
+  bool use_numa_touch{false};  // host buffers placed by parallel first touch
+
+  // of host workers to cores; it and `use_numa_touch` hold for the calls on
+  // the compressor initialized with them (or for the CLI run)
+  pszpin cpu_pin{PinNone};
 
   bool skip_tofile{false};
   bool skip_hf{false};
@@ -42,6 +56,7 @@ struct cusz_context {
   bool report_time{false};
   bool report_cr{false};
   bool report_cr_est{false};
+  bool report_spatial{false};  // SSIM, error autocorrelation and spectrum
   bool verbose{false};
 
   pszpredictor_type pred_type;
@@ -62,6 +77,7 @@ struct cusz_context {
   pszdtype dtype{F4};
   pszmode mode{Rel};
   double eb{0.0};
+  double target_cr{0}, target_psnr{0};  // to autotune eb, if positive
   int dict_size{1024}, radius{512};
   int quant_bytewidth{2}, huff_bytewidth{4};
 
@@ -71,6 +87,7 @@ struct cusz_context {
 
   // codec config
   uint32_t codecs_in_use{0b01};
+  pszcodec codec1_type{Huffman};
   int vle_sublen{512}, vle_pardeg{-1};
 };
 typedef struct cusz_context cusz_context;
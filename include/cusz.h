@@ -51,6 +51,150 @@ pszerror psz_decompress(
     pszcompressor* comp, pszout compressed, size_t const comp_len,
     void* decompressed, pszlen const decomp_len, void* record, void* stream);
 
+// What Lorenzo and spline would make of `eb` (absolute), estimated on
+// strided sample blocks of `data` on host, in milliseconds; either result
+// can be NULL. FP32/FP64 only.
+pszerror psz_estimate(
+    void* data, pszdtype const type, pszlen const len, double const eb,
+    int const radius, pszestimate* lorenzo, pszestimate* spline, float* time);
+
+// With `ctx->use_auto_pred`, set `ctx->pred_type` to the predictor estimated
+// to compress `data` (on host) better at the eb of `ctx` (of the value range
+// of `data` in relative mode); to be called before `psz_compress_init`.
+// Spline is chosen only where it is supported.
+pszerror psz_select_predictor(pszctx* ctx, void* data);
+
+// On host, over the work-stealing scheduler of `nworker` workers (all cores
+// if not positive): tiles of `tile` planes along the slowest axis, each
+// predicted on its own with Lorenzo, and encoded with ANS under one model.
+// `eb` is absolute; integers are exact at eb = 0. The archive is allocated
+// here, to be freed by the caller. FP32/FP64 and integers up to 32 bits.
+// `report`, if not NULL, is of the scheduler over the run.
+pszerror psz_tile_compress(
+    void* data, pszdtype const type, pszlen const len, double const eb,
+    int const radius, uint32_t const tile, int const nworker,
+    uint8_t** archive, size_t* bytes, psz_sched_report* report);
+
+// The type and lengths of a tiled archive, to allocate for its output;
+// CUSZ_FAIL_UNSUPPORTED_FORMAT if it is not one.
+pszerror psz_tile_info(
+    uint8_t const* archive, size_t const bytes, pszdtype* type, pszlen* len);
+
+// CUSZ_FAIL_UNSUPPORTED_FORMAT if the archive is not a tiled one, or is
+// truncated or malformed.
+pszerror psz_tile_decompress(
+    uint8_t const* archive, size_t const bytes, void* out, int const nworker,
+    psz_sched_report* report);
+
+// Many fields of one type over `nworker` workers (4 if not positive), each
+// a thread with its own stream and compressor, kept from create to release;
+// a compressor and its device pool are kept across fields and calls, and
+// re-initialized only when the lengths change. The host threads are shared
+// among the workers. `ctx` is copied.
+psz_batch* psz_batch_create(
+    pszframe* framework, pszdtype const type, pszctx* ctx, int nworker);
+
+// The first failure among `fields[i].status`, or CUSZ_SUCCESS; one call
+// at a time on a batch.
+pszerror psz_batch_compress(
+    psz_batch* batch, psz_field* fields, size_t const nfield);
+
+pszerror psz_batch_release(psz_batch* batch);
+
+// As `psz_compress` and `psz_decompress`, queued to a background executor
+// and run in the order of submission; the arguments, including the outputs,
+// are to stay valid until the task is done. `callback` can be NULL.
+psz_task* psz_compress_async(
+    pszcompressor* comp, void* uncompressed, pszlen const uncomp_len,
+    ptr_pszout compressed, size_t* comp_bytes, pszheader* header, void* record,
+    void* stream, psz_callback callback, void* user);
+
+psz_task* psz_decompress_async(
+    pszcompressor* comp, pszout compressed, size_t const comp_len,
+    void* decompressed, pszlen const decomp_len, void* record, void* stream,
+    psz_callback callback, void* user);
+
+// 1 if the task is done, otherwise 0; never blocks.
+int psz_task_poll(psz_task* task);
+
+// Block until the task is done, and return its status. In a callback, a
+// task queued after it cannot be done yet: CUSZ_FAIL_DATA_NOT_READY, at once.
+pszerror psz_task_wait(psz_task* task);
+
+// Wait for the task and free it; a task that cannot be done yet is kept.
+pszerror psz_task_release(psz_task* task);
+
+// Ranks as processes that share the directory `dir`, in place of MPI; each
+// reduction is a file per rank, so `dir` is to start empty and is left to
+// the caller to remove. A reduction fails (CUSZ_FAIL_ONDISK_FILE_ERROR from
+// the calls below) if another rank writes nothing for `timeout` seconds (60
+// if not positive); the ranks are then out of step, and `comm` is not to
+// be used again.
+psz_comm* psz_comm_file_create(
+    char const* dir, int rank, int nrank, double timeout);
+
+pszerror psz_comm_release(psz_comm* comm);
+
+// In the relative mode, the eb of `ctx` is made absolute against the range
+// of the global field, reduced over `comm` from the subdomain `data` of each
+// rank (on host), so that every rank compresses at the same eb; otherwise
+// `ctx` is kept. FP32/FP64 only.
+pszerror psz_global_eb(psz_comm* comm, pszctx* ctx, void* data, pszlen len);
+
+// A subdomain archive: the box of `sub` (`begin` and `bytes` are set here),
+// followed by the archive from `psz_compress`, copied to host.
+pszerror psz_subdomain_write(
+    char const* fname, psz_subdomain const* sub, void* archive, size_t bytes);
+
+// One archive from the subdomain archives of all ranks, led by an index of
+// their boxes and offsets; the boxes are to tile the global field.
+pszerror psz_merge(char const* fname, char const** subfiles, int n);
+
+// The index of a merged archive; with `subs` NULL, only the count.
+pszerror psz_merged_index(char const* fname, psz_subdomain* subs, int* n);
+
+// The archive of subdomain `k`, for `psz_decompress_init`/`psz_decompress`,
+// read alone; with `archive` NULL, only its size.
+pszerror psz_merged_read(
+    char const* fname, int k, void* archive, size_t* bytes);
+
+// The subdomain that holds the point (x, y, z), or -1.
+int psz_subdomain_locate(
+    psz_subdomain const* subs, int n, uint32_t x, uint32_t y, uint32_t z);
+
+// A field split over partitions (workers or ranks) can share one Huffman
+// book in place of one each: every partition exports the histogram of its
+// quant-codes, the histograms are summed, the book is built once, and every
+// partition encodes with it. Archives so encoded keep the id of the book in
+// place of the reverse book, and are decompressed with the same book given.
+
+// Prediction and the histogram only, as `psz_compress` would make them (of
+// the run values, if RLE is taken); `freq` (on host) is of
+// `2 * ctx->radius` bins.
+pszerror psz_compress_histogram(
+    pszcompressor* comp, void* uncompressed, pszlen const uncomp_len,
+    uint32_t* freq, void* stream);
+
+// Sum `freq` over the ranks of `comm`, in place.
+pszerror psz_histogram_reduce(psz_comm* comm, uint32_t* freq, int bklen);
+
+// The canonical book of the summed histogram, built on host.
+psz_book* psz_book_create(uint32_t* freq, int const bklen);
+
+pszerror psz_book_release(psz_book* book);
+
+uint32_t psz_book_id(psz_book const* book);
+
+// To store the book once, apart from the archives, and load it back.
+size_t psz_book_bytes(psz_book const* book);
+pszerror psz_book_export(psz_book const* book, void* out);
+psz_book* psz_book_import(void const* in, size_t const bytes);
+
+// Compress and decompress with `book`, which is to outlive its use; NULL to
+// go back to a book of each archive's own. Huffman only; progressive layers
+// and the preview keep their own books.
+pszerror psz_use_book(pszcompressor* comp, psz_book const* book);
+
 #endif
 
 #ifdef __cplusplus
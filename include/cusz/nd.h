@@ -1,3 +1,5 @@
+#ifndef E5A1C9D3_7B2F_4E8A_9C6D_1F0B3A5E7D29
+#define E5A1C9D3_7B2F_4E8A_9C6D_1F0B3A5E7D29
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,4 +14,6 @@ typedef struct psz_dim3 {
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
+
+#endif /* E5A1C9D3_7B2F_4E8A_9C6D_1F0B3A5E7D29 */
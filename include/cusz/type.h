@@ -43,6 +43,8 @@ typedef enum cusz_error_status {  //
   CUSZ_FAIL_UNSUPPORTED_QUANTTYPE,
   CUSZ_FAIL_UNSUPPORTED_PRECISION,
   CUSZ_FAIL_UNSUPPORTED_PIPELINE,
+  // not an archive, or of a format version this build does not read
+  CUSZ_FAIL_UNSUPPORTED_FORMAT,
   // not-implemented error
   CUSZ_NOT_IMPLEMENTED = 0x0100,
 } cusz_error_status;
@@ -51,6 +53,7 @@ typedef cusz_error_status pszerror;
 
 typedef enum cusz_datatype  //
 { __F0 = 0,
+  F2 = 2,
   F4 = 4,
   F8 = 8,
   __U0 = 10,
@@ -63,7 +66,9 @@ typedef enum cusz_datatype  //
   I2 = 22,
   I4 = 24,
   I8 = 28,
-  ULL = 31 } cusz_datatype;
+  ULL = 31,
+  __B0 = 40,
+  BF2 = 42 } cusz_datatype;
 typedef cusz_datatype cusz_dtype;
 typedef cusz_datatype psz_dtype;
 typedef cusz_datatype pszdtype;
@@ -80,6 +85,9 @@ typedef int32_t i4;
 typedef int64_t i8;
 typedef float f4;
 typedef double f8;
+// half-precision storage (IEEE binary16 and bfloat16); computed in FP32
+typedef struct psz_f2 { uint16_t bits; } f2;
+typedef struct psz_bf2 { uint16_t bits; } bf2;
 typedef size_t szt;
 
 typedef enum cusz_executiontype  //
@@ -91,7 +99,8 @@ typedef cusz_executiontype pszspace;
 
 typedef enum cusz_mode  //
 { Abs = 0,
-  Rel = 1 } cusz_mode;
+  Rel = 1,
+  PwRel = 2 } cusz_mode;
 typedef cusz_mode pszmode;
 
 typedef enum cusz_predictortype  //
@@ -113,6 +122,7 @@ typedef cusz_preprocessingtype pszpreprocess;
 typedef enum cusz_codectype  //
 { Huffman = 0,
   RunLength,
+  Rans,
   // NvcompCascade,
   // NvcompLz4,
   // NvcompSnappy,
@@ -130,6 +140,12 @@ typedef enum cusz_huffman_codingtype  //
   Fine = 1 } cusz_huffman_codingtype;
 typedef cusz_huffman_codingtype pszhfpar;
 
+typedef enum psz_cpu_pinning  //
+{ PinNone = 0,
+  PinCompact = 1,
+  PinScatter = 2 } psz_cpu_pinning;
+typedef psz_cpu_pinning pszpin;
+
 //////// configuration template
 typedef struct pszlen {
   // clang-format off
@@ -183,6 +199,9 @@ typedef struct cusz_compressor {
   pszheader* header;
   pszframe* framework;
   pszdtype type;
+  // of its host workers and buffers, as of `psz_compress_init`
+  pszpin cpu_pin;
+  bool use_numa_touch;
 } cusz_compressor;
 typedef cusz_compressor pszcompressor;
 
@@ -212,6 +231,73 @@ typedef struct cusz_stats {
 } cusz_stats;
 typedef cusz_stats pszsummary;
 
+// what a predictor would make of an eb, estimated on samples
+typedef struct psz_estimate_result {
+  f8 cr;       // over Huffman-coded quant-codes, outliers and anchors
+  f8 psnr;     // of the samples, against the range of the field
+  f8 outlier;  // fraction of the values
+  f8 entropy;  // of quant-codes, in bits
+  f8 bitrate;  // bits per value
+} psz_estimate_result;
+typedef psz_estimate_result pszestimate;
+
+// of a run of the host scheduler, over its workers; the utilization is
+// `busy_ms` over `nworker` times `wall_ms`, and the imbalance shows as
+// `max_busy_ms` above the mean
+typedef struct psz_sched_report {
+  f8 wall_ms;
+  f8 busy_ms, max_busy_ms;
+  int nworker;
+  size_t ntask, nsteal;
+} psz_sched_report;
+
+// a field of a batch: the input on device, as for `psz_compress`, and its
+// archive on host, from `malloc` and to be freed by the caller
+typedef struct psz_field {
+  void* data;
+  pszlen len;
+  f8 eb;                 // in the mode of the context of the batch
+  u1* archive;           // out
+  size_t archive_bytes;  // out
+  pszerror status;       // out
+} psz_field;
+
+struct psz_batch;
+typedef struct psz_batch psz_batch;
+
+// an asynchronous compression or decompression, and its completion callback,
+// called on the executor thread once the task is done; it may wait for or
+// release its own task, but not wait for a later one
+struct psz_task;
+typedef struct psz_task psz_task;
+typedef void (*psz_callback)(psz_task* task, pszerror status, void* user);
+
+typedef enum psz_reduce_op  //
+{ ReduceSum = 0,
+  ReduceMin = 1,
+  ReduceMax = 2 } psz_reduce_op;
+
+// How ranks combine values: `allreduce` reduces `n` doubles across all
+// ranks, in place, and returns 0 on success. An MPI_Allreduce fits in;
+// `psz_comm_file_create` makes one over a directory the ranks share.
+typedef struct psz_comm {
+  int rank, nrank;
+  int (*allreduce)(struct psz_comm* comm, f8* v, size_t n, psz_reduce_op op);
+  void* impl;
+} psz_comm;
+
+// a Huffman book shared by the partitions of a field (see `psz_book_create`)
+struct psz_book;
+typedef struct psz_book psz_book;
+
+// The box of a rank in the global field (x, y, z, low to high), and, in a
+// merged archive, where the archive of the rank starts and its size.
+typedef struct psz_subdomain {
+  int rank, nrank;
+  uint32_t global[3], offset[3], len[3];
+  size_t begin, bytes;
+} psz_subdomain;
+
 typedef u1* pszout;
 // used for bridging some compressor internal buffer
 typedef pszout* ptr_pszout;
@@ -29,8 +29,19 @@ typedef struct alignas(128) cusz_header {
   static const int ANCHOR = 1;
   static const int VLE = 2;
   static const int SPFMT = 3;
+  static const int RUNLEN = 4;  // empty if run-length stage is not applied
+  static const int LOGMAP = 5;  // empty unless point-wise relative
+  static const int PREVIEW = 6;  // binned level, itself a whole archive
+  static const int LAYERS = 7;   // index, then refining residual archives
 
-  static const int END = 4;
+  static const int END = 8;
+
+  // "PSZH"; the version is bumped whenever the layout or the segments change
+  static const uint32_t MAGIC = 0x485a5350;
+  static const uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
 
   uint32_t self_bytes : 16;
   uint32_t fp : 1;
@@ -43,10 +54,14 @@ typedef struct alignas(128) cusz_header {
   double eb;
   uint32_t radius : 16;
   int splen;
+  uint32_t shared_book;  // id of the Huffman book if shared, otherwise 0
 
   uint32_t entry[END + 1];
 
   pszpredictor_type pred_type;
+  pszcodec codec1_type;
+  pszdtype dtype;
+  pszmode mode;
 
   // uint32_t byte_uncompressed : 4;  // T; 1, 2, 4, 8
   // uint32_t byte_errctrl : 3;       // 1, 2, 4
@@ -55,6 +70,10 @@ typedef struct alignas(128) cusz_header {
   // size_t   data_len;
   // size_t   errctrl_len;
 
+
+  // Whether it is written by this build's layout; archives of another are
+  // not to be read (nor their `dtype` taken).
+  bool known() const { return magic == MAGIC and version == VERSION; }
 } cusz_header;
 typedef cusz_header pszheader;
 
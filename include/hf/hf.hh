@@ -18,6 +18,7 @@
 #include <numeric>
 
 #include "cusz/type.h"
+#include "hf/hf_bk.hh"
 #include "hf/hf_struct.h"
 #include "hf/hf_word.hh"
 #include "mem/memseg_cxx.hh"
@@ -117,6 +118,8 @@ class HuffmanCodec {
   // timer
   float _time_book{0.0}, _time_lossless{0.0};
 
+  psz_book const* shared{nullptr};  // built elsewhere, not archived
+
   hf_book* book_desc;
   hf_chunk* chunk_desc_d;
   hf_chunk* chunk_desc_h;
@@ -142,6 +145,7 @@ class HuffmanCodec {
   HuffmanCodec* build_codebook(uint32_t*, int const, void* = nullptr);
 
   HuffmanCodec* build_codebook(MemU4*, int const, void* = nullptr);
+  HuffmanCodec* load_book(psz_book const*, void* = nullptr);
 
   HuffmanCodec* encode(E*, size_t const, BYTE**, size_t*, void* = nullptr);
   HuffmanCodec* decode(BYTE*, E*, void* = nullptr, bool = true);
@@ -1,17 +1,48 @@
 #ifndef CD8DAB1B_C057_43DB_A4F1_33653D9B545D
 #define CD8DAB1B_C057_43DB_A4F1_33653D9B545D
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "cusz/type.h"
 
+// A canonical book built once, from the histogram of quant-codes (u4) summed
+// over partitions, for every partition to encode with. Archives encoded with
+// it keep `id` in place of their reverse book.
+struct psz_book {
+  int bklen;
+  pszdtype encdtype;  // U4 or ULL, the type of a codeword
+  std::vector<uint8_t> book, revbook;
+  uint32_t id;
+};
+
 namespace psz {
 
+// The longest codeword that `hf_buildbook<CPU, ...>` gives for `freq`. Book
+// type H holds up to PackedWordByWidth<sizeof(H)>::FIELDWIDTH_word bits.
+int hf_max_bitlen(uint32_t* freq, int const bklen);
+
 template <cusz_execution_policy P, typename E, typename H>
 void hf_buildbook(
     uint32_t* freq, int const bklen, H* book, uint8_t* revbook,
     int const revbook_bytes, float* time, void* stream = nullptr);
 
+// The book of `freq` in u4 codewords if they fit, otherwise in u8.
+void hf_buildbook_shared(uint32_t* freq, int const bklen, psz_book* book);
+
+// Whether `book` has a codeword for every symbol that occurs in `freq`, as
+// it does if `freq` is counted in the histogram it is built from.
+bool hf_book_covers(psz_book const* book, uint32_t const* freq);
+
+// The reverse book to decode an archive with: its own, of `revbk_bytes` at
+// `own`, or, with none (0 bytes), that of `shared`, as loaded at `loaded`.
+// Throws if the archive has none and `shared` is missing or of another type
+// or length of codewords.
+uint8_t* hf_revbook_of(
+    uint8_t* own, size_t revbk_bytes, pszdtype encdtype, int bklen,
+    psz_book const* shared, uint8_t* loaded);
+
 }
 
 #endif /* CD8DAB1B_C057_43DB_A4F1_33653D9B545D */
@@ -46,6 +46,8 @@ template <typename H>
 void hf_buildtree_impl1(
     u4* freq, uint16_t bklen, H* book, float* time = nullptr);
 
+int hf_maxbits_impl1(u4* freq, uint16_t bklen);
+
 // for impl2
 
 struct NodeCxx {
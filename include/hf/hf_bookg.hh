@@ -22,15 +22,26 @@
 void lambda_sort_by_freq(uint32_t* freq, const int len, uint32_t* qcode);
 
 namespace par_huffman {
+// The grid-wide scalars of a build, in device memory of its own, so that
+// builds on different streams do not share state.
+struct bookg_state {
+  // GenerateCL
+  int iNodesFront, iNodesRear, lNodesCur, iNodesSize, curLeavesNum;
+  int minFreq, tempLength, mergeFront, mergeRear;
+  // GenerateCW
+  int CCL, CDPI, newCDPI;
+};
+
 // Codeword length
 template <typename F>
 __global__ void GPU_GenerateCL(
     F*, F*, int, F*, int*, F*, int*, F*, int*, int*, F*, int*, int*, uint32_t*,
-    int, int);
+    int, int, bookg_state*);
 
 // Forward Codebook
 template <typename F, typename H>
-__global__ void GPU_GenerateCW(F* CL, H* CW, H* first, H* entry, int size);
+__global__ void GPU_GenerateCW(
+    F* CL, H* CW, H* first, H* entry, int size, bookg_state* st);
 
 }  // namespace par_huffman
 
@@ -0,0 +1,51 @@
+/**
+ * @file binning.hh
+ * @author Jiannan Tian
+ * @brief Downsampling by binning for the preview level (CPU).
+ * @version 0.4
+ * @date 2023-09-21
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef C6A1E4F8_2D9B_4B73_A5E0_8F3C7D1B2A96
+#define C6A1E4F8_2D9B_4B73_A5E0_8F3C7D1B2A96
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+
+namespace psz {
+
+// (x, y) of a bin; only the binning types apply.
+inline void binning_factor(pszpreprocess const type, int* bx, int* by)
+{
+  if (type == Binning2x2)
+    *bx = 2, *by = 2;
+  else if (type == Binning2x1)
+    *bx = 2, *by = 1;
+  else if (type == Binning1x2)
+    *bx = 1, *by = 2;
+  else
+    throw std::runtime_error("[psz::error::binning] Not a binning type.");
+}
+
+inline psz_dim3 binning_len3(psz_dim3 const len3, int const bx, int const by)
+{
+  return psz_dim3{(len3.x - 1) / bx + 1, (len3.y - 1) / by + 1, len3.z};
+}
+
+// Each xy-plane is averaged over `bx`-by-`by` bins into `out`, of
+// `binning_len3(len3, bx, by)`; bins at the edges average what they cover.
+template <typename T>
+void binning(
+    T* in, psz_dim3 const len3, int const bx, int const by, T* out,
+    float* time);
+
+}  // namespace psz
+
+#endif /* C6A1E4F8_2D9B_4B73_A5E0_8F3C7D1B2A96 */
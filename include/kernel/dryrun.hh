@@ -0,0 +1,31 @@
+/**
+ * @file dryrun.hh
+ * @author Jiannan Tian
+ * @brief Dryrun on host, fused with quality assessment.
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef C5D81E3A_2F47_4B96_8E0D_7A1C94B6F252
+#define C5D81E3A_2F47_4B96_8E0D_7A1C94B6F252
+
+#include <cstddef>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+// The prequantization round trip of `dryrun_kernel`, assessed as in
+// `cppstd_assess_quality` within the same pass; `s->xdata` refers to the
+// round-tripped data, which are not kept.
+template <typename T>
+void dryrun_assess(
+    T* original, size_t const len, double const eb, pszsummary* s,
+    float* time = nullptr);
+
+}  // namespace psz
+
+#endif /* C5D81E3A_2F47_4B96_8E0D_7A1C94B6F252 */
@@ -0,0 +1,90 @@
+/**
+ * @file estimate.hh
+ * @author Jiannan Tian
+ * @brief Sampling-based estimate of compressibility, and eb autotuning.
+ * @version 0.4
+ * @date 2023-09-23
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef A4E07C19_3B62_4D58_9F1E_C8D52A716B3E
+#define A4E07C19_3B62_4D58_9F1E_C8D52A716B3E
+
+#include <cstddef>
+#include <vector>
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+
+namespace psz {
+
+// Strided blocks of the input, each with a one-cell halo so that prediction
+// sees the same neighbors as on the whole field: Lorenzo reads the low faces
+// and spline the high ones. They are copied once and evaluated at as many eb
+// as needed.
+template <typename T>
+class sampler {
+ public:
+  static constexpr double DEFAULT_FRACTION = 0.005;
+  static constexpr size_t MIN_NBLK = 16;
+
+  sampler(
+      T const* in, psz_dim3 const len3,
+      double const fraction = DEFAULT_FRACTION);
+
+  pszestimate lorenzo(double const eb, int const radius) const;
+  // as spline3d, with anchors every 8 and interpolation along z, x, then y;
+  // a field of fewer dimensions is interpolated along those it has
+  pszestimate spline(double const eb, int const radius) const;
+
+  size_t nblk() const { return nblk_; }
+  size_t len() const { return nblk_ * blk.x * blk.y * blk.z; }
+  double range() const { return max - min; }
+
+ private:
+  struct tally {
+    std::vector<u4> freq;
+    size_t noutlier{0}, nanchor{0};
+    double sum_err2{0};
+  };
+
+  psz_dim3 blk, loc;  // block, and block with the halo
+  size_t nblk_;
+  std::vector<T> data;  // `loc`-sized blocks, one after another
+  double min, max;
+
+  // `per_block(T const* block, T* scratch, tally&)`, over the blocks in
+  // parallel
+  template <typename F>
+  pszestimate evaluate(int const radius, F&& per_block) const;
+  pszestimate finish(tally& t) const;
+};
+
+// The smallest eb estimated to reach `target_cr`, or the largest to reach
+// `target_psnr` (given in dB), whichever is positive; the bisection runs on
+// the samples only.
+template <typename T>
+double autotune_eb(
+    T const* in, psz_dim3 const len3, int const radius,
+    double const target_cr, double const target_psnr,
+    pszestimate* est = nullptr, float* time = nullptr);
+
+// Both predictors on the same samples at `eb`; either result can be null.
+template <typename T>
+void estimate(
+    T const* in, psz_dim3 const len3, double const eb, int const radius,
+    pszestimate* lorenzo, pszestimate* spline, float* time = nullptr);
+
+// Spline if it is estimated to compress clearly better than Lorenzo at `eb`,
+// and the field is 3D as spline3d requires; Lorenzo otherwise.
+template <typename T>
+pszpredictor_type select_predictor(
+    T const* in, psz_dim3 const len3, double const eb, int const radius,
+    pszestimate* lorenzo = nullptr, pszestimate* spline = nullptr,
+    float* time = nullptr);
+
+}  // namespace psz
+
+#endif /* A4E07C19_3B62_4D58_9F1E_C8D52A716B3E */
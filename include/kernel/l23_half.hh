@@ -0,0 +1,41 @@
+/**
+ * @file l23_half.hh
+ * @author Jiannan Tian
+ * @brief Lorenzo predictor for FP16/BF16 input (CPU).
+ * @version 0.4
+ * @date 2023-09-19
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef C5D8E1F4_2A6B_4D7C_9E3F_8B1A4C7D2E60
+#define C5D8E1F4_2A6B_4D7C_9E3F_8B1A4C7D2E60
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+
+namespace psz {
+
+// Prequantization is in FP32 to 32-bit integers, with the reconstruction
+// written straight to the half type; a value is kept as is when its
+// prequantized form does not fit 31 bits, or when rounding to the half type
+// would break `eb`.
+template <typename T, typename E>
+void l23_half_construct(
+    T* data, psz_dim3 const len3, f8 const eb, int const radius, E* eq,
+    T* outlier_val, u4* outlier_idx, size_t* num_outlier,
+    size_t const max_outlier, float* time);
+
+template <typename T, typename E>
+void l23_half_reconstruct(
+    E* eq, T* outlier_val, u4* outlier_idx, size_t const num_outlier,
+    psz_dim3 const len3, f8 const eb, int const radius, T* xdata,
+    float* time);
+
+}  // namespace psz
+
+#endif /* C5D8E1F4_2A6B_4D7C_9E3F_8B1A4C7D2E60 */
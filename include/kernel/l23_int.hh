@@ -0,0 +1,41 @@
+/**
+ * @file l23_int.hh
+ * @author Jiannan Tian
+ * @brief Lorenzo predictor for integer input (CPU).
+ * @version 0.4
+ * @date 2023-09-18
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef D41F0B7E_93C2_4A5D_8E61_2B7C0F3A9E57
+#define D41F0B7E_93C2_4A5D_8E61_2B7C0F3A9E57
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+
+namespace psz {
+
+// Prequantization is the integer division (to nearest) by 2 * eb + 1, hence
+// lossless for eb = 0; prediction and its inverse are done in the modular
+// arithmetic of the input width, hence exact. Outliers keep the delta bits
+// in T, and are sorted by index.
+template <typename T, typename E>
+void l23_int_construct(
+    T* data, psz_dim3 const len3, u8 const eb, int const radius, E* eq,
+    T* outlier_val, u4* outlier_idx, size_t* num_outlier,
+    size_t const max_outlier, float* time);
+
+template <typename T, typename E>
+void l23_int_reconstruct(
+    E* eq, T* outlier_val, u4* outlier_idx, size_t const num_outlier,
+    psz_dim3 const len3, u8 const eb, int const radius, T* xdata,
+    float* time);
+
+}  // namespace psz
+
+#endif /* D41F0B7E_93C2_4A5D_8E61_2B7C0F3A9E57 */
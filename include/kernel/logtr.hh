@@ -0,0 +1,45 @@
+/**
+ * @file logtr.hh
+ * @author Jiannan Tian
+ * @brief Log transform for the point-wise relative error bound (CPU).
+ * @version 0.4
+ * @date 2023-09-20
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef D8B3F6A2_5C1E_4A97_B0D4_7E2C9F1A6B35
+#define D8B3F6A2_5C1E_4A97_B0D4_7E2C9F1A6B35
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+inline size_t log_bitmap_bytes(size_t len) { return (len - 1) / 8 + 1; }
+
+// y = log2|x|, in place if `out` is `in`; signs and zeros go to the
+// bitmaps, and zeros take the smallest y so as not to upset prediction.
+// Reports whether any sign or zero is set, and max|y|.
+template <typename T>
+void log_transform(
+    T* in, T* out, size_t const len, u1* sign, u1* zero, bool* has_sign,
+    bool* has_zero, f8* ymax, float* time);
+
+// x = +/- 2^y, or 0; a null bitmap stands for no sign or no zero.
+template <typename T>
+void log_inverse(
+    T* in, T* out, size_t const len, u1 const* sign, u1 const* zero,
+    float* time);
+
+// The absolute bound on y for the point-wise relative bound `pwrel` on x,
+// less the rounding in T; throws if nothing is left.
+template <typename T>
+f8 log_transform_eb(f8 const pwrel, f8 const ymax);
+
+}  // namespace psz
+
+#endif /* D8B3F6A2_5C1E_4A97_B0D4_7E2C9F1A6B35 */
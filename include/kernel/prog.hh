@@ -0,0 +1,42 @@
+/**
+ * @file prog.hh
+ * @author Jiannan Tian
+ * @brief Residual and accumulation between progressive layers (CPU).
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef A4C8E2B6_9F1D_4D53_B7A0_3E6F1C9D8B27
+#define A4C8E2B6_9F1D_4D53_B7A0_3E6F1C9D8B27
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+// The layers to come are compressed from the residual against the
+// reconstruction so far, and added back in turn. The reconstruction is kept
+// in double and rounded to T once, at the end, so that rounding does not
+// add up over the layers; the residual is rounded to T, to be compressed.
+
+// r = x - xr
+template <typename T>
+void prog_residual(
+    T const* x, f8 const* xr, T* r, size_t const len, float* time);
+
+// xr += r
+template <typename T>
+void prog_accumulate(f8* xr, T const* r, size_t const len, float* time);
+
+// x = xr, rounded to T
+template <typename T>
+void prog_round(f8 const* xr, T* x, size_t const len, float* time);
+
+}  // namespace psz
+
+#endif /* A4C8E2B6_9F1D_4D53_B7A0_3E6F1C9D8B27 */
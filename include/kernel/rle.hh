@@ -0,0 +1,44 @@
+/**
+ * @file rle.hh
+ * @author Jiannan Tian
+ * @brief Run-length codec for quant-codes (CPU), prior to Huffman/rANS.
+ * @version 0.4
+ * @date 2023-09-14
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef B7D40A1E_6C2F_4F8B_A0E2_5E7C3B9D8A14
+#define B7D40A1E_6C2F_4F8B_A0E2_5E7C3B9D8A14
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+// A run longer than RLE_MAX_RUN is split, so that its length fits in u2.
+constexpr u4 RLE_MAX_RUN = 65535;
+// A run costs 16 bits (length) plus a Huffman codeword (>=1 bit), while
+// Huffman without RLE costs >=1 bit per symbol; require a margin.
+constexpr int RLE_AUTO_MIN_AVGRUN = 32;
+
+template <pszpolicy P, typename T>
+void rle_count(T* in, size_t const inlen, size_t* nrun, float* time);
+
+// `out_val` and `out_len` must hold as many runs as `rle_count` gives.
+template <pszpolicy P, typename T>
+void rle_encode(
+    T* in, size_t const inlen, T* out_val, u2* out_len, size_t* nrun,
+    float* time);
+
+template <pszpolicy P, typename T>
+void rle_decode(
+    T* in_val, u2* in_len, size_t const nrun, T* out, size_t const outlen,
+    float* time);
+
+}  // namespace psz
+
+#endif /* B7D40A1E_6C2F_4F8B_A0E2_5E7C3B9D8A14 */
@@ -0,0 +1,69 @@
+/**
+ * @file tile.hh
+ * @author Jiannan Tian
+ * @brief Tiled host pipeline of Lorenzo, histogram and ANS, as tasks on the
+ * work-stealing scheduler (CPU).
+ * @version 0.4
+ * @date 2023-09-29
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef F4A81C6E_0B3D_4E92_9D57_2E6B8A1F3C05
+#define F4A81C6E_0B3D_4E92_9D57_2E6B8A1F3C05
+
+#include <cstddef>
+#include <vector>
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+#include "utils/sched_cpu.hh"
+
+namespace psz {
+
+// A tile is `tile` planes (rows for 2D, values for 1D) along the slowest
+// axis, predicted on its own; the ANS model is the histogram of all tiles.
+// Integers are predicted exactly, at `eb` truncated to an integer; FP32 and
+// FP64 are prequantized at `eb`, with what it cannot bound kept as is.
+template <typename T>
+struct tile_archive {
+  struct tile {
+    psz_dim3 len3;
+    std::vector<T> outlier_val;
+    std::vector<u4> outlier_idx;
+    std::vector<u1> ans;
+  };
+
+  psz_dim3 len3;
+  u4 tile_size;  // planes (rows, values) per tile
+  f8 eb;
+  int radius;
+  std::vector<u4> freq;
+  std::vector<tile> tiles;
+
+  // of the payload: the model, the outliers and the ANS streams
+  size_t bytes() const;
+
+  // one contiguous archive, led by the type and the lengths
+  void to_bytes(std::vector<u1>& out) const;
+  void from_bytes(u1 const* in, size_t const len);
+};
+
+// Per tile, tasks of prediction and its histogram, and, once all histograms
+// are reduced, ANS encoding; on `nworker` workers, with or without stealing.
+template <typename T>
+cpu::sched_report tile_compress(
+    T* data, psz_dim3 const len3, f8 const eb, int const radius,
+    u4 const tile, tile_archive<T>& out, int const nworker = -1,
+    bool const steal = true);
+
+// Per tile, ANS decoding and then reconstruction.
+template <typename T>
+cpu::sched_report tile_decompress(
+    tile_archive<T> const& in, T* xdata, int const nworker = -1,
+    bool const steal = true);
+
+}  // namespace psz
+
+#endif /* F4A81C6E_0B3D_4E92_9D57_2E6B8A1F3C05 */
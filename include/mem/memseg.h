@@ -30,6 +30,7 @@ typedef struct psz_memory_segment {
   uint32_t lx{1}, ly{1}, lz{1};
   size_t sty{1}, stz{1};  // stride
   bool isaview{false}, d_borrowed{false}, h_borrowed{false};
+  bool h_registered{false};  // page-locked in place, not by the runtime
 
 } pszmem;
 
@@ -48,26 +48,39 @@ class pszmem_cxx {
 
   pszmem_cxx* extrema_scan(double& max_value, double& min_value, double& range)
   {
-    if (std::is_same<Ctype, float>::value or
-        std::is_same<Ctype, double>::value) {
-      // may not work for _uniptr
-      Ctype result[4];
-      // psz::thrustgpu_get_extrema_rawptr<Ctype>((Ctype*)m->d, m->len,
-      // result);
-      psz::probe_extrema<CUDA, Ctype>((Ctype*)m->d, m->len, result);
-
-      min_value = result[0];
-      max_value = result[1];
-      range = max_value - min_value;
-    }
-    else {
-      throw std::runtime_error(
-          "`extrema_scan` only supports `float` or `double`.");
-    }
+    // not to instantiate `probe_extrema` for other types
+    extrema_scan(
+        std::integral_constant<
+            bool, std::is_same<Ctype, float>::value or
+                      std::is_same<Ctype, double>::value>{},
+        max_value, min_value, range);
 
     return this;
   }
 
+ private:
+  void extrema_scan(
+      std::true_type, double& max_value, double& min_value, double& range)
+  {
+    // may not work for _uniptr
+    Ctype result[4];
+    // psz::thrustgpu_get_extrema_rawptr<Ctype>((Ctype*)m->d, m->len,
+    // result);
+    psz::probe_extrema<CUDA, Ctype>((Ctype*)m->d, m->len, result);
+
+    min_value = result[0];
+    max_value = result[1];
+    range = max_value - min_value;
+  }
+
+  void extrema_scan(std::false_type, double&, double&, double&)
+  {
+    throw std::runtime_error(
+        "`extrema_scan` only supports `float` or `double`.");
+  }
+
+ public:
+
   pszmem_cxx* control(
       std::vector<pszmem_control> control_stream,
       cudaStream_t stream = nullptr)
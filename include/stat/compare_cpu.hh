@@ -26,6 +26,14 @@ template <typename T>
 bool cppstd_error_bounded(
     T* a, T* b, szt const len, f8 const eb, szt* first_faulty_idx = nullptr);
 
+// Whether |a - b| <= eb everywhere (NaN fails), in chunks in parallel; the
+// first violation is exact either way. Without `count`, threads stop early
+// once one is found; with it, all are counted.
+template <typename T>
+bool cppstd_verify_eb(
+    T const* a, T const* b, szt const len, f8 const eb, szt* first = nullptr,
+    szt* count = nullptr);
+
 template <typename T>
 void cppstd_assess_quality(pszsummary* s, T* xdata, T* odata, szt const len);
 
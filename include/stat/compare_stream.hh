@@ -0,0 +1,53 @@
+/**
+ * @file compare_stream.hh
+ * @author Jiannan Tian
+ * @brief Out-of-core quality assessment, and the extrema scan fused with
+ * loading, streaming from files.
+ * @version 0.4
+ * @date 2023-09-24
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef F2B6D1E8_7C4A_4F93_A0D5_3E9B8C61F247
+#define F2B6D1E8_7C4A_4F93_A0D5_3E9B8C61F247
+
+#include <cstddef>
+#include <functional>
+
+#include "cusz/type.h"
+
+namespace psz {
+
+constexpr size_t STREAM_SLAB_BYTES = 256ul << 20;
+
+// Called on each slab in order, with the index of its first element and its
+// metrics; `max_err.idx` is into the whole field.
+using slab_report = std::function<void(size_t, pszsummary const&)>;
+
+// `cppstd_assess_quality` on two files of T that are mapped a slab (of about
+// `slab_bytes` per file, aligned to pages) at a time, so that neither is held
+// in memory as a whole; the metrics in total are merged from the slabs.
+template <typename T>
+void stream_assess_quality(
+    pszsummary* s, char const* xfile, char const* ofile,
+    size_t slab_bytes = STREAM_SLAB_BYTES,
+    slab_report const& per_slab = nullptr);
+
+// the same, with the reconstructed data already in memory
+template <typename T>
+void stream_assess_quality(
+    pszsummary* s, T const* xdata, char const* ofile,
+    size_t slab_bytes = STREAM_SLAB_BYTES,
+    slab_report const& per_slab = nullptr);
+
+// Loads `len` elements of `fname` into `dst` through a map of the file, with
+// `cppstd_extrema` on each chunk right after it is copied; `res` is min,
+// max, mean and range.
+template <typename T>
+void load_with_extrema(char const* fname, T* dst, size_t const len, T res[4]);
+
+}  // namespace psz
+
+#endif /* F2B6D1E8_7C4A_4F93_A0D5_3E9B8C61F247 */
@@ -0,0 +1,53 @@
+/**
+ * @file spatial_cpu.hh
+ * @author Jiannan Tian
+ * @brief Spatial quality metrics on host: SSIM, and the autocorrelation and
+ * spectrum of the error.
+ * @version 0.4
+ * @date 2023-09-25
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef D81C5A3F_92B7_4E06_8F1A_6C4E27B9D035
+#define D81C5A3F_92B7_4E06_8F1A_6C4E27B9D035
+
+#include "cusz/nd.h"
+#include "cusz/type.h"
+
+namespace psz {
+
+constexpr int SSIM_WINDOW = 7;
+constexpr int SSIM_SHIFT = 2;
+constexpr int SPECTRUM_NBAND = 8;
+
+// Mean SSIM over `window`-wide boxes (clamped to the extents of the field)
+// placed every `shift` along each axis; the constants are from the range of
+// `odata`, as (0.01 * range)^2 and (0.03 * range)^2.
+template <typename T>
+f8 cppstd_ssim(
+    T const* xdata, T const* odata, psz_dim3 const len3,
+    int const window = SSIM_WINDOW, int const shift = SSIM_SHIFT,
+    float* time = nullptr);
+
+// Autocorrelation of the error `xdata - odata` at each of `lags` along x, y
+// and z, in `out[3 * i + axis]`; NaN where the axis is not longer than the
+// lag.
+template <typename T>
+void cppstd_error_autocorr(
+    T const* xdata, T const* odata, psz_dim3 const len3, int const* lags,
+    int const nlag, f8* out, float* time = nullptr);
+
+// The share of the variance of the error in octave bands along x, y and z,
+// from Haar details; band 0 is the highest, [fs/4, fs/2). A white error has
+// about 1/2, 1/4, ..., and a correlated one less in the high bands. NaN for
+// an axis of length 1.
+template <typename T>
+void cppstd_error_spectrum(
+    T const* xdata, T const* odata, psz_dim3 const len3,
+    f8 out[3][SPECTRUM_NBAND], float* time = nullptr);
+
+}  // namespace psz
+
+#endif /* D81C5A3F_92B7_4E06_8F1A_6C4E27B9D035 */
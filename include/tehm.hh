@@ -51,7 +51,20 @@ struct TEHM {
 };
 
 using CompressorF4 = cusz::Compressor<cusz::TEHM<f4>>;
-using CompressorF8 = cusz::Compressor<cusz::TEHM<f8>>;
+// FP64 prequantization, so that tight error bounds on f8 input hold
+using CompressorF8 = cusz::Compressor<cusz::TEHM<f8, false>>;
+// half-precision input, prequantized in FP32
+using CompressorF2 = cusz::Compressor<cusz::TEHM<f2>>;
+using CompressorBF2 = cusz::Compressor<cusz::TEHM<bf2>>;
+// integer input: lossless (eb = 0) or near-lossless (integer eb)
+using CompressorU1 = cusz::Compressor<cusz::TEHM<u1>>;
+using CompressorU2 = cusz::Compressor<cusz::TEHM<u2>>;
+using CompressorU4 = cusz::Compressor<cusz::TEHM<u4>>;
+using CompressorU8 = cusz::Compressor<cusz::TEHM<u8>>;
+using CompressorI1 = cusz::Compressor<cusz::TEHM<i1>>;
+using CompressorI2 = cusz::Compressor<cusz::TEHM<i2>>;
+using CompressorI4 = cusz::Compressor<cusz::TEHM<i4>>;
+using CompressorI8 = cusz::Compressor<cusz::TEHM<i8>>;
 
 }  // namespace cusz
 
@@ -84,6 +84,8 @@ template <> struct FastLowPrecisionTrait<true>  { typedef f4 type; };
 template <> struct FastLowPrecisionTrait<false> { typedef f8 type; };
 
 template <psz_dtype T> struct Ctype;
+template <> struct Ctype<F2> { typedef f2 type; static const int width = sizeof(f2); };
+template <> struct Ctype<BF2> { typedef bf2 type; static const int width = sizeof(bf2); };
 template <> struct Ctype<F4> { typedef f4 type; static const int width = sizeof(f4); };
 template <> struct Ctype<F8> { typedef f8 type; static const int width = sizeof(f8); };
 template <> struct Ctype<I1> { typedef i1 type; static const int width = sizeof(i1); };
@@ -97,6 +99,8 @@ template <> struct Ctype<U8> { typedef u8 type; static const int width = sizeof(
 template <> struct Ctype<ULL>{ typedef ull type; static const int width = sizeof(ull); };
 
 template <typename Ctype> struct PszType;
+template <> struct PszType<f2> { static const psz_dtype type = F2; static const int width = sizeof(f2); };
+template <> struct PszType<bf2> { static const psz_dtype type = BF2; static const int width = sizeof(bf2); };
 template <> struct PszType<f4> { static const psz_dtype type = F4; static const int width = sizeof(f4); };
 template <> struct PszType<f8> { static const psz_dtype type = F8; static const int width = sizeof(f8); };
 template <> struct PszType<i1> { static const psz_dtype type = I1; static const int width = sizeof(i1); };
@@ -0,0 +1,163 @@
+/**
+ * @file async_cpu.hh
+ * @author Jiannan Tian
+ * @brief The executor behind `psz_compress_async` and
+ * `psz_decompress_async`: one host thread running tasks in order, with
+ * completion callbacks.
+ * @version 0.4
+ * @date 2023-09-27
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef D2B7F4A9_8C1E_4A36_B5D0_7E9C3F1A6B48
+#define D2B7F4A9_8C1E_4A36_B5D0_7E9C3F1A6B48
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "cusz/type.h"
+
+struct psz_task {
+  std::function<pszerror()> work;
+  psz_callback callback;
+  void* user;
+
+  std::mutex m;
+  std::condition_variable cv;
+  bool done{false};
+  pszerror status{CUSZ_SUCCESS};
+};
+
+namespace psz {
+namespace cpu {
+
+// Whether this is the thread of the executor, where waiting for a task that
+// is not done would never end.
+inline bool& on_executor()
+{
+  thread_local bool flag = false;
+  return flag;
+}
+
+// One background thread running tasks in the order of submission; a
+// compressor is not safe to share, so tasks on one are kept serial. Drained
+// at exit.
+class executor {
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<psz_task*> queue;
+  bool stop{false};
+  std::thread worker;
+
+  static void run(psz_task* t)
+  {
+    pszerror status;
+    try {
+      status = t->work();
+    }
+    catch (std::exception const& e) {
+      fprintf(stderr, "[psz::error::async] %s\n", e.what());
+      status = CUSZ_FAIL_UNSUPPORTED_PIPELINE;
+    }
+
+    // done before the callback, which may then wait for or release the
+    // task; `t` is not to be touched after it is seen as done
+    auto callback = t->callback;
+    auto user = t->user;
+    {
+      std::lock_guard<std::mutex> lk(t->m);
+      t->status = status, t->done = true;
+      t->cv.notify_all();
+    }
+    if (callback) callback(t, status, user);
+  }
+
+  void loop()
+  {
+    on_executor() = true;
+    while (true) {
+      psz_task* t;
+      {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return stop or not queue.empty(); });
+        if (queue.empty()) return;
+        t = queue.front(), queue.pop_front();
+      }
+      run(t);
+    }
+  }
+
+  executor() : worker([this] { loop(); }) {}
+
+ public:
+  static executor& get()
+  {
+    static executor e;
+    return e;
+  }
+
+  ~executor()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  psz_task* submit(
+      std::function<pszerror()> work, psz_callback callback, void* user)
+  {
+    auto t = new psz_task;
+    t->work = std::move(work), t->callback = callback, t->user = user;
+    {
+      std::lock_guard<std::mutex> lk(m);
+      queue.push_back(t);
+    }
+    cv.notify_one();
+    return t;
+  }
+};
+
+// as `psz_task_poll`, `psz_task_wait` and `psz_task_release`
+inline int task_poll(psz_task* task)
+{
+  std::lock_guard<std::mutex> lk(task->m);
+  return task->done ? 1 : 0;
+}
+
+inline pszerror task_wait(psz_task* task)
+{
+  std::unique_lock<std::mutex> lk(task->m);
+  if (not task->done and on_executor()) {
+    fprintf(
+        stderr,
+        "[psz::error::async] A callback waits for a task queued after it.\n");
+    return CUSZ_FAIL_DATA_NOT_READY;
+  }
+  task->cv.wait(lk, [&] { return task->done; });
+  return task->status;
+}
+
+inline pszerror task_release(psz_task* task)
+{
+  auto status = task_wait(task);
+  // kept, as it is still queued
+  if (status == CUSZ_FAIL_DATA_NOT_READY and not task_poll(task))
+    return status;
+  delete task;
+  return status;
+}
+
+}  // namespace cpu
+}  // namespace psz
+
+#endif /* D2B7F4A9_8C1E_4A36_B5D0_7E9C3F1A6B48 */
@@ -51,8 +51,8 @@ static const char cusz_short_doc[] =
     "  h : print full-length help document\n"
     "\n"
     "  i file  : path to input datum\n"
-    "  t dtype : f32 or fp4 (to be updated)\n"
-    "  m mode  : compression mode; abs, r2r\n"
+    "  t dtype : f32 (f4) or f64 (f8)\n"
+    "  m mode  : compression mode; abs, r2r, pwr\n"
     "  e eb    : error bound; default 1e-4\n"
     "  l size  : \"-l x\" for 1D; \"-l [X]x[Y]\" for 2D; \"-l [X]x[Y]x[Z]\" for 3D\n"
     // "  p pred  : select predictor from \"lorenzo\" and \"spline3d\"\n"
@@ -61,6 +61,9 @@ static const char cusz_short_doc[] =
     "      syntax: opt=v, \"kw1=val1,kw1=val2[,...]\"\n"
     "      + eb     error bound\n"
     "      + radius The number of quant-codes is 2x radius.\n"
+    "      + codec  huffman (default) or rans\n"
+    "      + rle    run-length stage before codec; on, off (default), force\n"
+    "      + layers progressive layers, each eb tighter by layerratio (10)\n"
     "      + demo  load predefined lengths for demo datasets\n"
     "          - skipping \"-l x[,y[,z]]\"\n"
     "          - (1D) hacc  hacc1b  (2D) cesm  exafel\n"
@@ -70,7 +73,7 @@ static const char cusz_short_doc[] =
     "      example: \"--config demo=cesm,radius=512\"\n"
     "  report list: \n"
     "      syntax: opt[=v], \"kw1[=(on|off)],kw2[=(on|off)]\n"
-    "      keyworkds: time, quality\n"
+    "      keyworkds: time, quality, spatial (SSIM, error ACF and spectrum)\n"
     "      example: \"--report time\", \"--report time=off\"\n"
     "\n"
     "example:\n"
@@ -109,17 +112,24 @@ static const char cusz_full_doc[] =
     "        *-r* or *--dry-*@r@*un*\n"
     "                No lossless Huffman codec. Only to get data quality summary.\n"
     "                In addition, quant. rep. and dict. size are retained\n"
+    "        *--dryrun-cpu*\n"
+    "                Dryrun on CPU, as *-r* does when no GPU is present.\n"
     "\n"
-    "        *-m* or *--*@m@*ode* <abs|r2r>\n"
+    "        *-m* or *--*@m@*ode* <abs|r2r|pwr>\n"
     "                Specify error-controlling mode. Supported modes include:\n"
     "                _abs_: absolute mode, eb = input eb\n"
     "                _r2r_: relative-to-value-range mode, eb = input eb x value range\n"
+    "                _pwr_: point-wise relative mode, |x' - x| <= eb |x| (FP32/FP64)\n"
     "\n"
     "        *-e* or *--eb* or *--error-bound* [num]\n"
     "                Specify error bound. e.g., _1.23_, _1e-4_, _1.23e-4.56_\n"
     "\n"
     "        *-i* or *--*@i@*nput* [file]\n"
     "\n"
+    "        *--target* cr=[num] or psnr=[num]\n"
+    "                In place of *-e*, tune eb on samples of the input to reach a\n"
+    "                compression ratio, or a PSNR in dB, then compress once.\n"
+    "\n"
     "        *-d* or *--dict-size* [256|512|1024|...]\n"
     "                Specify dictionary size/quantization bin number.\n"
     "                Should be a power-of-2.\n"
@@ -133,9 +143,12 @@ static const char cusz_full_doc[] =
     "\n"
     "    *Additional*\n"
     "        *-p* or *--*@p@*redictor*\n"
-    "                Select predictor from \"lorenzo\" (default) or \"spline3d\" (3D only).\n"
+    "                Select predictor from \"lorenzo\" (default) or \"spline3d\" (3D only),\n"
+    "                or \"auto\" to pick the one estimated to compress better on sampled blocks.\n"
     "        *--origin* or *--compare* /path/to/origin-datum\n"
     "                For verification & get data quality evaluation.\n"
+    "                Without -z, -x or -r, compare the input (of -t) to it, streamed slab by slab\n"
+    "                from both files, with metrics per slab and in total.\n"
     "        *--opath*  /path/to\n"
     "                Specify alternative output path.\n"
     "\n"
@@ -144,15 +157,16 @@ static const char cusz_full_doc[] =
     "                Disable functionality modules. Supported module(s) include:\n"
     "                _huffman_  Huffman codec after prediction+quantization (p+q) and before reversed p+q.\n"
     "                _write2disk_  Skip write decompression data.\n"
-    //    "\n"
-    //    "        *-p* or *--pre* _method-1_,_method-2_,...,_method-n_\n"
-    //    "                Enable preprocessing. Supported preprocessing method(s) include:\n"
-    //    "                _binning_  Downsampling datum by 2x2 to 1.\n"
+    "\n"
+    "        *-P* or *--pre* _binning_|_binning2x1_|_binning1x2_\n"
+    "                Also archive a preview, downsampled by 2x2 (default), 2x1 or 1x2 to 1.\n"
+    "        *--preview*\n"
+    "                Decompress only the preview, if archived, to _.cuszp_.\n"
     "\n"
     "    *Print Report to stdout*\n"
     "        *--report* (option=on/off)-list\n"
     "                Syntax: opt[=v], \"kw1[=(on|off)],kw2=[=(on|off)]\n"
-    "                Keyworkds: time  quality  compressibility\n"
+    "                Keyworkds: time  quality  compressibility  spatial\n"
     "                Example: \"--report time\", \"--report time=off\"\n"
     "\n"
     "    *Demonstration*\n"
@@ -166,6 +180,13 @@ static const char cusz_full_doc[] =
     //    "                Get archive metadata. (TODO)\n"
     "\n"
     "    *Advanced Runtime Configuration*\n"
+    "        *--cpu-pin* <none|compact|scatter>\n"
+    "                Pin host workers to cores. (default: none)\n"
+    "                _compact_ fills a NUMA node before the next; _scatter_ takes turns.\n"
+    "        *--numa-touch*\n"
+    "                Zero host buffers by the workers that use them, before page-locking,\n"
+    "                so that pages land on their NUMA nodes. Best with *--cpu-pin*.\n"
+    "\n"
     "        *--demo* [demo-dataset]\n"
     "                Use demo dataset, will omit given dimension(s). Supported datasets include:\n"
     "                1D: _hacc_  _hacc1b_    2D: _cesm_  _exafel_\n"
@@ -176,6 +197,12 @@ static const char cusz_full_doc[] =
     "                   + *eb*=<val>    error bound\n"
     "                   + *cap*=<val>   capacity, number of quant-codes\n"
     "                   + *demo*=<val>  skip length input (\"-l x[,y[,z]]\"), alternative to \"--demo dataset\"\n"
+    "                   + *codec*=<huffman|rans>\n"
+    "                       Lossless codec for quant-codes. (default: huffman)\n"
+    "                       _rans_ is interleaved rANS on CPU, better for highly skewed quant-codes.\n"
+    "                   + *rle*=<on|off|force>\n"
+    "                       Run-length stage (CPU) before the codec. (default: off)\n"
+    "                       _on_ applies it only when quant-codes are dominated by long runs.\n"
     "\n"
     "               Other internal parameters:\n"
     "                   + *quantbyte*=<1|2>\n"
@@ -0,0 +1,166 @@
+/**
+ * @file half_cpu.hh
+ * @author Jiannan Tian
+ * @brief Host-side FP16/BF16 <-> FP32 conversion.
+ * @version 0.4
+ * @date 2023-09-19
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef B7E2C9A1_4F3D_4C8E_A6B5_9D1E0F2C3B84
+#define B7E2C9A1_4F3D_4C8E_A6B5_9D1E0F2C3B84
+
+#include <cstddef>
+#include <cstring>
+
+#include "cusz/type.h"
+
+// F16C, if the CPU has it, without building for it (e.g., -march=native)
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define PSZ_HALF_F16C
+#include <immintrin.h>
+#endif
+
+namespace psz {
+namespace cpu {
+
+inline f4 u4_as_f4(u4 u)
+{
+  f4 f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+inline u4 f4_as_u4(f4 f)
+{
+  u4 u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+// binary16 to FP32, exact (incl. subnormal, inf and NaN)
+inline f4 half_to_f4(u2 h)
+{
+  constexpr u4 shifted_exp = 0x7c00u << 13;
+  u4 o = (h & 0x7fffu) << 13;
+  auto exp = o & shifted_exp;
+  o += (127 - 15) << 23;
+
+  if (exp == shifted_exp)  // inf or NaN
+    o += (128 - 16) << 23;
+  else if (exp == 0) {  // zero or subnormal, renormalized in FP32
+    o += 1 << 23;
+    o = f4_as_u4(u4_as_f4(o) - u4_as_f4(113u << 23));
+  }
+
+  return u4_as_f4(o | (u4)(h & 0x8000u) << 16);
+}
+
+// FP32 to binary16, rounding to nearest even
+inline u2 f4_to_half(f4 f)
+{
+  constexpr u4 f32_inf = 255u << 23;
+  constexpr u4 f16_max = (127u + 16) << 23;
+  constexpr u4 denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+  auto u = f4_as_u4(f);
+  auto sign = u & 0x80000000u;
+  u ^= sign;
+  u2 o;
+
+  if (u >= f16_max)  // overflow to inf; NaN stays NaN
+    o = u > f32_inf ? 0x7e00 : 0x7c00;
+  else if (u < (113u << 23))  // subnormal or zero
+    o = f4_as_u4(u4_as_f4(u) + u4_as_f4(denorm_magic)) - denorm_magic;
+  else {
+    auto mant_odd = (u >> 13) & 1;
+    u += ((u4)(15 - 127) << 23) + 0xfff + mant_odd;
+    o = u >> 13;
+  }
+
+  return o | (u2)(sign >> 16);
+}
+
+inline f4 bf16_to_f4(u2 h) { return u4_as_f4((u4)h << 16); }
+
+// FP32 to bfloat16, rounding to nearest even
+inline u2 f4_to_bf16(f4 f)
+{
+  auto u = f4_as_u4(f);
+  if ((u & 0x7fffffffu) > 0x7f800000u) return (u >> 16) | 0x40;  // NaN
+  return (u + 0x7fffu + ((u >> 16) & 1)) >> 16;
+}
+
+#ifdef PSZ_HALF_F16C
+namespace detail {
+
+inline bool has_f16c()
+{
+  static bool const v = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") and __builtin_cpu_supports("f16c");
+  }();
+  return v;
+}
+
+// the first multiple of 8, converted; the rest is left to the caller
+__attribute__((target("avx,f16c"))) inline size_t to_f4_f16c(
+    f2 const* in, f4* out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(
+        out + i, _mm256_cvtph_ps(_mm_loadu_si128((__m128i const*)(in + i))));
+  return i;
+}
+
+__attribute__((target("avx,f16c"))) inline size_t from_f4_f16c(
+    f4 const* in, f2* out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128(
+        (__m128i*)(out + i),
+        _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+  return i;
+}
+
+}  // namespace detail
+#endif
+
+// Array conversion; binary16 uses F16C when the CPU has it (checked at run
+// time), and the BF16 loops are left to auto-vectorization.
+inline void to_f4(f2 const* in, f4* out, size_t n)
+{
+  size_t i = 0;
+#ifdef PSZ_HALF_F16C
+  if (detail::has_f16c()) i = detail::to_f4_f16c(in, out, n);
+#endif
+  for (; i < n; i++) out[i] = half_to_f4(in[i].bits);
+}
+
+inline void from_f4(f4 const* in, f2* out, size_t n)
+{
+  size_t i = 0;
+#ifdef PSZ_HALF_F16C
+  if (detail::has_f16c()) i = detail::from_f4_f16c(in, out, n);
+#endif
+  for (; i < n; i++) out[i].bits = f4_to_half(in[i]);
+}
+
+inline void to_f4(bf2 const* in, f4* out, size_t n)
+{
+  for (size_t i = 0; i < n; i++) out[i] = bf16_to_f4(in[i].bits);
+}
+
+inline void from_f4(f4 const* in, bf2* out, size_t n)
+{
+  for (size_t i = 0; i < n; i++) out[i].bits = f4_to_bf16(in[i]);
+}
+
+}  // namespace cpu
+}  // namespace psz
+
+#endif /* B7E2C9A1_4F3D_4C8E_A6B5_9D1E0F2C3B84 */
@@ -0,0 +1,239 @@
+/**
+ * @file numa_cpu.hh
+ * @author Jiannan Tian
+ * @brief Pinning of host workers to cores, and NUMA placement of host
+ * buffers by parallel first touch (Linux; no-ops elsewhere).
+ * @version 0.4
+ * @date 2023-09-30
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef C7D3A9E1_6F2B_4B80_91E4_5A0C8D6F2B13
+#define C7D3A9E1_6F2B_4B80_91E4_5A0C8D6F2B13
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cusz/type.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace psz {
+namespace cpu {
+
+// Per thread, for the scope of a call on a compressor (from its
+// `pszctx::cpu_pin` and `pszctx::use_numa_touch`) or of a CLI run; a pool
+// passes them on to its workers.
+inline pszpin& pinning_setting()
+{
+  thread_local pszpin v = PinNone;
+  return v;
+}
+
+inline bool& numa_touch_setting()
+{
+  thread_local bool v = false;
+  return v;
+}
+
+inline pszpin pinning() { return pinning_setting(); }
+inline bool numa_touch() { return numa_touch_setting(); }
+
+// Sets both for its scope, and then restores.
+struct placement_scope {
+  pszpin outer_pin;
+  bool outer_touch;
+  placement_scope(pszpin pin, bool touch) :
+      outer_pin(pinning()), outer_touch(numa_touch())
+  {
+    pinning_setting() = pin, numa_touch_setting() = touch;
+  }
+  ~placement_scope()
+  {
+    pinning_setting() = outer_pin, numa_touch_setting() = outer_touch;
+  }
+};
+
+inline size_t page_bytes()
+{
+#ifdef __linux__
+  auto p = sysconf(_SC_PAGESIZE);
+  if (p > 0) return p;
+#endif
+  return 4096;
+}
+
+namespace detail {
+
+// "0-3,8,10-11" as in sysfs
+inline std::vector<int> parse_cpulist(std::string const& s)
+{
+  std::vector<int> cpus;
+  std::stringstream ss(s);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() or range == "\n") continue;
+    auto dash = range.find('-');
+    auto lo = std::atoi(range.c_str());
+    auto hi = dash == std::string::npos ? lo : std::atoi(&range[dash + 1]);
+    for (auto c = lo; c <= hi; c++) cpus.push_back(c);
+  }
+  return cpus;
+}
+
+}  // namespace detail
+
+// The cores of each NUMA node that this process may run on; one node of
+// all cores if sysfs tells nothing.
+inline std::vector<std::vector<int>> const& numa_nodes()
+{
+  static auto const nodes = [] {
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    auto known = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    for (auto n = 0;; n++) {
+      std::ifstream f(
+          "/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+      if (not f) break;
+      std::string list;
+      std::getline(f, list);
+      std::vector<int> cpus;
+      for (auto c : detail::parse_cpulist(list))
+        if (not known or CPU_ISSET(c, &allowed)) cpus.push_back(c);
+      if (not cpus.empty()) nodes.push_back(cpus);
+    }
+#endif
+    if (nodes.empty()) {
+      nodes.emplace_back();
+      auto n = std::max(1u, std::thread::hardware_concurrency());
+      for (auto c = 0u; c < n; c++) nodes.back().push_back(c);
+    }
+    return nodes;
+  }();
+  return nodes;
+}
+
+// The core of worker `w`: _compact_ fills a node before the next, and
+// _scatter_ deals workers to nodes in turn; -1 without pinning.
+inline int core_of(int w, pszpin p = pinning())
+{
+  if (p == PinNone or w < 0) return -1;
+  auto& nodes = numa_nodes();
+  if (p == PinCompact) {
+    size_t total = 0;
+    for (auto& n : nodes) total += n.size();
+    auto k = w % total;
+    for (auto& n : nodes) {
+      if (k < n.size()) return n[k];
+      k -= n.size();
+    }
+  }
+  auto& n = nodes[w % nodes.size()];
+  return n[(w / nodes.size()) % n.size()];
+}
+
+// The slots (in the order of `core_of`) of the threads a pool spawns, held
+// for the life of the pool: the lowest free ones, so that a pool alone is
+// placed as the one before it was (as first touch relies on), and pools
+// side by side are not pinned to the same cores. Threads beyond the free
+// slots, and the caller, which the pool does not own, are left unpinned.
+class pin_lease {
+  pszpin mode;
+  std::vector<int> slots;
+
+  static std::mutex& m()
+  {
+    static std::mutex v;
+    return v;
+  }
+
+  static std::vector<bool>& taken()
+  {
+    static std::vector<bool> v;
+    return v;
+  }
+
+ public:
+  explicit pin_lease(int nspawn, pszpin p = pinning()) : mode(p)
+  {
+    if (mode == PinNone or nspawn <= 0) return;
+    size_t total = 0;
+    for (auto& n : numa_nodes()) total += n.size();
+
+    std::lock_guard<std::mutex> lk(m());
+    auto& t = taken();
+    t.resize(total, false);
+    for (size_t s = 0; s < total and (int)slots.size() < nspawn; s++)
+      if (not t[s]) t[s] = true, slots.push_back(s);
+  }
+
+  ~pin_lease()
+  {
+    if (slots.empty()) return;
+    std::lock_guard<std::mutex> lk(m());
+    for (auto s : slots) taken()[s] = false;
+  }
+
+  // of the `k`-th spawned thread; -1 for none (or the caller, at k = -1)
+  int slot(int k) const
+  {
+    return k >= 0 and k < (int)slots.size() ? slots[k] : -1;
+  }
+
+  // the core of the `k`-th spawned thread; -1 for none
+  int core(int k) const { return core_of(slot(k), mode); }
+
+  pin_lease(pin_lease const&) = delete;
+  pin_lease& operator=(pin_lease const&) = delete;
+};
+
+// Pins the calling thread to `core` for its scope, and then restores; none
+// for a negative core.
+class pin_scope {
+#ifdef __linux__
+  cpu_set_t outer;
+  bool pinned{false};
+#endif
+
+ public:
+  explicit pin_scope(int core)
+  {
+#ifdef __linux__
+    if (core < 0) return;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(outer), &outer)) return;
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(core, &one);
+    pinned = pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0;
+#endif
+  }
+
+  ~pin_scope()
+  {
+#ifdef __linux__
+    if (pinned) pthread_setaffinity_np(pthread_self(), sizeof(outer), &outer);
+#endif
+  }
+
+  pin_scope(pin_scope const&) = delete;
+  pin_scope& operator=(pin_scope const&) = delete;
+};
+
+}  // namespace cpu
+}  // namespace psz
+
+#endif /* C7D3A9E1_6F2B_4B80_91E4_5A0C8D6F2B13 */
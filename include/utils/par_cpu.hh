@@ -0,0 +1,160 @@
+/**
+ * @file par_cpu.hh
+ * @author Jiannan Tian
+ * @brief Minimal host-side parallel-for for CPU kernels.
+ * @version 0.4
+ * @date 2023-09-12
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef E1F1C3A4_5D2B_4E0B_9B7A_2C43E6C4D1A0
+#define E1F1C3A4_5D2B_4E0B_9B7A_2C43E6C4D1A0
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "utils/numa_cpu.hh"
+
+namespace psz {
+namespace cpu {
+
+// The threads this thread may use, when it is one of several sharing the
+// machine (e.g., the workers of a batch); 0 for no limit.
+inline int& thread_budget()
+{
+  thread_local int n = 0;
+  return n;
+}
+
+// Sets the budget of the thread for its scope.
+struct budget_scope {
+  int outer;
+  explicit budget_scope(int n) : outer(thread_budget())
+  {
+    thread_budget() = n;
+  }
+  ~budget_scope() { thread_budget() = outer; }
+};
+
+// `PSZ_NUM_THREADS` overrides the hardware concurrency; the budget of the
+// thread, if any, caps either.
+inline int nthread()
+{
+  auto n = (int)std::thread::hardware_concurrency();
+  if (auto env = std::getenv("PSZ_NUM_THREADS"))
+    if (std::atoi(env) > 0) n = std::atoi(env);
+  n = n > 0 ? n : 1;
+  return thread_budget() > 0 ? std::min(n, thread_budget()) : n;
+}
+
+// Whether this thread is already one of a pool (of `parallel_for` or of a
+// task scheduler); nested parallel loops then run in the calling thread.
+inline bool& in_pool()
+{
+  thread_local bool flag = false;
+  return flag;
+}
+
+// Marks the thread as in a pool for its scope.
+struct pool_scope {
+  bool outer;
+  pool_scope() : outer(in_pool()) { in_pool() = true; }
+  ~pool_scope() { in_pool() = outer; }
+};
+
+// Run `f(w)` for w in [0, nworker) on a pool, each worker in the placement
+// of the caller. Pinned, every worker is a thread of the pool, leased as in
+// `pin_lease`, and the caller, which the pool does not own, only waits; so a
+// pool alone has worker `w` on the same core as the one before it. Not
+// pinned, the caller is worker 0.
+template <typename F>
+void run_pool(int const nworker, F&& f)
+{
+  auto const pin = pinning();
+  auto const touch = numa_touch();
+  auto const nspawn = pin == PinNone ? nworker - 1 : nworker;
+
+  pin_lease lease(nspawn, pin);
+  auto worker = [&](int w) {
+    pool_scope scope;
+    placement_scope place(pin, touch);
+    pin_scope pinned(lease.core(w - (nworker - nspawn)));
+    f(w);
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(nspawn);
+  for (auto t = nworker - nspawn; t < nworker; t++)
+    pool.emplace_back(worker, t);
+  if (nspawn < nworker) worker(0);
+  for (auto& t : pool) t.join();
+}
+
+// Run `f(i)` for i in [0, n); indices are handed out one at a time so that
+// unevenly sized work items (e.g., chunks of a bitstream) stay balanced.
+// With first touch on, worker `w` instead takes the `w`-th of `nworker`
+// contiguous blocks, as `first_touch` places the pages.
+template <typename F>
+void parallel_for(size_t const n, F&& f, int nworker = -1)
+{
+  if (n == 0) return;
+  if (nworker <= 0) nworker = nthread();
+  nworker = (int)std::min<size_t>(nworker, n);
+
+  if (nworker == 1 or in_pool()) {
+    for (size_t i = 0; i < n; i++) f(i);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  auto const blocked = numa_touch();
+  run_pool(nworker, [&](int w) {
+    if (blocked)
+      for (auto i = n * w / nworker; i < n * (w + 1) / nworker; i++) f(i);
+    else
+      for (size_t i = next++; i < n; i = next++) f(i);
+  });
+}
+
+// Run `f(w)` once on each of `nworker` workers of `run_pool`; for work split
+// in fixed blocks, as first touch needs.
+template <typename F>
+void parallel_blocks(int nworker, F&& f)
+{
+  if (nworker <= 0) nworker = nthread();
+  if (nworker == 1 or in_pool()) {
+    for (auto w = 0; w < nworker; w++) f(w);
+    return;
+  }
+
+  run_pool(nworker, f);
+}
+
+// Zero `bytes` at `p` in `nworker` contiguous, page-aligned blocks, block
+// `w` by worker `w`, so that each page lands on the node of the worker that
+// goes on to use it when work is split the same way (as `parallel_for` does
+// with first touch on, and as `task_graph` hints and `tile_compress` do).
+inline void first_touch(void* p, size_t const bytes, int nworker = -1)
+{
+  if (nworker <= 0) nworker = nthread();
+  auto const page = page_bytes();
+  auto const npage = (bytes + page - 1) / page;
+
+  parallel_blocks(nworker, [&](int w) {
+    auto lo = std::min(bytes, npage * w / nworker * page);
+    auto hi = std::min(bytes, npage * (w + 1) / nworker * page);
+    if (hi > lo) memset((char*)p + lo, 0, hi - lo);
+  });
+}
+
+}  // namespace cpu
+}  // namespace psz
+
+#endif /* E1F1C3A4_5D2B_4E0B_9B7A_2C43E6C4D1A0 */
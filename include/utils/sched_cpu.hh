@@ -0,0 +1,195 @@
+/**
+ * @file sched_cpu.hh
+ * @author Jiannan Tian
+ * @brief A work-stealing scheduler of host tasks with dependencies.
+ * @version 0.4
+ * @date 2023-09-29
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef B6E2F0A9_4C1D_4F37_A85E_93D1C7B20E4F
+#define B6E2F0A9_4C1D_4F37_A85E_93D1C7B20E4F
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace cpu {
+
+// Per worker, in milliseconds; idle is the wall time less busy.
+struct sched_report {
+  double wall_ms{0};
+  std::vector<double> busy_ms;
+  std::vector<size_t> ntask, nsteal;
+
+  int nworker() const { return (int)busy_ms.size(); }
+
+  double utilization() const
+  {
+    if (wall_ms <= 0 or busy_ms.empty()) return 1;
+    double busy = 0;
+    for (auto b : busy_ms) busy += b;
+    return busy / (wall_ms * busy_ms.size());
+  }
+};
+
+// Tasks are added with the tasks they depend on, and then run once. Each
+// worker runs its own deque from the back, newest first, and when it runs
+// dry takes the oldest task from the front of another's. A task becoming
+// ready goes to the worker that finished its last dependency, or, without
+// stealing, to the worker of its hint, as a static partition would have it.
+class task_graph {
+ public:
+  using id = size_t;
+
+  id add(
+      std::function<void()> f, std::vector<id> const& deps = {},
+      int hint = -1)
+  {
+    auto t = nodes.size();
+    nodes.emplace_back(new node);
+    auto& n = *nodes.back();
+    n.f = std::move(f), n.hint = hint, n.ndep = (int)deps.size();
+    for (auto d : deps) nodes.at(d)->next.push_back(t);
+    return t;
+  }
+
+  size_t size() const { return nodes.size(); }
+
+  // The first exception of a task is rethrown, after the workers stop. In a
+  // pool already, the tasks run in the calling thread, as nested
+  // `parallel_for` loops do.
+  sched_report run(int nworker = -1, bool steal = true)
+  {
+    if (in_pool())
+      nworker = 1;
+    else if (nworker <= 0)
+      nworker = nthread();
+
+    sched_report r;
+    r.busy_ms.assign(nworker, 0), r.ntask.assign(nworker, 0);
+    r.nsteal.assign(nworker, 0);
+    if (nodes.empty()) return r;
+
+    std::vector<lane> lanes(nworker);
+    std::atomic<size_t> remaining{nodes.size()};
+    std::atomic<bool> abort{false};
+    std::exception_ptr error;
+    std::mutex error_m;
+
+    auto home = [&](id t, int self) {
+      if (steal and self >= 0) return self;
+      auto h = nodes[t]->hint;
+      return h >= 0 ? h % nworker : (int)(t % nworker);
+    };
+
+    for (id t = 0; t < nodes.size(); t++) {
+      nodes[t]->pending = nodes[t]->ndep;
+      if (nodes[t]->ndep == 0) lanes[home(t, -1)].q.push_back(t);
+    }
+
+    auto a = hires::now();
+
+    auto work = [&](int w) {
+      auto idle = 0;
+      while (remaining and not abort) {
+        id t;
+        auto stolen = false;
+        auto found = lanes[w].pop_back(t);
+        for (auto k = 1; steal and not found and k < nworker; k++)
+          found = stolen = lanes[(w + k) % nworker].pop_front(t);
+
+        if (not found) {
+          // short spins, then sleeps, until a dependency is done
+          if (++idle < 64)
+            std::this_thread::yield();
+          else
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+          continue;
+        }
+        idle = 0;
+
+        auto t0 = hires::now();
+        try {
+          nodes[t]->f();
+        }
+        catch (...) {
+          std::lock_guard<std::mutex> lk(error_m);
+          if (not error) error = std::current_exception();
+          abort = true;
+        }
+        r.busy_ms[w] +=
+            static_cast<duration_t>(hires::now() - t0).count() * 1000;
+        r.ntask[w]++, r.nsteal[w] += stolen;
+
+        for (auto s : nodes[t]->next)
+          if (--nodes[s]->pending == 0) lanes[home(s, w)].push_back(s);
+        remaining--;
+      }
+    };
+
+    if (nworker == 1) {
+      pool_scope scope;
+      work(0);
+    }
+    else
+      run_pool(nworker, work);
+
+    r.wall_ms = static_cast<duration_t>(hires::now() - a).count() * 1000;
+    if (error) std::rethrow_exception(error);
+    return r;
+  }
+
+ private:
+  struct node {
+    std::function<void()> f;
+    std::vector<id> next;
+    int hint, ndep;
+    std::atomic<int> pending;
+  };
+
+  struct lane {
+    std::mutex m;
+    std::deque<id> q;
+
+    void push_back(id t)
+    {
+      std::lock_guard<std::mutex> lk(m);
+      q.push_back(t);
+    }
+    bool pop_back(id& t)
+    {
+      std::lock_guard<std::mutex> lk(m);
+      if (q.empty()) return false;
+      t = q.back(), q.pop_back();
+      return true;
+    }
+    bool pop_front(id& t)
+    {
+      std::lock_guard<std::mutex> lk(m);
+      if (q.empty()) return false;
+      t = q.front(), q.pop_front();
+      return true;
+    }
+  };
+
+  std::vector<std::unique_ptr<node>> nodes;
+};
+
+}  // namespace cpu
+}  // namespace psz
+
+#endif /* B6E2F0A9_4C1D_4F37_A85E_93D1C7B20E4F */
@@ -19,6 +19,8 @@
 
 #include "header.h"
 #include "mem/memseg_cxx.hh"
+#include "stat/compare_stream.hh"
+#include "stat/spatial_cpu.hh"
 #include "stat/compare_thrust.hh"
 #include "verify.hh"
 #include "port.hh"
@@ -82,6 +84,52 @@ static void print_metrics_auto(double* lag1_cor, double* lag2_cor)
   printf("\n");
 };
 
+// on host; windowed SSIM, and the autocorrelation and spectrum of the error
+template <typename T>
+static void print_metrics_spatial(T* xdata, T* odata, psz_dim3 len3)
+{
+  auto printhead = [](const char* s1, const char* s2, const char* s3,
+                      const char* s4, const char* s5) {
+    printf(
+        "  \e[1m\e[31m%-10s %16s %16s %16s %16s\e[0m\n", s1, s2, s3, s4, s5);
+  };
+
+  float t_ssim, t_acf, t_spec;
+  auto ssim = psz::cppstd_ssim<T>(
+      xdata, odata, len3, SSIM_WINDOW, SSIM_SHIFT, &t_ssim);
+
+  int lags[] = {1, 2, 4, 8};
+  f8 acf[4 * 3];
+  psz::cppstd_error_autocorr<T>(xdata, odata, len3, lags, 4, acf, &t_acf);
+
+  f8 spec[3][SPECTRUM_NBAND];
+  psz::cppstd_error_spectrum<T>(xdata, odata, len3, spec, &t_spec);
+
+  printf(
+      "\nspatial metrics (window %d, shift %d; %.3f ms, %.3f ms, %.3f ms):\n",
+      SSIM_WINDOW, SSIM_SHIFT, t_ssim, t_acf, t_spec);
+  printhead("", "SSIM", "", "", "");
+  printf("  %-10s %16.8g\n", "", ssim);
+
+  printhead("error ACF", "lag 1", "lag 2", "lag 4", "lag 8");
+  char const* axis[] = {"along x", "along y", "along z"};
+  for (auto a = 0; a < 3; a++)
+    printf(
+        "  %-10s %16.8g %16.8g %16.8g %16.8g\n", axis[a], acf[a], acf[3 + a],
+        acf[6 + a], acf[9 + a]);
+
+  // white error: 1/2, 1/4, 1/8, 1/16
+  printhead("err. band", "[1/4, 1/2)", "[1/8, 1/4)", "[1/16, 1/8)", "lower");
+  for (auto a = 0; a < 3; a++) {
+    f8 lower = 0;
+    for (auto b = 3; b < SPECTRUM_NBAND; b++)
+      if (not std::isnan(spec[a][b])) lower += spec[a][b];
+    printf(
+        "  %-10s %16.8g %16.8g %16.8g %16.8g\n", axis[a], spec[a][0],
+        spec[a][1], spec[a][2], lower);
+  }
+}
+
 template <typename T>
 static void eval_dataquality_gpu(
     T* reconstructed, T* origin, size_t len, size_t compressed_bytes = 0)
@@ -142,9 +190,10 @@ static void eval_dataquality_cpu(
 template <typename T>
 static void view(
     cusz_header* header, pszmem_cxx<T>* xdata, pszmem_cxx<T>* cmp,
-    string const& compare)
+    string const& compare, bool spatial = false)
 {
   auto len = psz_utils::uncompressed_len(header);
+  auto len3 = psz_dim3{header->x, header->y, header->z};
   auto compressd_bytes = psz_utils::filesize(header);
 
   auto compare_on_gpu = [&]() {
@@ -153,14 +202,23 @@ static void view(
         ->control({H2D});
 
     eval_dataquality_gpu(xdata->dptr(), cmp->dptr(), len, compressd_bytes);
+    if (spatial) {
+      xdata->control({D2H});
+      print_metrics_spatial<T>(xdata->hptr(), cmp->hptr(), len3);
+    }
     // cmp->control({FreeHost, Free});
   };
 
+  // the original is streamed from file, not to be held in memory as well
   auto compare_on_cpu = [&]() {
-    cmp->control({MallocHost})->file(compare.c_str(), FromFile);
-    cmp->control({D2H});
-    eval_dataquality_cpu(xdata->hptr(), cmp->hptr(), len, compressd_bytes);
-    // cmp->control({FreeHost});
+    xdata->control({D2H});
+    cusz_stats stat;
+    psz::stream_assess_quality<T>(&stat, xdata->hptr(), compare.c_str());
+    print_metrics_cross<T>(&stat, compressd_bytes, false);
+    if (spatial)
+      printf(
+          "\n(spatial metrics skipped: they need the whole original in "
+          "memory)\n");
   };
 
   if (compare != "") {
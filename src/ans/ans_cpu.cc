@@ -0,0 +1,315 @@
+/**
+ * @file ans_cpu.cc
+ * @author Jiannan Tian
+ * @brief Interleaved rANS codec for quant-codes (CPU).
+ * @version 0.4
+ * @date 2023-09-12
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "ans/ans.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace {
+
+constexpr u4 ANS_M = 1u << psz::ANS_PROB_BITS;
+constexpr u4 ANS_MASK = ANS_M - 1;
+
+size_t pad8(size_t n) { return (n + 7) / 8 * 8; }
+
+// Scale `freq` so that it sums up to ANS_M while every present symbol keeps a
+// nonzero frequency; the rounding residue is absorbed by the largest ones.
+void ans_normalize(u4* freq, int const bklen, std::vector<u4>& nfreq)
+{
+  u8 total = 0;
+  int nnz = 0;
+  for (auto i = 0; i < bklen; i++) total += freq[i], nnz += freq[i] != 0;
+
+  if (total == 0)
+    throw std::runtime_error("[psz::error::ans] empty histogram.");
+  if (nnz > (int)(ANS_M / 2))
+    throw std::runtime_error(
+        "[psz::error::ans] too many distinct symbols for the probability "
+        "resolution.");
+
+  nfreq.assign(bklen, 0);
+  i8 sum = 0;
+  for (auto i = 0; i < bklen; i++) {
+    if (freq[i] == 0) continue;
+    auto f = ((u8)freq[i] * ANS_M + total / 2) / total;
+    nfreq[i] = std::max<u8>(f, 1);
+    sum += nfreq[i];
+  }
+
+  auto argmax = [&]() {
+    return std::max_element(nfreq.begin(), nfreq.end()) - nfreq.begin();
+  };
+
+  i8 excess = sum - ANS_M;
+  if (excess < 0) nfreq[argmax()] += -excess;
+  while (excess > 0) {
+    // never let a present symbol drop to zero
+    auto i = argmax();
+    auto take = std::min<i8>(excess, nfreq[i] - 1);
+    nfreq[i] -= take, excess -= take;
+  }
+}
+
+template <typename E>
+void ans_encode_chunk(
+    E* in, size_t const n, u4 const* nfreq, u4 const* cum, int const bklen,
+    std::vector<u2>& buf, std::atomic<bool>& bad_symbol)
+{
+  using namespace psz;
+
+  buf.resize(n + 2 * ANS_LANES);
+  auto end = buf.data() + buf.size();
+  auto p = end;
+
+  u4 x[ANS_LANES];
+  for (auto l = 0; l < ANS_LANES; l++) x[l] = ANS_LOWER;
+
+  constexpr u8 XMAX_UNIT = (u8)(ANS_LOWER >> ANS_PROB_BITS) << 16;
+
+  for (auto i = n; i-- > 0;) {
+    auto l = i % ANS_LANES;
+    auto s = (u4)in[i];
+    if (s >= (u4)bklen or nfreq[s] == 0) {
+      bad_symbol = true;
+      return;
+    }
+    auto f = nfreq[s];
+
+    if (x[l] >= XMAX_UNIT * f) {
+      *--p = x[l] & 0xffff;
+      x[l] >>= 16;
+    }
+    x[l] = ((x[l] / f) << ANS_PROB_BITS) + (x[l] % f) + cum[s];
+  }
+
+  // states are read first when decoding, lane 0 foremost
+  for (auto l = ANS_LANES; l-- > 0;) {
+    *--p = x[l] >> 16;
+    *--p = x[l] & 0xffff;
+  }
+
+  buf.erase(buf.begin(), buf.begin() + (p - buf.data()));
+}
+
+template <typename E>
+void ans_decode_chunk(
+    u2 const* p, size_t const n, E const* slot_sym, u4 const* slot_fb, E* out)
+{
+  using namespace psz;
+
+  u4 x[ANS_LANES];
+  for (auto l = 0; l < ANS_LANES; l++, p += 2)
+    x[l] = (u4)p[0] | ((u4)p[1] << 16);
+
+  size_t i = 0;
+  for (; i + ANS_LANES <= n; i += ANS_LANES) {
+    // lane-independent part; written to be vectorized (gather) by compiler
+    for (auto l = 0; l < ANS_LANES; l++) {
+      auto slot = x[l] & ANS_MASK;
+      auto fb = slot_fb[slot];
+      out[i + l] = slot_sym[slot];
+      x[l] = (fb & 0xffff) * (x[l] >> ANS_PROB_BITS) + (fb >> 16);
+    }
+    // renormalization consumes the shared stream in lane order
+    for (auto l = 0; l < ANS_LANES; l++)
+      if (x[l] < ANS_LOWER) x[l] = (x[l] << 16) | *p++;
+  }
+
+  for (auto l = 0; i < n; i++, l++) {
+    auto slot = x[l] & ANS_MASK;
+    auto fb = slot_fb[slot];
+    out[i] = slot_sym[slot];
+    x[l] = (fb & 0xffff) * (x[l] >> ANS_PROB_BITS) + (fb >> 16);
+    if (x[l] < ANS_LOWER) x[l] = (x[l] << 16) | *p++;
+  }
+}
+
+}  // namespace
+
+int psz::ans_tune_sublen(size_t const len)
+{
+  auto npart = 4 * (size_t)psz::cpu::nthread();
+  return std::max<size_t>((len - 1) / npart + 1, ANS_MIN_SUBLEN);
+}
+
+size_t psz::ans_encoded_bound(
+    size_t const len, int const bklen, int const sublen)
+{
+  auto pardeg = (len - 1) / sublen + 1;
+  return pad8(sizeof(ans_header)) + pad8(sizeof(u2) * bklen) +
+         pad8(sizeof(u4) * (pardeg + 1)) + sizeof(u2) * len +
+         pardeg * ANS_LANES * sizeof(u4);
+}
+
+f8 psz::ans_avg_bits(u4* freq, int const bklen)
+{
+  std::vector<u4> nfreq;
+  ans_normalize(freq, bklen, nfreq);
+
+  u8 total = 0;
+  for (auto i = 0; i < bklen; i++) total += freq[i];
+
+  f8 bits = 0;
+  for (auto i = 0; i < bklen; i++)
+    if (freq[i] != 0)
+      bits += -std::log2(1.0 * nfreq[i] / ANS_M) * freq[i] / total;
+  return bits;
+}
+
+template <typename E>
+void ans_encode_cpu(
+    E* in, size_t const len, u4* freq, int const bklen, int const sublen,
+    u1* out, size_t* outlen, float* time)
+{
+  using namespace psz;
+  using Header = ans_header;
+
+  if (bklen > 65536)
+    throw std::runtime_error("[psz::error::ans] bklen must be <= 65536.");
+
+  auto a = hires::now();
+
+  std::vector<u4> nfreq, cum(bklen + 1, 0);
+  ans_normalize(freq, bklen, nfreq);
+  for (auto i = 0; i < bklen; i++) cum[i + 1] = cum[i] + nfreq[i];
+
+  auto pardeg = (len - 1) / sublen + 1;
+  std::vector<std::vector<u2>> chunk(pardeg);
+  std::atomic<bool> bad_symbol{false};
+
+  psz::cpu::parallel_for(pardeg, [&](size_t c) {
+    auto start = c * sublen;
+    auto n = std::min<size_t>(sublen, len - start);
+    ans_encode_chunk<E>(
+        in + start, n, nfreq.data(), cum.data(), bklen, chunk[c], bad_symbol);
+  });
+
+  if (bad_symbol)
+    throw std::runtime_error(
+        "[psz::error::ans] symbol out of the histogram support.");
+
+  Header header;
+  memset(&header, 0, sizeof(Header));
+  header.self_bytes = sizeof(Header);
+  header.prob_bits = ANS_PROB_BITS;
+  header.lanes = ANS_LANES;
+  header.bklen = bklen;
+  header.sublen = sublen;
+  header.pardeg = pardeg;
+  header.original_len = len;
+
+  std::vector<u4> par_entry(pardeg + 1, 0);
+  for (size_t c = 0; c < pardeg; c++)
+    par_entry[c + 1] = par_entry[c] + chunk[c].size() * sizeof(u2);
+
+  u4 nbyte[Header::END];
+  nbyte[Header::HEADER] = pad8(sizeof(Header));
+  nbyte[Header::FREQ] = pad8(sizeof(u2) * bklen);
+  nbyte[Header::PAR_ENTRY] = pad8(sizeof(u4) * (pardeg + 1));
+  nbyte[Header::BITSTREAM] = par_entry[pardeg];
+
+  header.entry[0] = 0;
+  for (auto i = 1; i < Header::END + 1; i++)
+    header.entry[i] = header.entry[i - 1] + nbyte[i - 1];
+
+  memcpy(out, &header, sizeof(Header));
+
+  auto o_freq = (u2*)(out + header.entry[Header::FREQ]);
+  for (auto i = 0; i < bklen; i++) o_freq[i] = nfreq[i];
+  memcpy(
+      out + header.entry[Header::PAR_ENTRY], par_entry.data(),
+      sizeof(u4) * (pardeg + 1));
+
+  auto o_bitstream = out + header.entry[Header::BITSTREAM];
+  psz::cpu::parallel_for(pardeg, [&](size_t c) {
+    memcpy(
+        o_bitstream + par_entry[c], chunk[c].data(),
+        chunk[c].size() * sizeof(u2));
+  });
+
+  *outlen = header.compressed_size();
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename E>
+void ans_decode_cpu(u1* in, E* out, float* time)
+{
+  using namespace psz;
+  using Header = ans_header;
+
+  Header header;
+  memcpy(&header, in, sizeof(Header));
+
+  if (header.prob_bits != ANS_PROB_BITS or header.lanes != ANS_LANES)
+    throw std::runtime_error("[psz::error::ans] incompatible rANS stream.");
+
+  auto a = hires::now();
+
+  auto bklen = header.bklen;
+  auto i_freq = (u2*)(in + header.entry[Header::FREQ]);
+  auto par_entry = (u4*)(in + header.entry[Header::PAR_ENTRY]);
+  auto i_bitstream = in + header.entry[Header::BITSTREAM];
+
+  // slot -> (symbol, freq | bias << 16); the latter for one gather per lane
+  std::vector<E> slot_sym(ANS_M);
+  std::vector<u4> slot_fb(ANS_M);
+  for (u4 s = 0, slot = 0; s < bklen; s++) {
+    for (u4 k = 0; k < i_freq[s]; k++, slot++) {
+      slot_sym[slot] = s;
+      slot_fb[slot] = (u4)i_freq[s] | (k << 16);
+    }
+  }
+
+  auto len = header.original_len;
+  auto sublen = header.sublen;
+
+  psz::cpu::parallel_for(header.pardeg, [&](size_t c) {
+    auto start = c * sublen;
+    auto n = std::min<size_t>(sublen, len - start);
+    ans_decode_chunk<E>(
+        (u2*)(i_bitstream + par_entry[c]), n, slot_sym.data(), slot_fb.data(),
+        out + start);
+  });
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+#define SPECIALIZE(E)                                                     \
+  template <>                                                             \
+  void psz::ans_encode<CPU, E>(                                           \
+      E * in, size_t const len, u4* freq, int const bklen,                \
+      int const sublen, u1* out, size_t* outlen, float* time)             \
+  {                                                                       \
+    ans_encode_cpu<E>(in, len, freq, bklen, sublen, out, outlen, time);   \
+  }                                                                       \
+                                                                          \
+  template <>                                                             \
+  void psz::ans_decode<CPU, E>(u1 * in, E * out, float* time)             \
+  {                                                                       \
+    ans_decode_cpu<E>(in, out, time);                                     \
+  }
+
+SPECIALIZE(u1)
+SPECIALIZE(u2)
+SPECIALIZE(u4)
+
+#undef SPECIALIZE
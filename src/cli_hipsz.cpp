@@ -24,6 +24,12 @@ int main(int argc, char** argv)
         GpuDiagnostics::GetDeviceProperty();
     }
 
-    cusz::CLI<float> cusz_cli;
-    cusz_cli.dispatch(ctx);
+    if (cusz::cli_dtype(ctx) == F8) {
+        cusz::CLI<double> cusz_cli;
+        cusz_cli.dispatch(ctx);
+    }
+    else {
+        cusz::CLI<float> cusz_cli;
+        cusz_cli.dispatch(ctx);
+    }
 }
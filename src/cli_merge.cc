@@ -0,0 +1,87 @@
+/**
+ * @file cli_merge.cc
+ * @author Jiannan Tian
+ * @brief Merge the subdomain archives of ranks into one indexed archive, and
+ * list or extract its subdomains.
+ * @version 0.4
+ * @date 2023-10-01
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "cusz.h"
+
+static void usage()
+{
+  printf(
+      "usage:\n"
+      "  cusz-merge -o [merged] [subdomain archive]...\n"
+      "      one archive, indexed by subdomain, from those of all ranks\n"
+      "  cusz-merge -l [merged]\n"
+      "      list the subdomains\n"
+      "  cusz-merge -x [k] [merged] -o [archive]\n"
+      "      extract subdomain k, as a .cusza of its own\n");
+}
+
+int main(int argc, char** argv)
+{
+  char const* out = nullptr;
+  char const* list = nullptr;
+  int extract = -1;
+  std::vector<char const*> in;
+
+  for (auto i = 1; i < argc; i++) {
+    if (not strcmp(argv[i], "-o") and i + 1 < argc)
+      out = argv[++i];
+    else if (not strcmp(argv[i], "-l") and i + 1 < argc)
+      list = argv[++i];
+    else if (not strcmp(argv[i], "-x") and i + 1 < argc)
+      extract = atoi(argv[++i]);
+    else if (argv[i][0] == '-') {
+      usage();
+      return 1;
+    }
+    else
+      in.push_back(argv[i]);
+  }
+
+  if (list) {
+    int n;
+    if (psz_merged_index(list, nullptr, &n) != CUSZ_SUCCESS or n == 0)
+      return 1;
+    std::vector<psz_subdomain> subs(n);
+    psz_merged_index(list, subs.data(), &n);
+    printf(
+        "%d subdomains of (%u, %u, %u)\n", n, subs[0].global[0],
+        subs[0].global[1], subs[0].global[2]);
+    for (auto& s : subs)
+      printf(
+          "  rank %4d: offset (%u, %u, %u), len (%u, %u, %u), %zu bytes\n",
+          s.rank, s.offset[0], s.offset[1], s.offset[2], s.len[0], s.len[1],
+          s.len[2], s.bytes);
+    return 0;
+  }
+
+  if (extract >= 0 and in.size() == 1 and out) {
+    size_t bytes;
+    if (psz_merged_read(in[0], extract, nullptr, &bytes) != CUSZ_SUCCESS)
+      return 1;
+    std::vector<char> archive(bytes);
+    psz_merged_read(in[0], extract, archive.data(), &bytes);
+    std::ofstream(out, std::ios::binary).write(archive.data(), bytes);
+    return 0;
+  }
+
+  if (out and not in.empty() and extract < 0)
+    return psz_merge(out, in.data(), in.size()) == CUSZ_SUCCESS ? 0 : 1;
+
+  usage();
+  return 1;
+}
@@ -56,9 +56,39 @@ int CompressorHelper::autotune_coarse_parhf(cusz_context* ctx)
 
 }  // namespace cusz
 
-using Ff4 = cusz::TEHM<float>;
-using CFf4 = cusz::Compressor<Ff4>;
+#define INIT(TEHM)                                                 \
+  template class cusz::Compressor<TEHM>;                           \
+  template cusz::Compressor<TEHM>* cusz::Compressor<TEHM>::init(   \
+      cusz_context* config, bool debug);                           \
+  template cusz::Compressor<TEHM>* cusz::Compressor<TEHM>::init(   \
+      cusz_header* config, bool debug);
 
-template class cusz::Compressor<Ff4>;
-template CFf4* CFf4::init<cusz_context>(cusz_context* config, bool debug);
-template CFf4* CFf4::init<cusz_header>(cusz_header* config, bool debug);
+using Ff4 = cusz::TEHM<f4>;
+using Ff8 = cusz::TEHM<f8, false>;
+// half-precision input, with Lorenzo in FP32
+using Ff2 = cusz::TEHM<f2>;
+using Fbf2 = cusz::TEHM<bf2>;
+// integer input, with exact integer Lorenzo
+using Fu1 = cusz::TEHM<u1>;
+using Fu2 = cusz::TEHM<u2>;
+using Fu4 = cusz::TEHM<u4>;
+using Fu8 = cusz::TEHM<u8>;
+using Fi1 = cusz::TEHM<i1>;
+using Fi2 = cusz::TEHM<i2>;
+using Fi4 = cusz::TEHM<i4>;
+using Fi8 = cusz::TEHM<i8>;
+
+INIT(Ff4)
+INIT(Ff8)
+INIT(Ff2)
+INIT(Fbf2)
+INIT(Fu1)
+INIT(Fu2)
+INIT(Fu4)
+INIT(Fu8)
+INIT(Fi1)
+INIT(Fi2)
+INIT(Fi4)
+INIT(Fi8)
+
+#undef INIT
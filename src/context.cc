@@ -46,6 +46,8 @@ void pszctx_set_report(pszctx* ctx, const char* in_str)
         ctx->report_cr_est = kv.second;
       else if (kv.first == "time")
         ctx->report_time = kv.second;
+      else if (kv.first == "spatial")
+        ctx->report_spatial = kv.second;
     }
     else {
       if (o == "cr")
@@ -54,6 +56,8 @@ void pszctx_set_report(pszctx* ctx, const char* in_str)
         ctx->report_cr_est = true;
       else if (o == "time")
         ctx->report_time = true;
+      else if (o == "spatial")
+        ctx->report_spatial = true;
     }
   }
 }
@@ -100,7 +104,7 @@ void pszctx_parse_control_string(
     }
     else if (optmatch({"mode"})) {
       psz_utils::check_cuszmode(v);
-      ctx->mode = v == "r2r" ? Rel : Abs;
+      ctx->mode = v == "r2r" ? Rel : v == "pwr" ? PwRel : Abs;
     }
     else if (optmatch({"len", "xyz", "dim3"})) {
       pszctx_parse_length(ctx, v.c_str());
@@ -130,13 +134,45 @@ void pszctx_parse_control_string(
       ctx->vle_sublen = psz_helper::str2int(v);
       ctx->use_autotune_hf = false;
     }
+    else if (optmatch({"codec"})) {
+      if (v == "rans" or v == "ans") {
+        ctx->codec1_type = Rans;
+      }
+      else if (v == "huffman" or v == "hf") {
+        ctx->codec1_type = Huffman;
+      }
+      else {
+        printf(
+            "[psz::warning::parser] "
+            "\"%s\" is not a supported codec; "
+            "fallback to \"huffman\".",
+            v.c_str());
+        ctx->codec1_type = Huffman;
+      }
+    }
+    else if (optmatch({"layers"})) {
+      ctx->prog_layers = psz_helper::str2int(v);
+      if (ctx->prog_layers < 1)
+        throw std::runtime_error("`layers` must be a positive integer.");
+    }
+    else if (optmatch({"layerratio"})) {
+      ctx->prog_ratio = psz_helper::str2fp(v);
+      if (not(ctx->prog_ratio > 1))
+        throw std::runtime_error("`layerratio` must be greater than 1.");
+    }
+    else if (optmatch({"rle", "runlength"})) {
+      ctx->use_rle = is_enabled(v) or v == "force";
+      ctx->use_rle_force = v == "force";
+    }
     else if (optmatch({"predictor"})) {
       strcpy(ctx->dbgstr_pred, v.c_str());
 
+      ctx->use_auto_pred = v == "auto";
+
       if (v == "spline" or v == "spline3") {
         ctx->pred_type = pszpredictor_type::Spline;
       }
-      else if (v == "lorenzo") {
+      else if (v == "lorenzo" or v == "auto") {
         ctx->pred_type = pszpredictor_type::Lorenzo;
       }
       else {
@@ -218,7 +254,7 @@ void pszctx_parse_argv(pszctx* ctx, int const argc, char** const argv)
       else if (optmatch({"-m", "--mode"})) {
         check_next();
         auto _ = std::string(argv[++i]);
-        ctx->mode = _ == "r2r" ? Rel : Abs;
+        ctx->mode = _ == "r2r" ? Rel : _ == "pwr" ? PwRel : Abs;
         if (ctx->mode == Rel) ctx->prep_prescan = true;
       }
       else if (optmatch({"-e", "--eb", "--error-bound"})) {
@@ -231,10 +267,12 @@ void pszctx_parse_argv(pszctx* ctx, int const argc, char** const argv)
         auto v = std::string(argv[++i]);
         strcpy(ctx->dbgstr_pred, v.c_str());
 
+        ctx->use_auto_pred = v == "auto";
+
         if (v == "spline" or v == "spline3") {
           ctx->pred_type = pszpredictor_type::Spline;
         }
-        else if (v == "lorenzo") {
+        else if (v == "lorenzo" or v == "auto") {
           ctx->pred_type = pszpredictor_type::Lorenzo;
         }
         else {
@@ -276,13 +314,55 @@ void pszctx_parse_argv(pszctx* ctx, int const argc, char** const argv)
       else if (optmatch({"-r", "--dryrun"})) {
         ctx->task_dryrun = true;
       }
+      else if (optmatch({"--target"})) {
+        check_next();
+        std::string target(argv[++i]);
+        auto eq = target.find('=');
+        auto k = target.substr(0, eq);
+        if (eq == std::string::npos or (k != "cr" and k != "psnr"))
+          throw std::runtime_error("`--target` takes cr=[num] or psnr=[num].");
+        auto v = psz_helper::str2fp(target.substr(eq + 1));
+        if (not(v > 0))
+          throw std::runtime_error("`--target` must be positive.");
+        (k == "cr" ? ctx->target_cr : ctx->target_psnr) = v;
+        (k == "cr" ? ctx->target_psnr : ctx->target_cr) = 0;
+      }
+      else if (optmatch({"--dryrun-cpu"})) {
+        ctx->task_dryrun = true;
+        ctx->use_cpu_dryrun = true;
+      }
+      else if (optmatch({"--cpu-pin"})) {
+        check_next();
+        std::string pin(argv[++i]);
+        if (pin == "none")
+          ctx->cpu_pin = PinNone;
+        else if (pin == "compact")
+          ctx->cpu_pin = PinCompact;
+        else if (pin == "scatter")
+          ctx->cpu_pin = PinScatter;
+        else
+          throw std::runtime_error(
+              "`--cpu-pin` takes none, compact or scatter.");
+      }
+      else if (optmatch({"--numa-touch"})) {
+        ctx->use_numa_touch = true;
+      }
       else if (optmatch({"-P", "--pre", "--preprocess"})) {
         check_next();
         std::string pre(argv[++i]);
         if (pre.find("binning") != std::string::npos) {
           ctx->prep_binning = true;
+          if (pre.find("2x1") != std::string::npos)
+            ctx->binning = Binning2x1;
+          else if (pre.find("1x2") != std::string::npos)
+            ctx->binning = Binning1x2;
+          else
+            ctx->binning = Binning2x2;
         }
       }
+      else if (optmatch({"--preview"})) {
+        ctx->use_preview = true;
+      }
       else if (optmatch({"-V", "--verbose"})) {
         ctx->verbose = true;
       }
@@ -421,14 +501,19 @@ void pszctx_validate(pszctx* ctx)
       to_abort = true;
     }
   }
+  // with `--origin` alone, compare the input to it
   if (not ctx->task_construct and not ctx->task_reconstruct and
-      not ctx->task_dryrun) {
+      not ctx->task_dryrun and ctx->original_file[0] != '\0')
+    ctx->task_compare = true;
+
+  if (not ctx->task_construct and not ctx->task_reconstruct and
+      not ctx->task_dryrun and not ctx->task_compare) {
     cerr << LOG_ERR << "select compress (-z), decompress (-x) or dryrun (-r)"
          << endl;
     to_abort = true;
   }
   if (false == psz_utils::check_dtype(ctx->dtype)) {
-    if (ctx->task_construct or ctx->task_dryrun) {
+    if (ctx->task_construct or ctx->task_dryrun or ctx->task_compare) {
       std::cout << ctx->dtype << endl;
       cerr << LOG_ERR << "must specify data type" << endl;
       to_abort = true;
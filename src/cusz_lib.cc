@@ -10,14 +10,24 @@
  *
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "busyheader.hh"
 #include "compressor.hh"
 #include "context.h"
 #include "cusz.h"
 #include "cusz/type.h"
 #include "hf/hf.hh"
+#include "kernel/estimate.hh"
 #include "port.hh"
+#include "stat/compare_cpu.hh"
 #include "tehm.hh"
+#include "utils/async_cpu.hh"
+#include "utils/err.hh"
+#include "utils/par_cpu.hh"
 
 pszpredictor pszdefault_predictor() { return {Lorenzo}; }
 pszquantizer pszdefault_quantizer() { return {512}; }
@@ -29,23 +39,54 @@ pszframe* pszdefault_framework()
       20};
 }
 
+namespace {
+
+// Call `f` with the compressor of the concrete input type.
+template <typename F>
+void psz_dispatch(pszcompressor* comp, char const* func, F&& f)
+{
+  auto c = comp->compressor;
+
+  // clang-format off
+  switch (comp->type) {
+    case F4: f((cusz::CompressorF4*)c); break;
+    case F8: f((cusz::CompressorF8*)c); break;
+    case F2: f((cusz::CompressorF2*)c); break;
+    case BF2: f((cusz::CompressorBF2*)c); break;
+    case U1: f((cusz::CompressorU1*)c); break;
+    case U2: f((cusz::CompressorU2*)c); break;
+    case U4: f((cusz::CompressorU4*)c); break;
+    case U8: f((cusz::CompressorU8*)c); break;
+    case I1: f((cusz::CompressorI1*)c); break;
+    case I2: f((cusz::CompressorI2*)c); break;
+    case I4: f((cusz::CompressorI4*)c); break;
+    case I8: f((cusz::CompressorI8*)c); break;
+    default:
+      throw std::runtime_error(std::string(func) + ": Type is not supported.");
+  }
+  // clang-format on
+}
+
+}  // namespace
+
 pszcompressor* psz_create(pszframe* _framework, pszdtype _type)
 {
   auto comp = new pszcompressor{.framework = _framework, .type = _type};
 
-  if (comp->type == F4) {
-    using Compressor = cusz::CompressorF4;
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) {
+    using Compressor = typename std::remove_pointer<decltype(cor)>::type;
     comp->compressor = new Compressor();
-  }
-  else {
-    throw std::runtime_error("Type is not supported.");
-  }
+  });
 
   return comp;
 }
 
 pszerror psz_release(pszcompressor* comp)
 {
+  if (comp->compressor)
+    psz_dispatch(comp, __FUNCTION__, [](auto* cor) { delete cor; });
+  delete comp->ctx;
+  delete comp->header;
   delete comp;
   return CUSZ_SUCCESS;
 }
@@ -54,9 +95,14 @@ pszerror psz_release(pszcompressor* comp)
 pszerror psz_compress_init(
     pszcompressor* comp, pszlen const uncomp_len, pszctx* ctx)
 {
-  comp->ctx = ctx;
-  // comp->ctx = new pszctx;
+  // a copy of its own, for the caller may change or reuse `ctx`
+  delete comp->ctx;
+  comp->ctx = new pszctx(*ctx);
   pszctx_set_len(comp->ctx, uncomp_len);
+
+  // of this compressor, for its host workers and host buffers
+  comp->cpu_pin = ctx->cpu_pin, comp->use_numa_touch = ctx->use_numa_touch;
+  psz::cpu::placement_scope place(comp->cpu_pin, comp->use_numa_touch);
   // comp->ctx->eb = config->eb;
   // comp->ctx->mode = config->mode;
   // comp->ctx->pred_type = config->pred_type;
@@ -65,14 +111,7 @@ pszerror psz_compress_init(
   // Be cautious of autotuning! The default value of pardeg is not robust.
   cusz::CompressorHelper::autotune_coarse_parhf(comp->ctx);
 
-  if (comp->type == F4) {
-    auto cor = (cusz::CompressorF4*)(comp->compressor);
-    cor->init(comp->ctx);
-  }
-  else {
-    throw std::runtime_error(
-        std::string(__FUNCTION__) + ": Type is not supported.");
-  }
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) { cor->init(comp->ctx); });
 
   return CUSZ_SUCCESS;
 }
@@ -82,33 +121,49 @@ pszerror psz_compress(
     ptr_pszout compressed, size_t* comp_bytes, pszheader* header, void* record,
     void* stream)
 {
-  if (comp->type == F4) {
-    auto cor = (cusz::CompressorF4*)(comp->compressor);
+  psz::cpu::placement_scope place(comp->cpu_pin, comp->use_numa_touch);
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) {
+    using T = typename std::remove_pointer<decltype(cor)>::type::T;
 
     cor->compress(
-        comp->ctx, (f4*)(in), *compressed, *comp_bytes, (GpuStreamT)stream);
+        comp->ctx, (T*)(in), *compressed, *comp_bytes, (GpuStreamT)stream);
     cor->export_header(*header);
     cor->export_timerecord((cusz::TimeRecord*)record);
-  }
-  else {
-    throw std::runtime_error(
-        std::string(__FUNCTION__) + ": Type is not supported.");
-  }
+  });
+
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_compress_histogram(
+    pszcompressor* comp, void* in, pszlen const uncomp_len, uint32_t* freq,
+    void* stream)
+{
+  psz::cpu::placement_scope place(comp->cpu_pin, comp->use_numa_touch);
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) {
+    using T = typename std::remove_pointer<decltype(cor)>::type::T;
+
+    cor->export_histogram(comp->ctx, (T*)(in), freq, (GpuStreamT)stream);
+  });
+
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_use_book(pszcompressor* comp, psz_book const* book)
+{
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) { cor->use_book(book); });
 
   return CUSZ_SUCCESS;
 }
 
 pszerror psz_decompress_init(pszcompressor* comp, pszheader* header)
 {
-  comp->header = header;
-  if (comp->type == F4) {
-    auto cor = (cusz::CompressorF4*)(comp->compressor);
-    cor->init(header);
-  }
-  else {
-    throw std::runtime_error(
-        std::string(__FUNCTION__) + ": Type is not supported.");
-  }
+  if (not header->known()) return CUSZ_FAIL_UNSUPPORTED_FORMAT;
+
+  delete comp->header;
+  comp->header = new pszheader(*header);
+  psz::cpu::placement_scope place(comp->cpu_pin, comp->use_numa_touch);
+  psz_dispatch(
+      comp, __FUNCTION__, [&](auto* cor) { cor->init(comp->header); });
 
   return CUSZ_SUCCESS;
 }
@@ -117,17 +172,298 @@ pszerror psz_decompress(
     pszcompressor* comp, pszout compressed, size_t const comp_len,
     void* decompressed, pszlen const decomp_len, void* record, void* stream)
 {
-  if (comp->type == F4) {
-    auto cor = (cusz::CompressorF4*)(comp->compressor);
+  psz::cpu::placement_scope place(comp->cpu_pin, comp->use_numa_touch);
+  psz_dispatch(comp, __FUNCTION__, [&](auto* cor) {
+    using T = typename std::remove_pointer<decltype(cor)>::type::T;
 
     cor->decompress(
-        comp->header, compressed, (f4*)(decompressed), (GpuStreamT)stream);
+        comp->header, compressed, comp_len, (T*)(decompressed),
+        (GpuStreamT)stream);
     cor->export_timerecord((cusz::TimeRecord*)record);
-  }
-  else {
+  });
+
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_estimate(
+    void* data, pszdtype const type, pszlen const len, double const eb,
+    int const radius, pszestimate* lorenzo, pszestimate* spline, float* time)
+{
+  auto len3 = psz_dim3{(u4)len.x, (u4)len.y, (u4)len.z};
+
+  if (type == F4)
+    psz::estimate<f4>((f4*)data, len3, eb, radius, lorenzo, spline, time);
+  else if (type == F8)
+    psz::estimate<f8>((f8*)data, len3, eb, radius, lorenzo, spline, time);
+  else
+    return CUSZ_FAIL_UNSUPPORTED_DATATYPE;
+
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_select_predictor(pszctx* ctx, void* data)
+{
+  if (not ctx->use_auto_pred) return CUSZ_SUCCESS;
+
+  ctx->pred_type = Lorenzo;
+
+#ifdef PSZ_USE_CUDA
+  // the log-mapped field is not what is predicted in point-wise relative mode
+  if (ctx->mode == PwRel) return CUSZ_SUCCESS;
+
+  auto len3 = psz_dim3{ctx->x, ctx->y, ctx->z};
+  // progressive: the base layer is what the predictor sees
+  auto eb = ctx->eb;
+  if (ctx->prog_layers > 1)
+    eb *= std::pow(ctx->prog_ratio, ctx->prog_layers - 1);
+
+  auto select = [&](auto* in) {
+    using T = typename std::remove_pointer<decltype(in)>::type;
+    // relative: to the value range, as the CLI and the batch scale it
+    if (ctx->mode == Rel) {
+      T res[4];
+      psz::cppstd_extrema<T>(in, (size_t)len3.x * len3.y * len3.z, res);
+      eb *= res[3];
+    }
+    ctx->pred_type = psz::select_predictor<T>(in, len3, eb, ctx->radius);
+  };
+  if (ctx->dtype == F4)
+    select((f4*)data);
+  else if (ctx->dtype == F8)
+    select((f8*)data);
+#endif
+
+  return CUSZ_SUCCESS;
+}
+
+struct psz_batch {
+  struct worker {
+    pszcompressor* comp{nullptr};
+    GpuStreamT stream;
+  };
+
+  pszframe* framework;
+  pszdtype type;
+  pszctx ctx;
+  std::vector<worker> workers;
+
+  // A thread for each worker, alive from create to release; a call to
+  // `psz_batch_compress` is a round that every thread joins.
+  std::vector<std::thread> threads;
+  std::mutex m;
+  std::condition_variable cv, cv_done;
+  psz_field* fields{nullptr};
+  size_t nfield{0};
+  std::atomic<size_t> next{0};
+  size_t round{0};
+  size_t nbusy{0};
+  bool stop{false};
+};
+
+namespace {
+
+void psz_batch_drop(pszcompressor* comp)
+{
+  if (comp) psz_release(comp);
+}
+
+// The range of a field on device, for the relative mode.
+double psz_batch_range(pszdtype type, void* data, size_t len)
+{
+  double max, min, rng;
+  if (type == F4)
+    pszmem_cxx<f4>(len, 1, 1, "batch")
+        .dptr((f4*)data)
+        ->extrema_scan(max, min, rng);
+  else if (type == F8)
+    pszmem_cxx<f8>(len, 1, 1, "batch")
+        .dptr((f8*)data)
+        ->extrema_scan(max, min, rng);
+  else
     throw std::runtime_error(
-        std::string(__FUNCTION__) + ": Type is not supported.");
+        "[psz::error::batch] The relative mode needs FP32 or FP64.");
+  return rng;
+}
+
+void psz_batch_one(psz_batch* batch, psz_batch::worker& w, psz_field& f)
+{
+  f.archive = nullptr, f.archive_bytes = 0;
+
+  auto same_len = [](pszctx const& c, pszlen l) {
+    return c.x == l.x and c.y == l.y and c.z == l.z;
+  };
+  if (not w.comp or not same_len(*w.comp->ctx, f.len)) {
+    psz_batch_drop(w.comp);
+    w.comp = psz_create(batch->framework, batch->type);
+    psz_compress_init(w.comp, f.len, &batch->ctx);
   }
 
+  // the compressor has its own copy of the context
+  auto& eb = w.comp->ctx->eb;
+  eb = f.eb;
+  if (batch->ctx.mode == Rel) {
+    eb *= psz_batch_range(
+        batch->type, f.data, (size_t)f.len.x * f.len.y * f.len.z);
+  }
+
+  uint8_t* d_archive;
+  pszheader header;
+  cusz::TimeRecord record;
+  psz_compress(
+      w.comp, f.data, f.len, &d_archive, &f.archive_bytes, &header,
+      (void*)&record, w.stream);
+
+  // the next field overwrites the device buffer
+  f.archive = (u1*)malloc(f.archive_bytes);
+  if (not f.archive)
+    throw std::runtime_error("[psz::error::batch] Out of host memory.");
+  CHECK_GPU(GpuMemcpyAsync(
+      f.archive, d_archive, f.archive_bytes, GpuMemcpyD2H, w.stream));
+  CHECK_GPU(GpuStreamSync(w.stream));
+}
+
+// Fields are handed out one at a time; each worker keeps its compressor.
+void psz_batch_run(psz_batch* batch, psz_batch::worker& w)
+{
+  auto& fields = batch->fields;
+  for (size_t i = batch->next++; i < batch->nfield; i = batch->next++) {
+    try {
+      psz_batch_one(batch, w, fields[i]);
+    }
+    catch (std::exception const& e) {
+      fprintf(stderr, "[psz::error::batch] field %zu: %s\n", i, e.what());
+      free(fields[i].archive), fields[i].archive = nullptr;
+      fields[i].archive_bytes = 0;
+      fields[i].status = CUSZ_FAIL_UNSUPPORTED_PIPELINE;
+      // not to reuse a compressor in an unknown state
+      psz_batch_drop(w.comp), w.comp = nullptr;
+    }
+  }
+}
+
+// The workers share the host threads: the host kernels of each field run on
+// its share, rather than each on all of them, placed as the context says.
+void psz_batch_loop(
+    psz_batch* batch, psz_batch::worker& w, int device, int budget)
+{
+  CHECK_GPU(GpuSetDevice(device));
+  psz::cpu::budget_scope scope(budget);
+  psz::cpu::placement_scope place(
+      batch->ctx.cpu_pin, batch->ctx.use_numa_touch);
+
+  size_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lk(batch->m);
+      batch->cv.wait(lk, [&] { return batch->stop or batch->round != seen; });
+      if (batch->stop) return;
+      seen = batch->round;
+    }
+
+    psz_batch_run(batch, w);
+
+    std::lock_guard<std::mutex> lk(batch->m);
+    if (--batch->nbusy == 0) batch->cv_done.notify_all();
+  }
+}
+
+}  // namespace
+
+psz_batch* psz_batch_create(
+    pszframe* framework, pszdtype const type, pszctx* ctx, int nworker)
+{
+  if (nworker <= 0) nworker = 4;
+
+  auto batch = new psz_batch;
+  batch->framework = framework;
+  batch->type = type;
+  batch->ctx = *ctx;
+  batch->workers.resize(nworker);
+  for (auto& w : batch->workers) CHECK_GPU(GpuStreamCreate(&w.stream));
+
+  // on the device of the caller
+  int device;
+  CHECK_GPU(GpuGetDevice(&device));
+  auto budget = std::max(1, psz::cpu::nthread() / nworker);
+  for (auto& w : batch->workers)
+    batch->threads.emplace_back(
+        psz_batch_loop, batch, std::ref(w), device, budget);
+
+  return batch;
+}
+
+pszerror psz_batch_compress(
+    psz_batch* batch, psz_field* fields, size_t const nfield)
+{
+  for (size_t i = 0; i < nfield; i++) fields[i].status = CUSZ_SUCCESS;
+
+  {
+    std::lock_guard<std::mutex> lk(batch->m);
+    batch->fields = fields, batch->nfield = nfield, batch->next = 0;
+    batch->nbusy = batch->threads.size();
+    batch->round++;
+  }
+  batch->cv.notify_all();
+  {
+    std::unique_lock<std::mutex> lk(batch->m);
+    batch->cv_done.wait(lk, [&] { return batch->nbusy == 0; });
+  }
+
+  for (size_t i = 0; i < nfield; i++)
+    if (fields[i].status != CUSZ_SUCCESS) return fields[i].status;
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_batch_release(psz_batch* batch)
+{
+  {
+    std::lock_guard<std::mutex> lk(batch->m);
+    batch->stop = true;
+  }
+  batch->cv.notify_all();
+  for (auto& t : batch->threads) t.join();
+
+  for (auto& w : batch->workers) {
+    psz_batch_drop(w.comp);
+    GpuStreamDestroy(w.stream);
+  }
+  delete batch;
   return CUSZ_SUCCESS;
 }
+
+psz_task* psz_compress_async(
+    pszcompressor* comp, void* in, pszlen const uncomp_len,
+    ptr_pszout compressed, size_t* comp_bytes, pszheader* header, void* record,
+    void* stream, psz_callback callback, void* user)
+{
+  return psz::cpu::executor::get().submit(
+      [=] {
+        return psz_compress(
+            comp, in, uncomp_len, compressed, comp_bytes, header, record,
+            stream);
+      },
+      callback, user);
+}
+
+psz_task* psz_decompress_async(
+    pszcompressor* comp, pszout compressed, size_t const comp_len,
+    void* decompressed, pszlen const decomp_len, void* record, void* stream,
+    psz_callback callback, void* user)
+{
+  return psz::cpu::executor::get().submit(
+      [=] {
+        return psz_decompress(
+            comp, compressed, comp_len, decompressed, decomp_len, record,
+            stream);
+      },
+      callback, user);
+}
+
+int psz_task_poll(psz_task* task) { return psz::cpu::task_poll(task); }
+
+pszerror psz_task_wait(psz_task* task) { return psz::cpu::task_wait(task); }
+
+pszerror psz_task_release(psz_task* task)
+{
+  return psz::cpu::task_release(task);
+}
@@ -32,32 +32,6 @@ using std::cout;
 using std::endl;
 namespace cg = cooperative_groups;
 
-// GenerateCL Locals
-__device__ int iNodesFront = 0;
-__device__ int iNodesRear  = 0;
-__device__ int lNodesCur   = 0;
-
-__device__ int iNodesSize = 0;
-__device__ int curLeavesNum;
-
-__device__ int minFreq;
-
-__device__ int tempLength;
-
-__device__ int mergeFront;
-__device__ int mergeRear;
-
-__device__ int lNodesIndex;
-
-// GenerateCW Locals
-__device__ int CCL;
-__device__ int CDPI;
-__device__ int newCDPI;
-
-// Profiling
-__device__ long long int s[10];
-__device__ long long int st[10];
-
 // Mathematically correct mod
 #define MOD(a, b) ((((a) % (b)) + (b)) % (b))
 
@@ -71,10 +45,21 @@ __global__ void par_huffman::GPU_GenerateCL(
     F* iNodesFreq,  int* iNodesLeader,
     F* tempFreq,    int* tempIsLeaf,    int* tempIndex,
     F* copyFreq,    int* copyIsLeaf,    int* copyIndex,
-    uint32_t* diagonal_path_intersections, int mblocks, int mthreads)
+    uint32_t* diagonal_path_intersections, int mblocks, int mthreads,
+    bookg_state* st)
 {
     // clang-format on
 
+    int& iNodesFront  = st->iNodesFront;
+    int& iNodesRear   = st->iNodesRear;
+    int& lNodesCur    = st->lNodesCur;
+    int& iNodesSize   = st->iNodesSize;
+    int& curLeavesNum = st->curLeavesNum;
+    int& minFreq      = st->minFreq;
+    int& tempLength   = st->tempLength;
+    int& mergeFront   = st->mergeFront;
+    int& mergeRear    = st->mergeRear;
+
     extern __shared__ int32_t shmem[];
     // Shared variables
     int32_t& x_top     = shmem[0];
@@ -310,8 +295,12 @@ __global__ void par_huffman::GPU_GenerateCL(
 
 // Parallelized with atomic writes, but could replace with Jiannan's similar code
 template <typename F, typename H>
-__global__ void par_huffman::GPU_GenerateCW(F* CL, H* CW, H* first, H* entry, int size)
+__global__ void par_huffman::GPU_GenerateCW(F* CL, H* CW, H* first, H* entry, int size, bookg_state* st)
 {
+    int& CCL     = st->CCL;
+    int& CDPI    = st->CDPI;
+    int& newCDPI = st->newCDPI;
+
     unsigned int       thread       = (blockIdx.x * blockDim.x) + threadIdx.x;
     const unsigned int i            = thread;  // Porting convenience
     auto               current_grid = cg::this_grid();
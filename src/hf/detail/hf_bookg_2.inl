@@ -98,7 +98,7 @@ void psz::hf_buildbook_cu(
 
     // Sort Qcodes by frequency
     int nblocks = (dict_size / 1024) + 1;
-    hf_detail::GPU_FillArraySequence<T><<<nblocks, 1024>>>(_d_qcode, (unsigned int)dict_size);
+    hf_detail::GPU_FillArraySequence<T><<<nblocks, 1024, 0, (cudaStream_t)stream>>>(_d_qcode, (unsigned int)dict_size);
     cudaStreamSynchronize((cudaStream_t)stream);
 
     lambda_sort_by_freq(freq, dict_size, _d_qcode);
@@ -108,7 +108,7 @@ void psz::hf_buildbook_cu(
     unsigned int  first_nonzero_index = dict_size;
     cudaMalloc(&d_first_nonzero_index, sizeof(unsigned int));
     cudaMemcpy(d_first_nonzero_index, &first_nonzero_index, sizeof(unsigned int), cudaMemcpyHostToDevice);
-    hf_detail::GPU_GetFirstNonzeroIndex<unsigned int><<<nblocks, 1024>>>(freq, dict_size, d_first_nonzero_index);
+    hf_detail::GPU_GetFirstNonzeroIndex<unsigned int><<<nblocks, 1024, 0, (cudaStream_t)stream>>>(freq, dict_size, d_first_nonzero_index);
     cudaStreamSynchronize((cudaStream_t)stream);
     cudaMemcpy(&first_nonzero_index, d_first_nonzero_index, sizeof(unsigned int), cudaMemcpyDeviceToHost);
     cudaFree(d_first_nonzero_index);
@@ -169,6 +169,11 @@ void psz::hf_buildbook_cu(
     uint32_t* diagonal_path_intersections;
     cudaMalloc(&diagonal_path_intersections, (2 * (mblocks + 1)) * sizeof(uint32_t));
 
+    // per build, not file-scope __device__, for concurrent builds
+    par_huffman::bookg_state* st;
+    cudaMalloc(&st, sizeof(par_huffman::bookg_state));
+    cudaMemset(st, 0, sizeof(par_huffman::bookg_state));
+
     // Codebook already init'ed
     cudaStreamSynchronize((cudaStream_t)stream);
 
@@ -181,11 +186,12 @@ void psz::hf_buildbook_cu(
                        (void*)&tempIsLeaf,   (void*)&tempIndex,
                        (void*)&copyFreq,     (void*)&copyIsLeaf,
                        (void*)&copyIndex,    (void*)&diagonal_path_intersections,
-                       (void*)&mblocks,      (void*)&mthreads};
+                       (void*)&mblocks,      (void*)&mthreads,
+                       (void*)&st};
     // Cooperative Launch
     cudaLaunchCooperativeKernel(
         (void*)par_huffman::GPU_GenerateCL<unsigned int>, mblocks, mthreads, CL_Args,
-        5 * sizeof(int32_t) + 32 * sizeof(int32_t));
+        5 * sizeof(int32_t) + 32 * sizeof(int32_t), (cudaStream_t)stream);
     cudaStreamSynchronize((cudaStream_t)stream);
 
     // Exits if the highest codeword length is greater than what
@@ -195,7 +201,7 @@ void psz::hf_buildbook_cu(
     unsigned int* d_max_CL;
     unsigned int  max_CL;
     cudaMalloc(&d_max_CL, sizeof(unsigned int));
-    hf_detail::GPU_GetMaxCWLength<<<1, 1>>>(CL, nz_dict_size, d_max_CL);
+    hf_detail::GPU_GetMaxCWLength<<<1, 1, 0, (cudaStream_t)stream>>>(CL, nz_dict_size, d_max_CL);
     cudaStreamSynchronize((cudaStream_t)stream);
     cudaMemcpy(&max_CL, d_max_CL, sizeof(unsigned int), cudaMemcpyDeviceToHost);
     cudaFree(d_max_CL);
@@ -233,27 +239,28 @@ void psz::hf_buildbook_cu(
         (void*)&_nz_d_codebook,  //
         (void*)&_d_first,        //
         (void*)&_d_entry,        //
-        (void*)&nz_dict_size};
+        (void*)&nz_dict_size,    //
+        (void*)&st};
 
     // Call second kernel
     cudaLaunchCooperativeKernel(
         (void*)par_huffman::GPU_GenerateCW<unsigned int, H>,  //
         cw_mblocks,                                           //
         1024,                                                 //
-        CW_Args);
+        CW_Args, 0, (cudaStream_t)stream);
     cudaStreamSynchronize((cudaStream_t)stream);
 
 #ifdef D_DEBUG_PRINT
-    print_codebook<H><<<1, 32>>>(codebook, dict_size);  // PASS
+    print_codebook<H><<<1, 32, 0, (cudaStream_t)stream>>>(codebook, dict_size);  // PASS
     cudaStreamSynchronize((cudaStream_t)stream);
 #endif
 
     // Reverse _d_qcode and codebook
-    hf_detail::GPU_ReverseArray<H><<<nblocks, 1024>>>(codebook, (unsigned int)dict_size);
-    hf_detail::GPU_ReverseArray<T><<<nblocks, 1024>>>(_d_qcode, (unsigned int)dict_size);
+    hf_detail::GPU_ReverseArray<H><<<nblocks, 1024, 0, (cudaStream_t)stream>>>(codebook, (unsigned int)dict_size);
+    hf_detail::GPU_ReverseArray<T><<<nblocks, 1024, 0, (cudaStream_t)stream>>>(_d_qcode, (unsigned int)dict_size);
     cudaStreamSynchronize((cudaStream_t)stream);
 
-    hf_detail::GPU_ReorderByIndex<H, T><<<nblocks, 1024>>>(codebook, _d_qcode, (unsigned int)dict_size);
+    hf_detail::GPU_ReorderByIndex<H, T><<<nblocks, 1024, 0, (cudaStream_t)stream>>>(codebook, _d_qcode, (unsigned int)dict_size);
     cudaStreamSynchronize((cudaStream_t)stream);
 
     STOP_GPUEVENT_RECORDING((cudaStream_t)stream);
@@ -272,10 +279,11 @@ void psz::hf_buildbook_cu(
     cudaFree(copyIsLeaf);
     cudaFree(copyIndex);
     cudaFree(diagonal_path_intersections);
+    cudaFree(st);
     cudaStreamSynchronize((cudaStream_t)stream);
 
 #ifdef D_DEBUG_PRINT
-    print_codebook<H><<<1, 32>>>(codebook, dict_size);  // PASS
+    print_codebook<H><<<1, 32, 0, (cudaStream_t)stream>>>(codebook, dict_size);  // PASS
     cudaStreamSynchronize((cudaStream_t)stream);
 #endif
 }
@@ -22,6 +22,11 @@
 #include <cmath>
 #include <numeric>
 #include <stdexcept>
+
+#include "ans/ans.hh"
+#include "hf/hf_bk.hh"
+#include "hf/hf_word.hh"
+
 #define ACCESSOR(SYM, TYPE) \
   reinterpret_cast<TYPE*>(in_compressed + header.entry[Header::SYM])
 
@@ -153,23 +158,31 @@ TPL HF_CODEC* HF_CODEC::build_codebook(
 TPL HF_CODEC* HF_CODEC::build_codebook(
     MemU4* freq, int const bklen, void* stream)
 {
-#ifdef __WORK_IN_PROGRESS
-  psz::hf_buildbook<CPU, E, H8>(
-      freq->control({D2H})->hptr(), bklen, bk8->hptr(), revbk8->hptr(),
-      revbk8_bytes(bklen), &_time_book, (GpuStreamT)stream);
-  bk8->control({ASYNC_H2D}, (GpuStreamT)stream);
-  revbk8->control({ASYNC_H2D}, (GpuStreamT)stream);
-  __encdtype = ULL;
-
-  // [TODO] need get max bits of huffman code
-#endif
-
-  psz::hf_buildbook<CPU, E, H4>(
-      freq->control({D2H})->hptr(), bklen, bk4->hptr(), revbk4->hptr(),
-      revbk4_bytes(bklen), &_time_book, (GpuStreamT)stream);
-  bk4->control({ASYNC_H2D}, (GpuStreamT)stream);
-  revbk4->control({ASYNC_H2D}, (GpuStreamT)stream);
-  __encdtype = U4;
+  freq->control({D2H});
+
+  // u4 book as long as the codewords fit; otherwise, fall back to u8
+  auto max_bitlen = psz::hf_max_bitlen(freq->hptr(), bklen);
+
+  if (max_bitlen <= PackedWordByWidth<4>::FIELDWIDTH_word) {
+    psz::hf_buildbook<CPU, E, H4>(
+        freq->hptr(), bklen, bk4->hptr(), revbk4->hptr(), revbk4_bytes(bklen),
+        &_time_book, (GpuStreamT)stream);
+    bk4->control({ASYNC_H2D}, (GpuStreamT)stream);
+    revbk4->control({ASYNC_H2D}, (GpuStreamT)stream);
+    __encdtype = U4;
+  }
+  else if (max_bitlen <= PackedWordByWidth<8>::FIELDWIDTH_word) {
+    psz::hf_buildbook<CPU, E, H8>(
+        freq->hptr(), bklen, bk8->hptr(), revbk8->hptr(), revbk8_bytes(bklen),
+        &_time_book, (GpuStreamT)stream);
+    bk8->control({ASYNC_H2D}, (GpuStreamT)stream);
+    revbk8->control({ASYNC_H2D}, (GpuStreamT)stream);
+    __encdtype = ULL;
+  }
+  else
+    throw std::runtime_error(
+        "[psz::error::hf] max codeword length (" +
+        std::to_string(max_bitlen) + " bits) exceeds both u4 and u8 books.");
 
   book_desc->bktype = __encdtype;
   book_desc->book = __encdtype == U4 ? (void*)bk4->dptr() : (void*)bk8->dptr();
@@ -179,9 +192,50 @@ TPL HF_CODEC* HF_CODEC::build_codebook(
   return this;
 }
 
+// A book shared by many archives, which then leave out the reverse book;
+// NULL to go back to building one for each.
+TPL HF_CODEC* HF_CODEC::load_book(psz_book const* book, void* stream)
+{
+  shared = book;
+  if (not book) return this;
+
+  if (book->bklen != bklen)
+    throw std::runtime_error(
+        "[psz::error::hf] The shared book is of " +
+        std::to_string(book->bklen) + " symbols, not " +
+        std::to_string(bklen) + ".");
+
+  if (book->encdtype == U4) {
+    memcpy(bk4->hptr(), book->book.data(), book->book.size());
+    memcpy(revbk4->hptr(), book->revbook.data(), book->revbook.size());
+    bk4->control({ASYNC_H2D}, (GpuStreamT)stream);
+    revbk4->control({ASYNC_H2D}, (GpuStreamT)stream);
+  }
+  else {
+    memcpy(bk8->hptr(), book->book.data(), book->book.size());
+    memcpy(revbk8->hptr(), book->revbook.data(), book->revbook.size());
+    bk8->control({ASYNC_H2D}, (GpuStreamT)stream);
+    revbk8->control({ASYNC_H2D}, (GpuStreamT)stream);
+  }
+
+  __encdtype = book->encdtype;
+  book_desc->bktype = __encdtype;
+  book_desc->book = __encdtype == U4 ? (void*)bk4->dptr() : (void*)bk8->dptr();
+
+  return this;
+}
+
 // using CPU huffman
 TPL void HF_CODEC::calculate_CR(MemU4* ectrl, szt sizeof_dtype)
 {
+  auto codeword_bits = [&](E sym) -> int {
+    if (__encdtype == U4)
+      return ((PackedWordByWidth<4>*)(&bk4->hat(sym)))->bits;
+    else
+      return ((PackedWordByWidth<8>*)(&bk8->hat(sym)))->bits;
+  };
+  auto cell_bits = __encdtype == U4 ? 32 : 64;
+
   // serial part
   f8 serial_entropy = 0;
   f8 serial_avg_bits = 0;
@@ -191,13 +245,10 @@ TPL void HF_CODEC::calculate_CR(MemU4* ectrl, szt sizeof_dtype)
 
   for (auto i = 0; i < bklen; i++) {
     auto freq = hist_view->hat(i);
-    auto hfcode = bk4->hat(i);
     if (freq != 0) {
       auto p = 1.0 * freq / len;
       serial_entropy += -std::log2(p) * p;
-
-      auto bits = ((PackedWordByWidth<4>*)(&hfcode))->bits;
-      serial_avg_bits += bits * p;
+      serial_avg_bits += codeword_bits(i) * p;
     }
   }
 
@@ -215,31 +266,34 @@ TPL void HF_CODEC::calculate_CR(MemU4* ectrl, szt sizeof_dtype)
 
     for (auto i = 0; i < tmp_sublen; i++) {
       if (i + tmp_sublen < tmp_len) {
-        auto eq = ectrl->hat(start + i);
-        auto c = bk4->hat(eq);
-        auto b = ((PackedWordByWidth<4>*)(&c))->bits;
-        this_nbit += b;
+        this_nbit += codeword_bits(ectrl->hat(start + i));
       }
     }
     par_nbit->hat(p) = this_nbit;
-    par_ncell->hat(p) = (this_nbit - 1) / 32 + 1;
+    par_ncell->hat(p) = (this_nbit - 1) / cell_bits + 1;
   }
   auto final_len = std::accumulate(par_ncell->hbegin(), par_ncell->hend(), 0);
 
-  auto final_bytes = 1.0 * final_len * sizeof_dtype;
+  auto final_bytes = 1.0 * final_len * cell_bits / 8;
   final_bytes += par_entry->len() *
                  (sizeof(U4) /* for idx */ + sizeof_dtype);  // outliers
   final_bytes += 128 * 2; /* two kinds of headers */
 
+  // rANS on the same histogram, as the alternative codec
+  auto ans_avg_bits = psz::ans_avg_bits(hist_view->hptr(), bklen);
+
   // print report
   // clang-format off
   printf("[psz::info::hf::calc_cr] get CR from hist and par setup\n");
-  printf("[psz::info::hf::calc_cr] (T, H)=(f4, u4)\n");
+  printf("[psz::info::hf::calc_cr] (T, H)=(%zu-byte, %s)\n", sizeof_dtype, __encdtype == U4 ? "u4" : "u8");
   printf("[psz::info::hf::calc_cr] serial (ref), entropy            : %lf\n", serial_entropy);
   printf("[psz::info::hf::calc_cr] serial (ref), avg-bit            : %lf\n", serial_avg_bits);
   printf("[psz::info::hf::calc_cr] serial (ref), entropy-implied CR : %lf\n", sizeof_dtype * 8 / serial_entropy);
   printf("[psz::info::hf::calc_cr] serial (ref), avg-bit-implied    : %lf\n", sizeof_dtype * 8 / serial_avg_bits);
   printf("[psz::info::hf::calc_cr] pSZ/cuSZ achievable CR (chunked) : %lf\n", tmp_len * sizeof_dtype / final_bytes);
+  printf("[psz::info::hf::calc_cr] rANS, avg-bit                    : %lf\n", ans_avg_bits);
+  printf("[psz::info::hf::calc_cr] rANS, avg-bit-implied CR         : %lf\n", sizeof_dtype * 8 / ans_avg_bits);
+  printf("[psz::info::hf::calc_cr] rANS over Huffman (avg-bit ratio): %lf\n", serial_avg_bits / ans_avg_bits);
   printf("[psz::info::hf::calc_cr] analysis done, exiting...\n");
   // clang-format on
   // exit(0);
@@ -259,12 +313,10 @@ TPL HF_CODEC* HF_CODEC::encode(
     psz::hf_encode_coarse_rev2<E, H4, M>(
         in, inlen, book_desc, bitstream_desc, &header.total_nbit,
         &header.total_ncell, &_time_lossless, stream);
-  else {
-    printf("[psz::dbg::hf::enc] using H8 for encoding\n");
+  else
     psz::hf_encode_coarse_rev2<E, H8, M>(
         in, inlen, book_desc, bitstream_desc, &header.total_nbit,
         &header.total_ncell, &_time_lossless, stream);
-  }
 
   __hf_merge(
       header, inlen, book_desc->bklen, bitstream_desc->sublen,
@@ -286,15 +338,22 @@ TPL HF_CODEC* HF_CODEC::decode(
         &header, in_compressed, sizeof(header), GpuMemcpyD2H,
         (GpuStreamT)stream));
 
+  // without a reverse book of its own, the archive is of the shared book
+  auto revbk = psz::hf_revbook_of(
+      ACCESSOR(REVBK, BYTE),
+      header.entry[Header::REVBK + 1] - header.entry[Header::REVBK],
+      header.encdtype, header.bklen, shared,
+      header.encdtype == U4 ? revbk4->dptr() : revbk8->dptr());
+
   if (header.encdtype == U4)
     psz::hf_decode_coarse<E, H4, M>(
-        ACCESSOR(BITSTREAM, H4), ACCESSOR(REVBK, BYTE),
+        ACCESSOR(BITSTREAM, H4), revbk,
         revbk4_bytes(header.bklen), ACCESSOR(PAR_NBIT, M),
         ACCESSOR(PAR_ENTRY, M), header.sublen, header.pardeg, out_decompressed,
         &_time_lossless, stream);
   else
     psz::hf_decode_coarse<E, H8, M>(
-        ACCESSOR(BITSTREAM, H8), ACCESSOR(REVBK, BYTE),
+        ACCESSOR(BITSTREAM, H8), revbk,
         revbk8_bytes(header.bklen), ACCESSOR(PAR_NBIT, M),
         ACCESSOR(PAR_ENTRY, M), header.sublen, header.pardeg, out_decompressed,
         &_time_lossless, stream);
@@ -317,10 +376,18 @@ TPL HF_CODEC* HF_CODEC::dump(
     // TODO check if compressed len updated
     if (i == PszHfArchive)
       compressed->control({H2D})->file(ofn(".pszhf_ar"), ToFile);
-    else if (i == PszHfBook)
-      bk4->control({H2D})->file(ofn(".pszhf_bk"), ToFile);
-    else if (i == PszHfRevbook)
-      revbk4->control({H2D})->file(ofn(".pszhf_revbk"), ToFile);
+    else if (i == PszHfBook) {
+      if (__encdtype == U4)
+        bk4->control({H2D})->file(ofn(".pszhf_bk"), ToFile);
+      else
+        bk8->control({H2D})->file(ofn(".pszhf_bk"), ToFile);
+    }
+    else if (i == PszHfRevbook) {
+      if (__encdtype == U4)
+        revbk4->control({H2D})->file(ofn(".pszhf_revbk"), ToFile);
+      else
+        revbk8->control({H2D})->file(ofn(".pszhf_revbk"), ToFile);
+    }
     else if (i == PszHfParNbit)
       par_nbit->control({H2D})->file(ofn(".pszhf_pbit"), ToFile);
     else if (i == PszHfParNcell)
@@ -339,6 +406,8 @@ TPL HF_CODEC* HF_CODEC::clear_buffer()
   scratch4->control({ClearDevice});
   bk4->control({ClearDevice});
   revbk4->control({ClearDevice});
+  bk8->control({ClearDevice});
+  revbk8->control({ClearDevice});
   bitstream4->control({ClearDevice});
 
   par_nbit->control({ClearDevice});
@@ -370,8 +439,9 @@ TPL void HF_CODEC::__hf_merge(
 
   M nbyte[Header::END];
   nbyte[Header::HEADER] = sizeof(Header);
-  nbyte[Header::REVBK] =
-      __encdtype == U4 ? revbk4_bytes(bklen) : revbk8_bytes(bklen);
+  nbyte[Header::REVBK] = shared                ? 0
+                         : __encdtype == U4 ? revbk4_bytes(bklen)
+                                            : revbk8_bytes(bklen);
   nbyte[Header::PAR_NBIT] = par_nbit->bytes();
   nbyte[Header::PAR_ENTRY] = par_ncell->bytes();
   nbyte[Header::BITSTREAM] = (__encdtype == U4 ? 4 : 8) * header.total_ncell;
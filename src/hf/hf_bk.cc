@@ -1,11 +1,18 @@
 #include "hf/hf_bk.hh"
 
 #include "busyheader.hh"
+#include "cusz.h"
 #include "cusz/type.h"
 #include "hf/hf_bk_impl.hh"
 #include "hf/hf_canon.hh"
+#include "hf/hf_word.hh"
 #include "utils/timer.hh"
 
+int psz::hf_max_bitlen(uint32_t* freq, int const bklen)
+{
+  return hf_maxbits_impl1(freq, bklen);
+}
+
 template <typename E, typename H>
 void hf_build_and_canonize_book_serial(
     uint32_t* freq, int const bklen, H* book, uint8_t* revbook,
@@ -15,9 +22,16 @@ void hf_build_and_canonize_book_serial(
   auto bk_bytes = sizeof(H) * bklen;
   auto space_bytes = hf_space<E, H>::space_bytes(bklen);
   auto revbook_ofst = hf_space<E, H>::revbook_offset(bklen);
-  auto space = new hf_canon_reference<E, H>(bklen);
   *time = 0;
 
+  auto max_bitlen = psz::hf_max_bitlen(freq, bklen);
+  if (max_bitlen > PackedWordByWidth<sizeof(H)>::FIELDWIDTH_word)
+    throw std::runtime_error(
+        "[psz::error::hf] max codeword length (" + std::to_string(max_bitlen) +
+        " bits) exceeds the " + std::to_string(sizeof(H)) + "-byte book.");
+
+  auto space = new hf_canon_reference<E, H>(bklen);
+
   // mask the codebook to 0xff
   memset(book, 0xff, bk_bytes);
 
@@ -46,13 +60,13 @@ void hf_build_and_canonize_book_serial(
   // copy to output1
   memcpy(book, space->ocb(), bk_bytes);
 
-  // copy to output2
-  auto offset = 0;
-  memcpy(revbook, space->first(), sizeof(int) * TYPE_BITS);
-  offset += sizeof(int) * TYPE_BITS;
-  memcpy(revbook + offset, space->entry(), sizeof(int) * TYPE_BITS);
-  offset += sizeof(int) * TYPE_BITS;
-  memcpy(revbook + offset, space->keys(), sizeof(E) * bklen);
+  // copy to output2; the decoder reads `first` and `entry` as H
+  auto first = (H*)revbook;
+  auto entry = first + TYPE_BITS;
+  for (auto i = 0; i < TYPE_BITS; i++) first[i] = space->first(i);
+  for (auto i = 0; i < TYPE_BITS; i++) entry[i] = space->entry(i);
+  memcpy(
+      revbook + sizeof(H) * (2 * TYPE_BITS), space->keys(), sizeof(E) * bklen);
 
   // memcpy(space, book, bk_bytes);  // copy in
   // canonize<E, H>(space, bklen);
@@ -82,3 +96,146 @@ SPECIALIZE(u2, ull)
 SPECIALIZE(u4, ull)
 
 #undef SPECIALIZE
+
+namespace {
+
+char const book_magic[8] = "PSZBK01";
+
+template <typename H>
+void hf_buildbook_shared_as(uint32_t* freq, int const bklen, psz_book* book)
+{
+  constexpr auto TYPE_BITS = sizeof(H) * 8;
+  book->book.resize(sizeof(H) * bklen);
+  book->revbook.resize(sizeof(H) * (2 * TYPE_BITS) + sizeof(u4) * bklen);
+
+  float time;
+  psz::hf_buildbook<CPU, u4, H>(
+      freq, bklen, (H*)book->book.data(), book->revbook.data(),
+      book->revbook.size(), &time);
+}
+
+// FNV-1a of the book and the reverse book; never 0, which means no book
+uint32_t hf_book_id(psz_book const* book)
+{
+  uint32_t h = 2166136261u;
+  for (auto v : {&book->book, &book->revbook})
+    for (auto b : *v) h = (h ^ b) * 16777619u;
+  return h ? h : 1;
+}
+
+}  // namespace
+
+void psz::hf_buildbook_shared(
+    uint32_t* freq, int const bklen, psz_book* book)
+{
+  book->bklen = bklen;
+
+  auto max_bitlen = psz::hf_max_bitlen(freq, bklen);
+  if (max_bitlen <= PackedWordByWidth<4>::FIELDWIDTH_word) {
+    hf_buildbook_shared_as<u4>(freq, bklen, book);
+    book->encdtype = U4;
+  }
+  else if (max_bitlen <= PackedWordByWidth<8>::FIELDWIDTH_word) {
+    hf_buildbook_shared_as<ull>(freq, bklen, book);
+    book->encdtype = ULL;
+  }
+  else
+    throw std::runtime_error(
+        "[psz::error::hf] max codeword length (" +
+        std::to_string(max_bitlen) + " bits) exceeds both u4 and u8 books.");
+
+  book->id = hf_book_id(book);
+}
+
+bool psz::hf_book_covers(psz_book const* book, uint32_t const* freq)
+{
+  // a symbol without a codeword is left masked, longer than any codeword
+  auto bits = [&](int i) -> int {
+    if (book->encdtype == U4)
+      return ((PackedWordByWidth<4>*)book->book.data())[i].bits;
+    else
+      return ((PackedWordByWidth<8>*)book->book.data())[i].bits;
+  };
+  auto max_bits = book->encdtype == U4 ? PackedWordByWidth<4>::FIELDWIDTH_word
+                                       : PackedWordByWidth<8>::FIELDWIDTH_word;
+
+  for (auto i = 0; i < book->bklen; i++)
+    if (freq[i] and (bits(i) == 0 or bits(i) > max_bits)) return false;
+  return true;
+}
+
+uint8_t* psz::hf_revbook_of(
+    uint8_t* own, size_t revbk_bytes, pszdtype encdtype, int bklen,
+    psz_book const* shared, uint8_t* loaded)
+{
+  if (revbk_bytes != 0) return own;
+
+  if (not shared)
+    throw std::runtime_error(
+        "[psz::error::hf] The archive is encoded with a shared book, which "
+        "is not given.");
+  if (shared->encdtype != encdtype or shared->bklen != bklen)
+    throw std::runtime_error(
+        "[psz::error::hf] The archive is encoded with a shared book of " +
+        std::to_string(bklen) + " symbols in " +
+        (encdtype == U4 ? "u4" : "u8") + " codewords, not the one given.");
+  return loaded;
+}
+
+psz_book* psz_book_create(uint32_t* freq, int const bklen)
+{
+  auto book = new psz_book;
+  psz::hf_buildbook_shared(freq, bklen, book);
+  return book;
+}
+
+pszerror psz_book_release(psz_book* book)
+{
+  delete book;
+  return CUSZ_SUCCESS;
+}
+
+uint32_t psz_book_id(psz_book const* book) { return book->id; }
+
+size_t psz_book_bytes(psz_book const* book)
+{
+  return sizeof(book_magic) + 5 * sizeof(uint32_t) + book->book.size() +
+         book->revbook.size();
+}
+
+pszerror psz_book_export(psz_book const* book, void* out)
+{
+  auto p = (uint8_t*)out;
+  uint32_t meta[5] = {
+      (uint32_t)book->bklen, (uint32_t)book->encdtype, book->id,
+      (uint32_t)book->book.size(), (uint32_t)book->revbook.size()};
+  memcpy(p, book_magic, sizeof(book_magic)), p += sizeof(book_magic);
+  memcpy(p, meta, sizeof(meta)), p += sizeof(meta);
+  memcpy(p, book->book.data(), book->book.size()), p += book->book.size();
+  memcpy(p, book->revbook.data(), book->revbook.size());
+  return CUSZ_SUCCESS;
+}
+
+psz_book* psz_book_import(void const* in, size_t const bytes)
+{
+  auto p = (uint8_t const*)in;
+  uint32_t meta[5];
+  if (bytes < sizeof(book_magic) + sizeof(meta) or
+      memcmp(p, book_magic, sizeof(book_magic)))
+    throw std::runtime_error("[psz::error::hf] Not an exported book.");
+  memcpy(meta, p + sizeof(book_magic), sizeof(meta));
+  p += sizeof(book_magic) + sizeof(meta);
+  if (bytes != sizeof(book_magic) + sizeof(meta) + meta[3] + meta[4])
+    throw std::runtime_error("[psz::error::hf] Truncated book.");
+
+  auto book = new psz_book;
+  book->bklen = meta[0], book->encdtype = (pszdtype)meta[1];
+  book->book.assign(p, p + meta[3]);
+  book->revbook.assign(p + meta[3], p + meta[3] + meta[4]);
+  book->id = hf_book_id(book);
+  if (book->id != meta[2]) {
+    delete book;
+    throw std::runtime_error("[psz::error::hf] Corrupted book.");
+  }
+  return book;
+}
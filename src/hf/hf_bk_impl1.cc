@@ -12,6 +12,9 @@
 
 #include "hf/hf_bk_impl.hh"
 
+#include <utility>
+#include <vector>
+
 #include "busyheader.hh"
 #include "cusz/type.h"
 #include "hf/hf_word.hh"
@@ -212,6 +215,47 @@ void hf_buildtree_impl1(
   delete[] freq;
 }
 
+// Same tree as hf_buildtree_impl1 (same queue and tie-breaking), walked for
+// its depth only, i.e., the longest codeword before any book is filled.
+int hf_maxbits_impl1(uint32_t* ext_freq, uint16_t booklen)
+{
+  auto state_num = 2 * booklen;
+  auto all_nodes = 2 * state_num;
+
+  auto freq = new uint32_t[all_nodes];
+  memset(freq, 0, sizeof(uint32_t) * all_nodes);
+  memcpy(freq, ext_freq, sizeof(uint32_t) * booklen);
+
+  auto tree = create_tree_serial(state_num);
+
+  for (size_t i = 0; i < tree->all_nodes; i++)
+    if (freq[i]) qinsert(tree, new_node(tree, freq[i], i, 0, 0));
+  while (tree->qend > 2)
+    qinsert(tree, new_node(tree, 0, 0, qremove(tree), qremove(tree)));
+
+  int max_depth = 0;
+  if (tree->qend == 2) {
+    std::vector<std::pair<node_list, int>> stack{{tree->qq[1], 0}};
+    while (not stack.empty()) {
+      auto n = stack.back().first;
+      auto depth = stack.back().second;
+      stack.pop_back();
+
+      if (n->left or n->right) {
+        stack.push_back({n->left, depth + 1});
+        stack.push_back({n->right, depth + 1});
+      }
+      else
+        max_depth = std::max(max_depth, depth);
+    }
+  }
+
+  destroy_tree(tree);
+  delete[] freq;
+
+  return max_depth;
+}
+
 template void hf_buildtree_impl1<u4>(u4*, u2, u4*, f4*);
 template void hf_buildtree_impl1<u8>(u4*, u2, u8*, f4*);
 template void hf_buildtree_impl1<ull>(u4*, u2, ull*, f4*);
@@ -30,13 +30,15 @@ template __global__ void par_huffman::GPU_GenerateCL<uint32_t>(
     int*,
     uint32_t*,
     int,
-    int);
+    int,
+    par_huffman::bookg_state*);
 
 template __global__ void
-par_huffman::GPU_GenerateCW<uint32_t, uint32_t>(uint32_t* CL, uint32_t* CW, uint32_t* first, uint32_t* entry, int size);
+par_huffman::GPU_GenerateCW<uint32_t, uint32_t>(uint32_t* CL, uint32_t* CW, uint32_t* first, uint32_t* entry, int size, par_huffman::bookg_state* st);
 template __global__ void par_huffman::GPU_GenerateCW<uint32_t, unsigned long long>(
     uint32_t*           CL,
     unsigned long long* CW,
     unsigned long long* first,
     unsigned long long* entry,
-    int                 size);
\ No newline at end of file
+    int                 size,
+    par_huffman::bookg_state* st);
\ No newline at end of file
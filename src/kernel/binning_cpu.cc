@@ -0,0 +1,67 @@
+/**
+ * @file binning_cpu.cc
+ * @author Jiannan Tian
+ * @brief Downsampling by binning for the preview level (CPU).
+ * @version 0.4
+ * @date 2023-09-21
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/binning.hh"
+
+#include <algorithm>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+template <typename T>
+void binning_cpu(
+    T* in, psz_dim3 const len3, int const bx, int const by, T* out,
+    float* time)
+{
+  auto a = hires::now();
+
+  size_t const x = len3.x, y = len3.y;
+  auto const len3_out = binning_len3(len3, bx, by);
+  size_t const nx = len3_out.x, ny = len3_out.y, nz = len3_out.z;
+
+  // a row of output per task; accumulated in double
+  psz::cpu::parallel_for(ny * nz, [&](size_t r) {
+    auto iy = r % ny, iz = r / ny;
+    auto y0 = iy * by, y1 = std::min(y0 + by, y);
+    auto plane = in + iz * x * y;
+
+    for (size_t ix = 0; ix < nx; ix++) {
+      auto x0 = ix * bx, x1 = std::min(x0 + bx, x);
+      f8 sum = 0;
+      for (auto j = y0; j < y1; j++)
+        for (auto i = x0; i < x1; i++) sum += plane[j * x + i];
+      out[r * nx + ix] = sum / ((y1 - y0) * (x1 - x0));
+    }
+  });
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_BINNING_CPU(T)                                       \
+  template <>                                                           \
+  void psz::binning<T>(                                                 \
+      T * in, psz_dim3 const len3, int const bx, int const by, T* out,  \
+      float* time)                                                      \
+  {                                                                     \
+    psz::detail::binning_cpu<T>(in, len3, bx, by, out, time);           \
+  }
+
+SPECIALIZE_BINNING_CPU(f4);
+SPECIALIZE_BINNING_CPU(f8);
+
+#undef SPECIALIZE_BINNING_CPU
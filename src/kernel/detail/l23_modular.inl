@@ -0,0 +1,239 @@
+/**
+ * @file l23_modular.inl
+ * @author Jiannan Tian
+ * @brief Lorenzo in modular integer arithmetic (CPU), shared by the integer
+ * and the half-precision input.
+ * @version 0.4
+ * @date 2023-09-19
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#ifndef F3A6D2C8_1B7E_4E95_8C4A_6D0B2E9F7A13
+#define F3A6D2C8_1B7E_4E95_8C4A_6D0B2E9F7A13
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "cusz/suint.hh"
+#include "cusz/type.h"
+#include "utils/par_cpu.hh"
+
+namespace psz {
+namespace detail {
+
+constexpr size_t L23_MOD_XBLK = 4096;
+// flags an outlier that holds the input value itself, not a delta
+constexpr u4 L23_MOD_RAW = 1u << 31;
+// flags the high half of a delta wider than T (for U twice as wide), which
+// follows its low half
+constexpr u4 L23_MOD_HI = 1u << 30;
+
+// `Q` maps rows of T to and from U, unsigned integers as wide as T or twice
+// as wide; a delta that does not fit T is kept in two outliers:
+//   `Q::U`
+//   `quantize(T const* in, U* q, size_t n, std::vector<u4>* raw)`, which
+//     appends to `raw` (if not null) the positions to keep as is;
+//   `dequantize(U const* q, T* out, size_t n)`, which works in place.
+template <typename T, typename E, typename Q>
+void l23_mod_construct(
+    T* data, psz_dim3 const len3, int const radius, E* eq, T* outlier_val,
+    u4* outlier_idx, size_t* num_outlier, size_t const max_outlier,
+    Q const& quant)
+{
+  using U = typename Q::U;
+  using UT = typename psz::typing::UInt<sizeof(T)>::T;
+  using ST = typename std::make_signed<UT>::type;
+  static_assert(
+      sizeof(U) == sizeof(T) or sizeof(U) == 2 * sizeof(T),
+      "U is to be as wide as T or twice as wide.");
+  constexpr auto half = 4 * sizeof(T);  // shifted twice, for the high half
+
+  size_t const x = len3.x, y = len3.y, z = len3.z;
+  auto const nrow = y * z;
+  auto const nxblk = (x - 1) / L23_MOD_XBLK + 1;
+  *num_outlier = 0;
+  if (x * nrow == 0) return;
+
+  // Blocks of a row along x are independent, given the prequantized
+  // neighboring rows and the one value before the block (the carry), so
+  // that a long 1D field is split as a 3D one is.
+  auto const nunit = nrow * nxblk;
+  auto nchunk = std::min(nunit, 4 * (size_t)psz::cpu::nthread());
+  auto units_per_chunk = (nunit - 1) / nchunk + 1;
+  std::vector<std::vector<std::pair<u4, T>>> outliers(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto const m = std::min(x, L23_MOD_XBLK) + 1;
+    std::vector<U> q(m), qy(m), qz(m), qyz(m);
+    std::vector<u4> raw;
+
+    // [x0 - 1, x1) of a row, to [0, x1 - x0 + 1); 0 out of the field
+    auto load = [&](std::vector<U>& buf, long iy, long iz, size_t x0,
+                    size_t x1, bool current) {
+      if (iy < 0 or iz < 0) {
+        std::fill(buf.begin(), buf.end(), (U)0);
+        return;
+      }
+      auto row = data + (iz * y + iy) * x;
+      buf[0] = 0;
+      if (x0 > 0) quant.quantize(row + x0 - 1, buf.data(), 1, nullptr);
+      quant.quantize(
+          row + x0, buf.data() + 1, x1 - x0, current ? &raw : nullptr);
+    };
+
+    auto unit_end = std::min((c + 1) * units_per_chunk, nunit);
+    for (auto u = c * units_per_chunk; u < unit_end; u++) {
+      auto r = u / nxblk, x0 = u % nxblk * L23_MOD_XBLK;
+      auto x1 = std::min(x0 + L23_MOD_XBLK, x);
+      long iy = r % y, iz = r / y;
+      raw.clear();
+      load(q, iy, iz, x0, x1, true), load(qy, iy - 1, iz, x0, x1, false);
+      load(qz, iy, iz - 1, x0, x1, false);
+      load(qyz, iy - 1, iz - 1, x0, x1, false);
+
+      for (auto ix = x0; ix < x1; ix++) {
+        auto const k = ix - x0 + 1;  // `k - 1` is the west neighbor
+        U pred = q[k - 1] + qy[k] + qz[k] - qy[k - 1] - qz[k - 1] - qyz[k] +
+                 qyz[k - 1];
+        U delta = q[k] - pred;
+        auto sd = (typename std::make_signed<U>::type)delta;
+        auto id = r * x + ix;
+
+        if (sd > -radius and sd < radius)
+          eq[id] = (E)(sd + radius);
+        else {
+          auto keep = [&](u4 idx, UT bits) {
+            T val;
+            memcpy(&val, &bits, sizeof(T));
+            outliers[c].push_back({idx, val});
+          };
+          eq[id] = 0;
+          keep((u4)id, (UT)delta);
+          if ((decltype(sd))(ST)(UT)delta != sd)
+            keep((u4)id | L23_MOD_HI, (UT)(delta >> half >> half));
+        }
+      }
+
+      for (auto i : raw) {
+        auto id = r * x + x0 + i;
+        outliers[c].push_back({(u4)id | L23_MOD_RAW, data[id]});
+      }
+    }
+  });
+
+  size_t n = 0, nraw = 0, nhi = 0;
+  for (auto& o : outliers) {
+    n += o.size();
+    for (auto& p : o) {
+      nraw += p.first >= L23_MOD_RAW;
+      nhi += p.first >= L23_MOD_HI and p.first < L23_MOD_RAW;
+    }
+  }
+  if (n > max_outlier)
+    throw std::runtime_error(
+        "[psz::error::l23] Too many outliers exceed the maximum allocated "
+        "buffer.");
+  if (nraw and x * nrow > L23_MOD_RAW)
+    throw std::runtime_error(
+        "[psz::error::l23] Input is too long for unquantizable values.");
+  if (nhi and x * nrow > L23_MOD_HI)
+    throw std::runtime_error(
+        "[psz::error::l23] Input is too long for deltas wider than it.");
+
+  n = 0;
+  for (auto& o : outliers)
+    for (auto& p : o) outlier_idx[n] = p.first, outlier_val[n++] = p.second;
+  *num_outlier = n;
+}
+
+template <typename T, typename E, typename Q>
+void l23_mod_reconstruct(
+    E* eq, T* outlier_val, u4* outlier_idx, size_t const num_outlier,
+    psz_dim3 const len3, int const radius, T* xdata, Q const& quant)
+{
+  using U = typename Q::U;
+  using UT = typename psz::typing::UInt<sizeof(T)>::T;
+  using ST = typename std::make_signed<UT>::type;
+  static_assert(
+      sizeof(U) == sizeof(T) or sizeof(U) == 2 * sizeof(T),
+      "U is to be as wide as T or twice as wide.");
+  constexpr auto wide = sizeof(U) > sizeof(T);
+  constexpr auto half = 4 * sizeof(T);
+
+  size_t const x = len3.x, y = len3.y, z = len3.z;
+  auto const len = x * y * z;
+  auto const nxblk = (x - 1) / L23_MOD_XBLK + 1;
+  if (len == 0) return;
+
+  // in place if of the same width
+  std::vector<U> wbuf(wide ? len : 0);
+  auto q = wide ? wbuf.data() : (U*)xdata;
+
+  auto nchunk = 4 * (size_t)psz::cpu::nthread();
+  auto chunk = std::max((len - 1) / nchunk + 1, L23_MOD_XBLK);
+  nchunk = (len - 1) / chunk + 1;
+
+  // deltas, with outliers scattered
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto end = std::min((c + 1) * chunk, len);
+    for (auto i = c * chunk; i < end; i++) q[i] = (U)((i8)eq[i] - radius);
+  });
+  // low halves (sign-extended), then high halves over them
+  auto const plain = wide ? L23_MOD_HI : L23_MOD_RAW;
+  for (size_t i = 0; i < num_outlier; i++) {
+    UT bits;
+    memcpy(&bits, outlier_val + i, sizeof(T));
+    auto idx = outlier_idx[i];
+    if (idx < plain) q[idx] = (U)(ST)bits;
+  }
+  for (size_t i = 0; wide and i < num_outlier; i++) {
+    UT bits;
+    memcpy(&bits, outlier_val + i, sizeof(T));
+    auto idx = outlier_idx[i];
+    if (idx >= L23_MOD_HI and idx < L23_MOD_RAW) {
+      auto& v = q[idx - L23_MOD_HI];
+      v = (U)(UT)v | (U)bits << half << half;
+    }
+  }
+
+  // inverse of Lorenzo: prefix sums along x, y and z in turn
+  psz::cpu::parallel_for(y * z, [&](size_t r) {
+    auto row = q + r * x;
+    for (size_t ix = 1; ix < x; ix++) row[ix] += row[ix - 1];
+  });
+  psz::cpu::parallel_for(z * nxblk, [&](size_t c) {
+    auto iz = c / nxblk, x0 = c % nxblk * L23_MOD_XBLK;
+    auto x1 = std::min(x0 + L23_MOD_XBLK, x);
+    for (size_t iy = 1; iy < y; iy++) {
+      auto row = q + (iz * y + iy) * x, prev = row - x;
+      for (auto ix = x0; ix < x1; ix++) row[ix] += prev[ix];
+    }
+  });
+  psz::cpu::parallel_for(y * nxblk, [&](size_t c) {
+    auto iy = c / nxblk, x0 = c % nxblk * L23_MOD_XBLK;
+    auto x1 = std::min(x0 + L23_MOD_XBLK, x);
+    for (size_t iz = 1; iz < z; iz++) {
+      auto row = q + (iz * y + iy) * x, prev = row - x * y;
+      for (auto ix = x0; ix < x1; ix++) row[ix] += prev[ix];
+    }
+  });
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * chunk, end = std::min(start + chunk, len);
+    quant.dequantize(q + start, xdata + start, end - start);
+  });
+
+  for (size_t i = 0; i < num_outlier; i++)
+    if (outlier_idx[i] >= L23_MOD_RAW)
+      xdata[outlier_idx[i] - L23_MOD_RAW] = outlier_val[i];
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#endif /* F3A6D2C8_1B7E_4E95_8C4A_6D0B2E9F7A13 */
@@ -0,0 +1,64 @@
+/**
+ * @file dryrun_cpu.cc
+ * @author Jiannan Tian
+ * @brief Dryrun on host, fused with quality assessment.
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/dryrun.hh"
+
+#include <cmath>
+
+#include "stat/detail/compare_cpu.inl"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+// The reconstruction is made block by block as the assessment reads it, and
+// never stored whole.
+template <typename T>
+void dryrun_assess_cpu(
+    T* original, size_t const len, double const eb, pszsummary* s,
+    float* time)
+{
+  auto a = hires::now();
+
+  *s = pszsummary{};
+  s->len = len;
+  if (len == 0) return;
+
+  T const ebx2_r = 1 / (eb * 2), ebx2 = eb * 2;
+
+  // the round trip of `dryrun_kernel`, in T
+  auto recon = [&](size_t i, size_t m, T* buf) {
+    for (size_t j = 0; j < m; j++)
+      buf[j] = std::round(original[i + j] * ebx2_r) * ebx2;
+    return (T const*)buf;
+  };
+  assess_finish(s, assess_range_by<T>(original, len, recon));
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_DRYRUN(T)                                              \
+  template <>                                                             \
+  void psz::dryrun_assess<T>(                                             \
+      T * original, size_t const len, double const eb, pszsummary* s,     \
+      float* time)                                                        \
+  {                                                                       \
+    psz::detail::dryrun_assess_cpu<T>(original, len, eb, s, time);        \
+  }
+
+SPECIALIZE_DRYRUN(f4);
+SPECIALIZE_DRYRUN(f8);
+
+#undef SPECIALIZE_DRYRUN
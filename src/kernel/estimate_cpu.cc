@@ -0,0 +1,380 @@
+/**
+ * @file estimate_cpu.cc
+ * @author Jiannan Tian
+ * @brief Sampling-based estimate of compressibility, and eb autotuning.
+ * @version 0.4
+ * @date 2023-09-23
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/estimate.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "hf/hf_bk.hh"
+#include "hf/hf_word.hh"
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+constexpr size_t SAMPLER_SUBLEN = 1 << 20;
+
+// Huffman bits per symbol, from the book built for `freq` as the codec does
+template <typename H>
+double hf_avg_bits_cpu(std::vector<u4>& freq, size_t total)
+{
+  auto bklen = (int)freq.size();
+  std::vector<H> book(bklen);
+  auto revbook_bytes = sizeof(H) * (2 * 8 * sizeof(H)) + sizeof(u4) * bklen;
+  std::vector<u1> revbook(revbook_bytes);
+  float t;
+  psz::hf_buildbook<CPU, u4, H>(
+      freq.data(), bklen, book.data(), revbook.data(), revbook_bytes, &t);
+
+  double bits = 0;
+  for (auto i = 0; i < bklen; i++)
+    if (freq[i])
+      bits += 1.0 * freq[i] / total *
+              ((PackedWordByWidth<sizeof(H)>*)(&book[i]))->bits;
+  return std::max(bits, 1.0);
+}
+
+double hf_avg_bits(std::vector<u4>& freq, size_t total, double entropy)
+{
+  auto nsym = std::count_if(freq.begin(), freq.end(), [](u4 f) { return f; });
+  if (nsym <= 1) return 1;
+
+  auto max_bitlen = psz::hf_max_bitlen(freq.data(), freq.size());
+  if (max_bitlen <= PackedWordByWidth<4>::FIELDWIDTH_word)
+    return hf_avg_bits_cpu<u4>(freq, total);
+  else if (max_bitlen <= PackedWordByWidth<8>::FIELDWIDTH_word)
+    return hf_avg_bits_cpu<u8>(freq, total);
+  else
+    return entropy + 1;  // the codec cannot build it either
+}
+
+}  // namespace detail
+}  // namespace psz
+
+template <typename T>
+constexpr double psz::sampler<T>::DEFAULT_FRACTION;
+template <typename T>
+constexpr size_t psz::sampler<T>::MIN_NBLK;
+
+template <typename T>
+psz::sampler<T>::sampler(
+    T const* in, psz_dim3 const len3, double const fraction)
+{
+  // 4096 values per block, in the shape of the field
+  if (len3.z > 1)
+    blk = {16, 16, 16};
+  else if (len3.y > 1)
+    blk = {64, 64, 1};
+  else
+    blk = {4096, 1, 1};
+  blk = {std::min(blk.x, len3.x), std::min(blk.y, len3.y),
+         std::min(blk.z, len3.z)};
+
+  u4 const hx = 1, hy = blk.y > 1, hz = blk.z > 1;
+  loc = {blk.x + 2 * hx, blk.y + 2 * hy, blk.z + 2 * hz};
+
+  // full blocks only
+  size_t const gx = len3.x / blk.x, gy = len3.y / blk.y, gz = len3.z / blk.z;
+  size_t const total = gx * gy * gz;
+  nblk_ = std::ceil(fraction * total);
+  nblk_ = std::min(std::max(nblk_, MIN_NBLK), total);
+
+  auto const loc_len = (size_t)loc.x * loc.y * loc.z;
+  data.resize(nblk_ * loc_len);
+  min = std::numeric_limits<double>::infinity(), max = -min;
+
+  for (size_t k = 0; k < nblk_; k++) {
+    // evenly strided, centered in each stride
+    auto b = (2 * k + 1) * total / (2 * nblk_);
+    long x0 = b % gx * blk.x, y0 = b / gx % gy * blk.y,
+         z0 = b / (gx * gy) * blk.z;
+
+    auto dst = data.data() + k * loc_len;
+    for (u4 lz = 0; lz < loc.z; lz++)
+      for (u4 ly = 0; ly < loc.y; ly++)
+        for (u4 lx = 0; lx < loc.x; lx++) {
+          long ix = x0 + lx - hx, iy = y0 + ly - hy, iz = z0 + lz - hz;
+          auto& v = dst[(lz * loc.y + ly) * loc.x + lx];
+          if (ix < 0 or iy < 0 or iz < 0) {
+            v = 0;  // as the kernel pads the field, and so is its quant-code
+            continue;
+          }
+          // past the high end, the last value stands in
+          ix = std::min(ix, (long)len3.x - 1);
+          iy = std::min(iy, (long)len3.y - 1);
+          iz = std::min(iz, (long)len3.z - 1);
+          v = in[(iz * len3.y + iy) * len3.x + ix];
+        }
+  }
+
+  // PSNR is against the range of the field, which the samples can miss
+  auto len = (size_t)len3.x * len3.y * len3.z;
+  auto const sublen = detail::SAMPLER_SUBLEN;
+  auto nchunk = (len - 1) / sublen + 1;
+  std::vector<std::pair<T, T>> ext(nchunk);
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = in + c * sublen, end = in + std::min((c + 1) * sublen, len);
+    auto res = std::minmax_element(start, end);
+    ext[c] = {*res.first, *res.second};
+  });
+  for (auto& e : ext) {
+    min = std::min(min, (double)e.first);
+    max = std::max(max, (double)e.second);
+  }
+}
+
+template <typename T>
+template <typename F>
+pszestimate psz::sampler<T>::evaluate(int const radius, F&& per_block) const
+{
+  auto const loc_len = (size_t)loc.x * loc.y * loc.z;
+  auto nchunk = std::min(nblk_, 4 * (size_t)psz::cpu::nthread());
+  std::vector<tally> tallies(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto& t = tallies[c];
+    t.freq.resize(2 * radius);
+    std::vector<T> buf(loc_len);
+    for (auto k = c; k < nblk_; k += nchunk)
+      per_block(data.data() + k * loc_len, buf.data(), t);
+  });
+
+  auto& t = tallies[0];
+  for (size_t c = 1; c < nchunk; c++) {
+    for (auto i = 0; i < 2 * radius; i++) t.freq[i] += tallies[c].freq[i];
+    t.noutlier += tallies[c].noutlier, t.nanchor += tallies[c].nanchor;
+    t.sum_err2 += tallies[c].sum_err2;
+  }
+  return finish(t);
+}
+
+template <typename T>
+pszestimate psz::sampler<T>::lorenzo(double const eb, int const radius) const
+{
+  T const ebx2_r = 1 / (eb * 2), ebx2 = eb * 2;
+  u4 const hx = 1, hy = blk.y > 1, hz = blk.z > 1;
+  auto const sy = (size_t)loc.x, sz = sy * loc.y;
+  auto const loc_len = sz * loc.z;
+
+  return evaluate(radius, [&](T const* src, T* buf, tally& t) {
+    // prequantization as the Lorenzo kernel does, kept in T
+    auto q = buf;
+    for (size_t i = 0; i < loc_len; i++) q[i] = std::round(src[i] * ebx2_r);
+
+    for (auto lz = hz; lz < hz + blk.z; lz++)
+      for (auto ly = hy; ly < hy + blk.y; ly++) {
+        auto row = lz * sz + ly * sy;
+        for (auto id = row + hx; id < row + hx + blk.x; id++) {
+          T pred;
+          if (hz)
+            pred = q[id - 1] + q[id - sy] + q[id - sz] - q[id - 1 - sy] -
+                   q[id - 1 - sz] - q[id - sy - sz] + q[id - 1 - sy - sz];
+          else if (hy)
+            pred = q[id - 1] + q[id - sy] - q[id - 1 - sy];
+          else
+            pred = q[id - 1];
+          auto delta = q[id] - pred;
+
+          if (delta > -radius and delta < radius)
+            t.freq[(int)delta + radius]++;
+          else
+            t.freq[0]++, t.noutlier++;  // as the kernel marks outliers
+
+          double err = (double)src[id] - (T)(q[id] * ebx2);
+          t.sum_err2 += err * err;
+        }
+      }
+  });
+}
+
+template <typename T>
+pszestimate psz::sampler<T>::spline(double const eb, int const radius) const
+{
+  constexpr u4 ANCHOR = 8;
+  T const ebx2_r = 1 / (eb * 2), ebx2 = eb * 2;
+  u4 const hx = 1, hy = blk.y > 1, hz = blk.z > 1;
+  // the block and its high faces, as the kernel's 33x9x9 for 32x8x8
+  u4 const ex = blk.x, ey = hy ? blk.y : 0, ez = hz ? blk.z : 0;
+  auto const sy = (size_t)loc.x, sz = sy * loc.y;
+  auto const o = hz * sz + hy * sy + hx;
+
+  return evaluate(radius, [&](T const* src, T* r, tally& t) {
+    auto id = [&](u4 x, u4 y, u4 z) { return o + z * sz + y * sy + x; };
+    auto inner = [&](u4 x, u4 y, u4 z) {
+      return x < blk.x and y < blk.y and z < blk.z;
+    };
+
+    for (u4 z = 0; z <= ez; z += ANCHOR)
+      for (u4 y = 0; y <= ey; y += ANCHOR)
+        for (u4 x = 0; x <= ex; x += ANCHOR) {
+          r[id(x, y, z)] = src[id(x, y, z)];
+          if (inner(x, y, z)) t.nanchor++;
+        }
+
+    // one point; `d` is the stride to its neighbors along the axis
+    auto run = [&](u4 x, u4 y, u4 z, u4 c, u4 e, size_t d, u4 unit) {
+      auto i = id(x, y, z);
+      auto hi = c + unit <= e ? r[i + unit * d] : r[i - unit * d];
+      T pred = (r[i - unit * d] + hi) / 2;
+
+      auto err = src[i] - pred;
+      auto code = std::round(err * ebx2_r);
+      auto outlier = not(code > -radius and code < radius);
+      r[i] = outlier ? src[i] : (T)(pred + code * ebx2);
+
+      if (not inner(x, y, z)) return;
+      if (outlier)
+        t.freq[0]++, t.noutlier++;
+      else
+        t.freq[(int)code + radius]++;
+      double e2 = (double)src[i] - r[i];
+      t.sum_err2 += e2 * e2;
+    };
+
+    for (u4 unit = ANCHOR / 2; unit >= 1; unit /= 2) {
+      // along z, x, then y
+      for (u4 z = unit; z <= ez; z += 2 * unit)
+        for (u4 y = 0; y <= ey; y += 2 * unit)
+          for (u4 x = 0; x <= ex; x += 2 * unit) run(x, y, z, z, ez, sz, unit);
+      for (u4 z = 0; z <= ez; z += unit)
+        for (u4 y = 0; y <= ey; y += 2 * unit)
+          for (u4 x = unit; x <= ex; x += 2 * unit)
+            run(x, y, z, x, ex, 1, unit);
+      for (u4 z = 0; z <= ez; z += unit)
+        for (u4 y = unit; y <= ey; y += 2 * unit)
+          for (u4 x = 0; x <= ex; x += unit) run(x, y, z, y, ey, sy, unit);
+    }
+  });
+}
+
+template <typename T>
+pszestimate psz::sampler<T>::finish(tally& t) const
+{
+  pszestimate est{};
+  auto n = len();
+  if (n == 0) return est;
+
+  auto ncode = n - t.nanchor;
+  for (auto f : t.freq)
+    if (f) est.entropy -= 1.0 * f / ncode * std::log2(1.0 * f / ncode);
+
+  // outliers keep their values and indices aside, and anchors their values
+  est.outlier = 1.0 * t.noutlier / n;
+  est.bitrate =
+      (detail::hf_avg_bits(t.freq, ncode, est.entropy) * ncode +
+       t.noutlier * (sizeof(T) + sizeof(u4)) * 8 + t.nanchor * sizeof(T) * 8) /
+      n;
+  est.cr = sizeof(T) * 8 / est.bitrate;
+
+  auto mse = t.sum_err2 / n;
+  est.psnr = mse == 0 ? std::numeric_limits<double>::infinity()
+                      : 20 * log10(range()) - 10 * log10(mse);
+  return est;
+}
+
+template <typename T>
+double psz::autotune_eb(
+    T const* in, psz_dim3 const len3, int const radius,
+    double const target_cr, double const target_psnr, pszestimate* est,
+    float* time)
+{
+  auto a = hires::now();
+
+  if ((target_cr > 0) == (target_psnr > 0))
+    throw std::runtime_error(
+        "[psz::error::autotune] Specify either a target CR or a target "
+        "PSNR.");
+
+  sampler<T> s(in, len3);
+  auto rng = s.range() > 0 ? s.range() : 1.0;
+
+  // CR grows with eb and PSNR drops; keep the bound that meets the target
+  auto by_cr = target_cr > 0;
+  auto meets = [&](double eb) {
+    auto e = s.lorenzo(eb, radius);
+    return by_cr ? e.cr >= target_cr : e.psnr >= target_psnr;
+  };
+
+  double lo = rng * 1e-9, hi = rng * 0.5, eb;
+  if (by_cr and not meets(hi))
+    eb = hi;  // out of reach; the closest
+  else if (not by_cr and not meets(lo))
+    eb = lo;
+  else {
+    for (auto i = 0; i < 40 and hi / lo > 1.01; i++) {
+      auto mid = std::sqrt(lo * hi);
+      (meets(mid) == by_cr ? hi : lo) = mid;
+    }
+    eb = by_cr ? hi : lo;
+  }
+
+  if (est) *est = s.lorenzo(eb, radius);
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+
+  return eb;
+}
+
+template <typename T>
+void psz::estimate(
+    T const* in, psz_dim3 const len3, double const eb, int const radius,
+    pszestimate* lorenzo, pszestimate* spline, float* time)
+{
+  auto a = hires::now();
+
+  sampler<T> s(in, len3);
+  if (lorenzo) *lorenzo = s.lorenzo(eb, radius);
+  if (spline) *spline = s.spline(eb, radius);
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+pszpredictor_type psz::select_predictor(
+    T const* in, psz_dim3 const len3, double const eb, int const radius,
+    pszestimate* lorenzo, pszestimate* spline, float* time)
+{
+  // spline3d is slower; it has to be clearly better to be chosen
+  constexpr auto SPLINE_MIN_GAIN = 1.02;
+
+  pszestimate l, sp;
+  estimate<T>(in, len3, eb, radius, &l, &sp, time);
+  if (lorenzo) *lorenzo = l;
+  if (spline) *spline = sp;
+
+  auto is_3d = len3.y > 1 and len3.z > 1;
+  return is_3d and sp.cr > l.cr * SPLINE_MIN_GAIN ? Spline : Lorenzo;
+}
+
+#define SPECIALIZE_ESTIMATE(T)                                            \
+  template class psz::sampler<T>;                                         \
+  template double psz::autotune_eb<T>(                                    \
+      T const* in, psz_dim3 const len3, int const radius,                 \
+      double const target_cr, double const target_psnr,                   \
+      pszestimate* est, float* time);                                     \
+  template void psz::estimate<T>(                                         \
+      T const* in, psz_dim3 const len3, double const eb, int const radius, \
+      pszestimate* lorenzo, pszestimate* spline, float* time);            \
+  template pszpredictor_type psz::select_predictor<T>(                    \
+      T const* in, psz_dim3 const len3, double const eb, int const radius, \
+      pszestimate* lorenzo, pszestimate* spline, float* time);
+
+SPECIALIZE_ESTIMATE(f4);
+SPECIALIZE_ESTIMATE(f8);
+
+#undef SPECIALIZE_ESTIMATE
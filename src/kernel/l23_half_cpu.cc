@@ -0,0 +1,140 @@
+/**
+ * @file l23_half_cpu.cc
+ * @author Jiannan Tian
+ * @brief Lorenzo predictor for FP16/BF16 input (CPU).
+ * @version 0.4
+ * @date 2023-09-19
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/l23_half.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "detail/l23_modular.inl"
+#include "utils/half_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+template <typename T>
+struct l23_half_quantizer {
+  // prequantized in 32 bits, as the FP32 it is computed in; a delta wider
+  // than T is kept in two outliers
+  using U = u4;
+
+  static constexpr size_t BLK = 256;
+  static constexpr f4 QMAX = 1 << 30;
+
+  f8 eb;
+  f4 ebx2, ebx2_r;
+
+  l23_half_quantizer(f8 const _eb)
+      : eb(_eb), ebx2(_eb * 2), ebx2_r(1 / (_eb * 2))
+  {
+    if (not(_eb > 0))
+      throw std::runtime_error("[psz::error::l23_half] eb must be positive.");
+  }
+
+  void quantize(T const* in, U* q, size_t n, std::vector<u4>* raw) const
+  {
+    f4 x[BLK], y[BLK];
+    T yt[BLK];
+
+    for (size_t i = 0; i < n; i += BLK) {
+      auto m = std::min(BLK, n - i);
+      psz::cpu::to_f4(in + i, x, m);
+
+      for (size_t j = 0; j < m; j++) {
+        auto v = std::round(x[j] * ebx2_r);
+        v = v > QMAX ? QMAX : (v >= -QMAX ? v : -QMAX);  // incl. NaN
+        q[i + j] = (U)(i4)v;
+        y[j] = v * ebx2;
+      }
+      if (not raw) continue;
+
+      // the exact reconstruction on decompression
+      psz::cpu::from_f4(y, yt, m);
+      psz::cpu::to_f4(yt, y, m);
+      for (size_t j = 0; j < m; j++)
+        if (not(std::fabs((f8)y[j] - x[j]) <= eb)) raw->push_back(i + j);
+    }
+  }
+
+  void dequantize(U const* q, T* out, size_t n) const
+  {
+    f4 y[BLK];
+
+    for (size_t i = 0; i < n; i += BLK) {
+      auto m = std::min(BLK, n - i);
+      for (size_t j = 0; j < m; j++) y[j] = (f4)(i4)q[i + j] * ebx2;
+      psz::cpu::from_f4(y, out + i, m);
+    }
+  }
+};
+
+template <typename T, typename E>
+void l23_half_construct_cpu(
+    T* data, psz_dim3 const len3, f8 const eb, int const radius, E* eq,
+    T* outlier_val, u4* outlier_idx, size_t* num_outlier,
+    size_t const max_outlier, float* time)
+{
+  auto a = hires::now();
+
+  l23_mod_construct<T, E>(
+      data, len3, radius, eq, outlier_val, outlier_idx, num_outlier,
+      max_outlier, l23_half_quantizer<T>(eb));
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T, typename E>
+void l23_half_reconstruct_cpu(
+    E* eq, T* outlier_val, u4* outlier_idx, size_t const num_outlier,
+    psz_dim3 const len3, f8 const eb, int const radius, T* xdata, float* time)
+{
+  auto a = hires::now();
+
+  l23_mod_reconstruct<T, E>(
+      eq, outlier_val, outlier_idx, num_outlier, len3, radius, xdata,
+      l23_half_quantizer<T>(eb));
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_L23_HALF(T, E)                                          \
+  template <>                                                              \
+  void psz::l23_half_construct<T, E>(                                      \
+      T * data, psz_dim3 const len3, f8 const eb, int const radius, E* eq, \
+      T* outlier_val, u4* outlier_idx, size_t* num_outlier,                \
+      size_t const max_outlier, float* time)                               \
+  {                                                                        \
+    psz::detail::l23_half_construct_cpu<T, E>(                             \
+        data, len3, eb, radius, eq, outlier_val, outlier_idx, num_outlier, \
+        max_outlier, time);                                                \
+  }                                                                        \
+                                                                           \
+  template <>                                                              \
+  void psz::l23_half_reconstruct<T, E>(                                    \
+      E * eq, T * outlier_val, u4 * outlier_idx, size_t const num_outlier, \
+      psz_dim3 const len3, f8 const eb, int const radius, T* xdata,        \
+      float* time)                                                         \
+  {                                                                        \
+    psz::detail::l23_half_reconstruct_cpu<T, E>(                           \
+        eq, outlier_val, outlier_idx, num_outlier, len3, eb, radius,       \
+        xdata, time);                                                      \
+  }
+
+SPECIALIZE_L23_HALF(f2, u4);
+SPECIALIZE_L23_HALF(bf2, u4);
+
+#undef SPECIALIZE_L23_HALF
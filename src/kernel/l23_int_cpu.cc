@@ -0,0 +1,135 @@
+/**
+ * @file l23_int_cpu.cc
+ * @author Jiannan Tian
+ * @brief Lorenzo predictor for integer input (CPU).
+ * @version 0.4
+ * @date 2023-09-18
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/l23_int.hh"
+
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "cusz/suint.hh"
+#include "detail/l23_modular.inl"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+template <typename T>
+struct l23_int_quantizer {
+  // modular arithmetic of the input width
+  using U = typename psz::typing::UInt<sizeof(T)>::T;
+  // wide enough for (de)quantization of T
+  using W = typename std::conditional<std::is_signed<T>::value, i8, u8>::type;
+
+  W w, k;
+
+  l23_int_quantizer(u8 const eb)
+  {
+    if (eb > (u8)(std::numeric_limits<W>::max() - 1) / 2)
+      throw std::runtime_error("[psz::error::l23_int] eb is too large.");
+    w = 2 * (W)eb + 1, k = (W)eb;
+  }
+
+  void quantize(T const* in, U* q, size_t n, std::vector<u4>*) const
+  {
+    for (size_t i = 0; i < n; i++) {
+      W _q = (W)in[i] / w, r = (W)in[i] % w;
+      if (r > k) _q++;
+      if (std::is_signed<T>::value and r < -k) _q--;
+      q[i] = (U)(T)_q;
+    }
+  }
+
+  void dequantize(U const* q, T* out, size_t n) const
+  {
+    constexpr auto tmax = (W)std::numeric_limits<T>::max();
+    constexpr auto tmin = (W)std::numeric_limits<T>::min();
+
+    for (size_t i = 0; i < n; i++) {
+      auto _q = (W)(T)q[i];
+      // |q * w - x| <= eb; saturation only gets closer to x
+      if (_q > tmax / w)
+        out[i] = (T)tmax;
+      else if (_q < tmin / w)
+        out[i] = (T)tmin;
+      else
+        out[i] = (T)(_q * w);
+    }
+  }
+};
+
+template <typename T, typename E>
+void l23_int_construct_cpu(
+    T* data, psz_dim3 const len3, u8 const eb, int const radius, E* eq,
+    T* outlier_val, u4* outlier_idx, size_t* num_outlier,
+    size_t const max_outlier, float* time)
+{
+  auto a = hires::now();
+
+  l23_mod_construct<T, E>(
+      data, len3, radius, eq, outlier_val, outlier_idx, num_outlier,
+      max_outlier, l23_int_quantizer<T>(eb));
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T, typename E>
+void l23_int_reconstruct_cpu(
+    E* eq, T* outlier_val, u4* outlier_idx, size_t const num_outlier,
+    psz_dim3 const len3, u8 const eb, int const radius, T* xdata, float* time)
+{
+  auto a = hires::now();
+
+  l23_mod_reconstruct<T, E>(
+      eq, outlier_val, outlier_idx, num_outlier, len3, radius, xdata,
+      l23_int_quantizer<T>(eb));
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_L23_INT(T, E)                                           \
+  template <>                                                              \
+  void psz::l23_int_construct<T, E>(                                       \
+      T * data, psz_dim3 const len3, u8 const eb, int const radius, E* eq, \
+      T* outlier_val, u4* outlier_idx, size_t* num_outlier,                \
+      size_t const max_outlier, float* time)                               \
+  {                                                                        \
+    psz::detail::l23_int_construct_cpu<T, E>(                              \
+        data, len3, eb, radius, eq, outlier_val, outlier_idx, num_outlier, \
+        max_outlier, time);                                                \
+  }                                                                        \
+                                                                           \
+  template <>                                                              \
+  void psz::l23_int_reconstruct<T, E>(                                     \
+      E * eq, T * outlier_val, u4 * outlier_idx, size_t const num_outlier, \
+      psz_dim3 const len3, u8 const eb, int const radius, T* xdata,        \
+      float* time)                                                         \
+  {                                                                        \
+    psz::detail::l23_int_reconstruct_cpu<T, E>(                            \
+        eq, outlier_val, outlier_idx, num_outlier, len3, eb, radius,       \
+        xdata, time);                                                      \
+  }
+
+SPECIALIZE_L23_INT(u1, u4);
+SPECIALIZE_L23_INT(u2, u4);
+SPECIALIZE_L23_INT(u4, u4);
+SPECIALIZE_L23_INT(u8, u4);
+SPECIALIZE_L23_INT(i1, u4);
+SPECIALIZE_L23_INT(i2, u4);
+SPECIALIZE_L23_INT(i4, u4);
+SPECIALIZE_L23_INT(i8, u4);
+
+#undef SPECIALIZE_L23_INT
@@ -0,0 +1,170 @@
+/**
+ * @file logtr_cpu.cc
+ * @author Jiannan Tian
+ * @brief Log transform for the point-wise relative error bound (CPU).
+ * @version 0.4
+ * @date 2023-09-20
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/logtr.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+// in bytes of bitmap, so that no two threads write the same byte
+constexpr size_t LOG_SUBLEN = 1 << 12;
+
+template <typename F>
+void log_for_each_chunk(size_t const len, F&& f)
+{
+  auto nbyte = log_bitmap_bytes(len);
+  auto nchunk = (nbyte - 1) / LOG_SUBLEN + 1;
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * LOG_SUBLEN * 8;
+    auto end = std::min(start + LOG_SUBLEN * 8, len);
+    f(c, start, end);
+  });
+}
+
+template <typename T>
+void log_transform_cpu(
+    T* in, T* out, size_t const len, u1* sign, u1* zero, bool* has_sign,
+    bool* has_zero, f8* ymax, float* time)
+{
+  auto a = hires::now();
+
+  auto nchunk = (log_bitmap_bytes(len) - 1) / LOG_SUBLEN + 1;
+  std::vector<f8> _ymin(nchunk, std::numeric_limits<f8>::max());
+  std::vector<f8> _ymax(nchunk, std::numeric_limits<f8>::lowest());
+  std::vector<u1> _sign(nchunk, 0), _zero(nchunk, 0), _finite(nchunk, 1);
+
+  log_for_each_chunk(len, [&](size_t c, size_t start, size_t end) {
+    f8 lo = _ymin[c], hi = _ymax[c];
+    u1 s_any = 0, z_any = 0, finite = 1;
+
+    for (auto i = start; i < end; i += 8) {
+      u1 s_byte = 0, z_byte = 0;
+      for (auto j = i; j < std::min(i + 8, end); j++) {
+        f8 x = in[j];
+        u1 s = x < 0, z = x == 0;
+        finite &= std::isfinite(x);
+        f8 y = z ? 0 : std::log2(std::fabs(x));
+        if (not z) lo = std::min(lo, y), hi = std::max(hi, y);
+        out[j] = y;
+        s_byte |= s << (j - i), z_byte |= z << (j - i);
+      }
+      sign[i / 8] = s_byte, zero[i / 8] = z_byte;
+      s_any |= s_byte, z_any |= z_byte;
+    }
+
+    _ymin[c] = lo, _ymax[c] = hi;
+    _sign[c] = s_any != 0, _zero[c] = z_any != 0, _finite[c] = finite;
+  });
+
+  if (std::find(_finite.begin(), _finite.end(), 0) != _finite.end())
+    throw std::runtime_error(
+        "[psz::error::log_transform] Input must be finite.");
+
+  auto lo = *std::min_element(_ymin.begin(), _ymin.end());
+  auto hi = *std::max_element(_ymax.begin(), _ymax.end());
+  if (lo > hi) lo = hi = 0;  // all zeros
+
+  *has_sign = std::find(_sign.begin(), _sign.end(), 1) != _sign.end();
+  *has_zero = std::find(_zero.begin(), _zero.end(), 1) != _zero.end();
+  *ymax = std::max(std::fabs(lo), std::fabs(hi));
+
+  if (*has_zero)
+    log_for_each_chunk(len, [&](size_t, size_t start, size_t end) {
+      for (auto i = start; i < end; i++)
+        if ((zero[i / 8] >> (i % 8)) & 1) out[i] = lo;
+    });
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void log_inverse_cpu(
+    T* in, T* out, size_t const len, u1 const* sign, u1 const* zero,
+    float* time)
+{
+  auto a = hires::now();
+
+  log_for_each_chunk(len, [&](size_t, size_t start, size_t end) {
+    for (auto i = start; i < end; i++) {
+      f8 x = std::exp2((f8)in[i]);
+      if (sign and ((sign[i / 8] >> (i % 8)) & 1)) x = -x;
+      if (zero and ((zero[i / 8] >> (i % 8)) & 1)) x = 0;
+      out[i] = x;
+    }
+  });
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+f8 log_transform_eb_cpu(f8 const pwrel, f8 const ymax)
+{
+  if (not(pwrel > 0 and pwrel < 1))
+    throw std::runtime_error(
+        "[psz::error::log_transform] Point-wise relative eb must be in "
+        "(0, 1).");
+
+  // |x' / x| in [1 / (1 + pwrel), 1 + pwrel], within 1 -/+ pwrel; the margin
+  // covers storing y in T, prequantizing and reconstructing y in T, and
+  // rounding x' to T.
+  constexpr f8 eps = std::numeric_limits<T>::epsilon();
+  auto eb = std::log2(1 + pwrel) - (4 * ymax + 2) * eps;
+
+  if (not(eb > 0))
+    throw std::runtime_error(
+        "[psz::error::log_transform] Point-wise relative eb is too tight "
+        "for the input precision.");
+  return eb;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_LOG_CPU(T)                                               \
+  template <>                                                               \
+  void psz::log_transform<T>(                                               \
+      T * in, T * out, size_t const len, u1 * sign, u1 * zero,              \
+      bool* has_sign, bool* has_zero, f8* ymax, float* time)                \
+  {                                                                         \
+    psz::detail::log_transform_cpu<T>(                                      \
+        in, out, len, sign, zero, has_sign, has_zero, ymax, time);          \
+  }                                                                         \
+                                                                            \
+  template <>                                                               \
+  void psz::log_inverse<T>(                                                 \
+      T * in, T * out, size_t const len, u1 const* sign, u1 const* zero,    \
+      float* time)                                                          \
+  {                                                                         \
+    psz::detail::log_inverse_cpu<T>(in, out, len, sign, zero, time);        \
+  }                                                                         \
+                                                                            \
+  template <>                                                               \
+  f8 psz::log_transform_eb<T>(f8 const pwrel, f8 const ymax)                \
+  {                                                                         \
+    return psz::detail::log_transform_eb_cpu<T>(pwrel, ymax);               \
+  }
+
+SPECIALIZE_LOG_CPU(f4);
+SPECIALIZE_LOG_CPU(f8);
+
+#undef SPECIALIZE_LOG_CPU
@@ -0,0 +1,90 @@
+/**
+ * @file prog_cpu.cc
+ * @author Jiannan Tian
+ * @brief Residual and accumulation between progressive layers (CPU).
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/prog.hh"
+
+#include <algorithm>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+constexpr size_t PROG_SUBLEN = 1 << 16;
+
+template <typename F>
+void prog_for_each_chunk(size_t const len, F&& f)
+{
+  auto nchunk = (len + PROG_SUBLEN - 1) / PROG_SUBLEN;
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto end = std::min((c + 1) * PROG_SUBLEN, len);
+    for (auto i = c * PROG_SUBLEN; i < end; i++) f(i);
+  });
+}
+
+template <typename T>
+void prog_residual_cpu(
+    T const* x, f8 const* xr, T* r, size_t const len, float* time)
+{
+  auto a = hires::now();
+  prog_for_each_chunk(len, [&](size_t i) { r[i] = x[i] - xr[i]; });
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void prog_accumulate_cpu(f8* xr, T const* r, size_t const len, float* time)
+{
+  auto a = hires::now();
+  prog_for_each_chunk(len, [&](size_t i) { xr[i] += r[i]; });
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void prog_round_cpu(f8 const* xr, T* x, size_t const len, float* time)
+{
+  auto a = hires::now();
+  prog_for_each_chunk(len, [&](size_t i) { x[i] = xr[i]; });
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_PROG_CPU(T)                                           \
+  template <>                                                            \
+  void psz::prog_residual<T>(                                            \
+      T const* x, f8 const* xr, T* r, size_t const len, float* time)     \
+  {                                                                      \
+    psz::detail::prog_residual_cpu<T>(x, xr, r, len, time);              \
+  }                                                                      \
+                                                                         \
+  template <>                                                            \
+  void psz::prog_accumulate<T>(                                          \
+      f8 * xr, T const* r, size_t const len, float* time)                \
+  {                                                                      \
+    psz::detail::prog_accumulate_cpu<T>(xr, r, len, time);               \
+  }                                                                      \
+                                                                         \
+  template <>                                                            \
+  void psz::prog_round<T>(                                               \
+      f8 const* xr, T* x, size_t const len, float* time)                 \
+  {                                                                      \
+    psz::detail::prog_round_cpu<T>(xr, x, len, time);                    \
+  }
+
+SPECIALIZE_PROG_CPU(f4);
+SPECIALIZE_PROG_CPU(f8);
+
+#undef SPECIALIZE_PROG_CPU
@@ -0,0 +1,187 @@
+/**
+ * @file rle_cpu.cc
+ * @author Jiannan Tian
+ * @brief Run-length codec for quant-codes (CPU).
+ * @version 0.4
+ * @date 2023-09-14
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/rle.hh"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+constexpr size_t RLE_MIN_SUBLEN = 1 << 14;
+
+// Chunks are independent: a run never crosses a chunk boundary.
+inline size_t rle_sublen(size_t const len)
+{
+  auto npart = 4 * (size_t)psz::cpu::nthread();
+  return std::max((len - 1) / npart + 1, RLE_MIN_SUBLEN);
+}
+
+// Walk runs in `in[0, len)` and call `emit(i, value, length)` for run i.
+template <typename T, typename F>
+size_t rle_walk(T* in, size_t const len, F&& emit)
+{
+  if (len == 0) return 0;
+
+  size_t n = 0;
+  T prev = in[0];
+  u4 run = 1;
+
+  for (size_t i = 1; i < len; i++) {
+    if (in[i] == prev and run < RLE_MAX_RUN) { run++; }
+    else {
+      emit(n++, prev, run);
+      prev = in[i], run = 1;
+    }
+  }
+  emit(n++, prev, run);
+
+  return n;
+}
+
+template <typename T>
+void rle_count_cpu(T* in, size_t const inlen, size_t* nrun, float* time)
+{
+  auto a = hires::now();
+  *nrun = 0;
+  if (inlen == 0) return;
+
+  auto sublen = rle_sublen(inlen);
+  auto nchunk = (inlen - 1) / sublen + 1;
+  std::vector<size_t> count(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * sublen;
+    auto n = std::min(sublen, inlen - start);
+    count[c] = rle_walk(in + start, n, [](size_t, T, u4) {});
+  });
+
+  *nrun = std::accumulate(count.begin(), count.end(), (size_t)0);
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void rle_encode_cpu(
+    T* in, size_t const inlen, T* out_val, u2* out_len, size_t* nrun,
+    float* time)
+{
+  auto a = hires::now();
+  *nrun = 0;
+  if (inlen == 0) return;
+
+  auto sublen = rle_sublen(inlen);
+  auto nchunk = (inlen - 1) / sublen + 1;
+  std::vector<size_t> offset(nchunk + 1, 0);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * sublen;
+    auto n = std::min(sublen, inlen - start);
+    offset[c + 1] = rle_walk(in + start, n, [](size_t, T, u4) {});
+  });
+
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * sublen;
+    auto n = std::min(sublen, inlen - start);
+    auto val = out_val + offset[c];
+    auto len = out_len + offset[c];
+    rle_walk(in + start, n, [&](size_t i, T v, u4 run) {
+      val[i] = v, len[i] = run;
+    });
+  });
+
+  *nrun = offset[nchunk];
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void rle_decode_cpu(
+    T* in_val, u2* in_len, size_t const nrun, T* out, size_t const outlen,
+    float* time)
+{
+  auto a = hires::now();
+  if (nrun == 0 and outlen == 0) return;
+  if (nrun == 0)
+    throw std::runtime_error("[psz::error::rle] no run to decode.");
+
+  // partition the runs; the output offsets come from a prefix sum
+  auto sublen = rle_sublen(nrun);
+  auto nchunk = (nrun - 1) / sublen + 1;
+  std::vector<size_t> offset(nchunk + 1, 0);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * sublen;
+    auto end = std::min(start + sublen, nrun);
+    offset[c + 1] =
+        std::accumulate(in_len + start, in_len + end, (size_t)0);
+  });
+
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  if (offset[nchunk] != outlen)
+    throw std::runtime_error(
+        "[psz::error::rle] run lengths do not sum up to the output length.");
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * sublen;
+    auto end = std::min(start + sublen, nrun);
+    auto dst = out + offset[c];
+    for (auto i = start; i < end; i++)
+      dst = std::fill_n(dst, in_len[i], in_val[i]);
+  });
+
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+}  // namespace detail
+}  // namespace psz
+
+#define SPECIALIZE_RLE_CPU(T)                                                \
+  template <>                                                                \
+  void psz::rle_count<pszpolicy::CPU, T>(                                    \
+      T * in, size_t const inlen, size_t* nrun, float* time)                 \
+  {                                                                          \
+    psz::detail::rle_count_cpu<T>(in, inlen, nrun, time);                    \
+  }                                                                          \
+                                                                             \
+  template <>                                                                \
+  void psz::rle_encode<pszpolicy::CPU, T>(                                   \
+      T * in, size_t const inlen, T* out_val, u2* out_len, size_t* nrun,     \
+      float* time)                                                           \
+  {                                                                          \
+    psz::detail::rle_encode_cpu<T>(in, inlen, out_val, out_len, nrun, time); \
+  }                                                                          \
+                                                                             \
+  template <>                                                                \
+  void psz::rle_decode<pszpolicy::CPU, T>(                                   \
+      T * in_val, u2 * in_len, size_t const nrun, T* out,                    \
+      size_t const outlen, float* time)                                      \
+  {                                                                          \
+    psz::detail::rle_decode_cpu<T>(in_val, in_len, nrun, out, outlen, time); \
+  }
+
+SPECIALIZE_RLE_CPU(u1);
+SPECIALIZE_RLE_CPU(u2);
+SPECIALIZE_RLE_CPU(u4);
+
+#undef SPECIALIZE_RLE_CPU
@@ -0,0 +1,490 @@
+/**
+ * @file tile_cpu.cc
+ * @author Jiannan Tian
+ * @brief Tiled host pipeline of Lorenzo, histogram and ANS, as tasks on the
+ * work-stealing scheduler (CPU), and its C API.
+ * @version 0.4
+ * @date 2023-09-29
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "kernel/tile.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ans/ans.hh"
+#include "cusz.h"
+#include "cusz/suint.hh"
+#include "detail/l23_modular.inl"
+#include "kernel/hist.hh"
+#include "kernel/l23_int.hh"
+#include "typing.hh"
+
+namespace psz {
+namespace detail {
+
+using tile_eq = u4;
+
+char const tile_magic[8] = "PSZTIL1";
+
+// FP32/FP64 prequantized to the signed integers of the same width, for
+// Lorenzo in modular arithmetic; a value is kept as is when its
+// reconstruction would break `eb` (incl. NaN, inf, and out of range).
+template <typename T>
+struct tile_float_quantizer {
+  using U = typename psz::typing::UInt<sizeof(T)>::T;
+  using S = typename std::make_signed<U>::type;
+
+  static constexpr T QMAX = (T)((U)1 << (8 * sizeof(T) - 2));
+
+  f8 eb;
+  T ebx2, ebx2_r;
+
+  tile_float_quantizer(f8 const _eb)
+      : eb(_eb), ebx2(_eb * 2), ebx2_r(1 / (_eb * 2))
+  {
+    if (not(_eb > 0))
+      throw std::runtime_error("[psz::error::tile] eb must be positive.");
+  }
+
+  void quantize(T const* in, U* q, size_t n, std::vector<u4>* raw) const
+  {
+    for (size_t i = 0; i < n; i++) {
+      auto v = std::round(in[i] * ebx2_r);
+      v = v > QMAX ? QMAX : (v >= -QMAX ? v : -QMAX);  // incl. NaN
+      q[i] = (U)(S)v;
+      if (raw and not(std::fabs((f8)(v * ebx2) - in[i]) <= eb))
+        raw->push_back(i);
+    }
+  }
+
+  void dequantize(U const* q, T* out, size_t n) const
+  {
+    for (size_t i = 0; i < n; i++) out[i] = (T)(S)q[i] * ebx2;
+  }
+};
+
+// tag dispatch on std::is_integral<T>
+template <typename T, typename E>
+void tile_construct(
+    std::true_type, T* data, psz_dim3 const len3, f8 const eb,
+    int const radius, E* eq, T* oval, u4* oidx, size_t* nout, size_t n)
+{
+  float time;
+  l23_int_construct<T, E>(
+      data, len3, (u8)eb, radius, eq, oval, oidx, nout, n, &time);
+}
+
+template <typename T, typename E>
+void tile_construct(
+    std::false_type, T* data, psz_dim3 const len3, f8 const eb,
+    int const radius, E* eq, T* oval, u4* oidx, size_t* nout, size_t n)
+{
+  l23_mod_construct<T, E>(
+      data, len3, radius, eq, oval, oidx, nout, n,
+      tile_float_quantizer<T>(eb));
+}
+
+template <typename T, typename E>
+void tile_reconstruct(
+    std::true_type, E* eq, T* oval, u4* oidx, size_t nout,
+    psz_dim3 const len3, f8 const eb, int const radius, T* xdata)
+{
+  float time;
+  l23_int_reconstruct<T, E>(
+      eq, oval, oidx, nout, len3, (u8)eb, radius, xdata, &time);
+}
+
+template <typename T, typename E>
+void tile_reconstruct(
+    std::false_type, E* eq, T* oval, u4* oidx, size_t nout,
+    psz_dim3 const len3, f8 const eb, int const radius, T* xdata)
+{
+  l23_mod_reconstruct<T, E>(
+      eq, oval, oidx, nout, len3, radius, xdata, tile_float_quantizer<T>(eb));
+}
+
+// the common head of an archive, ahead of the type-specific part
+struct tile_head {
+  char magic[8];
+  u4 dtype;
+  psz_dim3 len3;
+};
+
+// The tiles along the slowest axis that is longer than 1.
+struct tiling {
+  psz_dim3 len3;
+  size_t plane, n_axis;
+  u4 tile;
+
+  tiling(psz_dim3 const len3, u4 const tile) : len3(len3), tile(tile)
+  {
+    if (tile == 0)
+      throw std::runtime_error("[psz::error::tile] tile must be positive.");
+    if (len3.z > 1)
+      plane = (size_t)len3.x * len3.y, n_axis = len3.z;
+    else if (len3.y > 1)
+      plane = len3.x, n_axis = len3.y;
+    else
+      plane = 1, n_axis = len3.x;
+  }
+
+  size_t size() const { return (n_axis - 1) / tile + 1; }
+  size_t offset(size_t i) const { return i * tile * plane; }
+
+  psz_dim3 len3_of(size_t i) const
+  {
+    auto n = (u4)std::min<size_t>(tile, n_axis - i * tile);
+    if (len3.z > 1) return {len3.x, len3.y, n};
+    if (len3.y > 1) return {len3.x, n, 1};
+    return {n, 1, 1};
+  }
+
+  // contiguous blocks of tiles, as a static partition over `nworker`
+  int hint(size_t i, int nworker) const { return i * nworker / size(); }
+};
+
+inline size_t len_of(psz_dim3 l) { return (size_t)l.x * l.y * l.z; }
+
+}  // namespace detail
+}  // namespace psz
+
+template <typename T>
+size_t psz::tile_archive<T>::bytes() const
+{
+  auto b = sizeof(u4) * freq.size();
+  for (auto& t : tiles)
+    b += sizeof(T) * t.outlier_val.size() +
+         sizeof(u4) * t.outlier_idx.size() + t.ans.size();
+  return b;
+}
+
+template <typename T>
+void psz::tile_archive<T>::to_bytes(std::vector<u1>& out) const
+{
+  detail::tile_head head;
+  memcpy(head.magic, detail::tile_magic, sizeof(head.magic));
+  head.dtype = PszType<T>::type, head.len3 = len3;
+
+  out.clear();
+  auto put = [&](void const* p, size_t n) {
+    out.insert(out.end(), (u1 const*)p, (u1 const*)p + n);
+  };
+  u4 nfreq = freq.size(), ntile = tiles.size();
+  put(&head, sizeof(head));
+  put(&tile_size, sizeof(tile_size)), put(&eb, sizeof(eb));
+  put(&radius, sizeof(radius));
+  put(&nfreq, sizeof(nfreq)), put(&ntile, sizeof(ntile));
+  put(freq.data(), sizeof(u4) * nfreq);
+  for (auto& t : tiles) {
+    u8 nout = t.outlier_val.size(), nans = t.ans.size();
+    put(&t.len3, sizeof(t.len3));
+    put(&nout, sizeof(nout)), put(&nans, sizeof(nans));
+    put(t.outlier_val.data(), sizeof(T) * nout);
+    put(t.outlier_idx.data(), sizeof(u4) * nout);
+    put(t.ans.data(), nans);
+  }
+}
+
+template <typename T>
+void psz::tile_archive<T>::from_bytes(u1 const* in, size_t const len)
+{
+  size_t at = 0;
+  auto get = [&](void* p, size_t n) {
+    if (n > len - at)
+      throw std::runtime_error("[psz::error::tile] Truncated archive.");
+    memcpy(p, in + at, n), at += n;
+  };
+
+  detail::tile_head head;
+  get(&head, sizeof(head));
+  if (memcmp(head.magic, detail::tile_magic, sizeof(head.magic)))
+    throw std::runtime_error("[psz::error::tile] Not a tiled archive.");
+  if (head.dtype != (u4)PszType<T>::type)
+    throw std::runtime_error("[psz::error::tile] Type mismatch.");
+
+  u4 nfreq, ntile;
+  len3 = head.len3;
+  get(&tile_size, sizeof(tile_size)), get(&eb, sizeof(eb));
+  get(&radius, sizeof(radius));
+  get(&nfreq, sizeof(nfreq)), get(&ntile, sizeof(ntile));
+  if (nfreq != 2u * radius or ntile != detail::tiling(len3, tile_size).size())
+    throw std::runtime_error("[psz::error::tile] Malformed archive.");
+  freq.resize(nfreq);
+  get(freq.data(), sizeof(u4) * nfreq);
+
+  tiles.assign(ntile, {});
+  for (auto& t : tiles) {
+    u8 nout, nans;
+    get(&t.len3, sizeof(t.len3));
+    get(&nout, sizeof(nout)), get(&nans, sizeof(nans));
+    if (nout > detail::len_of(t.len3) or nans > len)
+      throw std::runtime_error("[psz::error::tile] Malformed archive.");
+    t.outlier_val.resize(nout), t.outlier_idx.resize(nout);
+    t.ans.resize(nans);
+    get(t.outlier_val.data(), sizeof(T) * nout);
+    get(t.outlier_idx.data(), sizeof(u4) * nout);
+    get(t.ans.data(), nans);
+  }
+}
+
+template <typename T>
+psz::cpu::sched_report psz::tile_compress(
+    T* data, psz_dim3 const len3, f8 const eb, int const radius,
+    u4 const tile, tile_archive<T>& out, int nworker, bool const steal)
+{
+  using E = detail::tile_eq;
+  detail::tiling tl(len3, tile);
+  auto const ntile = tl.size();
+  auto const bklen = 2 * radius;
+  if (nworker <= 0) nworker = cpu::nthread();
+
+  out.len3 = len3, out.tile_size = tile, out.eb = eb, out.radius = radius;
+  out.freq.assign(bklen, 0);
+  out.tiles.assign(ntile, {});
+
+  std::vector<std::vector<E>> eq(ntile);
+  std::vector<std::vector<u4>> hist(ntile);
+
+  cpu::task_graph g;
+  std::vector<cpu::task_graph::id> hists;
+
+  for (size_t i = 0; i < ntile; i++) {
+    auto hint = tl.hint(i, nworker);
+    auto predict = g.add(
+        [&, i] {
+          auto& t = out.tiles[i];
+          t.len3 = tl.len3_of(i);
+          auto n = detail::len_of(t.len3);
+          eq[i].resize(n), t.outlier_val.resize(n), t.outlier_idx.resize(n);
+
+          size_t nout;
+          detail::tile_construct<T, E>(
+              std::is_integral<T>{}, data + tl.offset(i), t.len3, eb, radius,
+              eq[i].data(), t.outlier_val.data(), t.outlier_idx.data(),
+              &nout, n);
+          t.outlier_val.resize(nout), t.outlier_val.shrink_to_fit();
+          t.outlier_idx.resize(nout), t.outlier_idx.shrink_to_fit();
+        },
+        {}, hint);
+
+    hists.push_back(g.add(
+        [&, i] {
+          float time;
+          hist[i].assign(bklen, 0);
+          psz::histogram<CPU, E>(
+              eq[i].data(), eq[i].size(), hist[i].data(), bklen, &time);
+        },
+        {predict}, hint));
+  }
+
+  auto reduce = g.add(
+      [&] {
+        for (auto& h : hist)
+          for (auto k = 0; k < bklen; k++) out.freq[k] += h[k];
+      },
+      hists);
+
+  for (size_t i = 0; i < ntile; i++) {
+    g.add(
+        [&, i] {
+          auto n = eq[i].size();
+          auto& ans = out.tiles[i].ans;
+          ans.resize(ans_encoded_bound(n, bklen, n));
+
+          size_t outlen;
+          float time;
+          ans_encode<CPU, E>(
+              eq[i].data(), n, out.freq.data(), bklen, n, ans.data(), &outlen,
+              &time);
+          ans.resize(outlen), ans.shrink_to_fit();
+          std::vector<E>().swap(eq[i]);
+        },
+        {reduce}, tl.hint(i, nworker));
+  }
+
+  return g.run(nworker, steal);
+}
+
+template <typename T>
+psz::cpu::sched_report psz::tile_decompress(
+    tile_archive<T> const& in, T* xdata, int nworker, bool const steal)
+{
+  using E = detail::tile_eq;
+  detail::tiling tl(in.len3, in.tile_size);
+  auto const ntile = in.tiles.size();
+  if (nworker <= 0) nworker = cpu::nthread();
+
+  std::vector<std::vector<E>> eq(ntile);
+  cpu::task_graph g;
+
+  for (size_t i = 0; i < ntile; i++) {
+    auto hint = tl.hint(i, nworker);
+    auto decode = g.add(
+        [&, i] {
+          float time;
+          eq[i].resize(detail::len_of(in.tiles[i].len3));
+          ans_decode<CPU, E>(
+              const_cast<u1*>(in.tiles[i].ans.data()), eq[i].data(), &time);
+        },
+        {}, hint);
+
+    g.add(
+        [&, i] {
+          auto& t = in.tiles[i];
+          detail::tile_reconstruct<T, E>(
+              std::is_integral<T>{}, eq[i].data(),
+              const_cast<T*>(t.outlier_val.data()),
+              const_cast<u4*>(t.outlier_idx.data()), t.outlier_val.size(),
+              t.len3, in.eb, in.radius, xdata + tl.offset(i));
+          std::vector<E>().swap(eq[i]);
+        },
+        {decode}, hint);
+  }
+
+  return g.run(nworker, steal);
+}
+
+#define SPECIALIZE_TILE(T)                                                  \
+  template struct psz::tile_archive<T>;                                     \
+  template psz::cpu::sched_report psz::tile_compress<T>(                    \
+      T*, psz_dim3 const, f8 const, int const, u4 const, tile_archive<T>&, \
+      int, bool const);                                                     \
+  template psz::cpu::sched_report psz::tile_decompress<T>(                  \
+      tile_archive<T> const&, T*, int, bool const);
+
+SPECIALIZE_TILE(u1);
+SPECIALIZE_TILE(u2);
+SPECIALIZE_TILE(u4);
+SPECIALIZE_TILE(i1);
+SPECIALIZE_TILE(i2);
+SPECIALIZE_TILE(i4);
+SPECIALIZE_TILE(f4);
+SPECIALIZE_TILE(f8);
+
+#undef SPECIALIZE_TILE
+
+namespace {
+
+// Call `f` with a null pointer of the concrete input type.
+template <typename F>
+pszerror tile_dispatch(pszdtype type, F&& f)
+{
+  // clang-format off
+  switch (type) {
+    case U1: f((u1*)nullptr); break;
+    case U2: f((u2*)nullptr); break;
+    case U4: f((u4*)nullptr); break;
+    case I1: f((i1*)nullptr); break;
+    case I2: f((i2*)nullptr); break;
+    case I4: f((i4*)nullptr); break;
+    case F4: f((f4*)nullptr); break;
+    case F8: f((f8*)nullptr); break;
+    default: return CUSZ_FAIL_UNSUPPORTED_DATATYPE;
+  }
+  // clang-format on
+  return CUSZ_SUCCESS;
+}
+
+// Run `f` as a C API call: what it throws is reported and returned as `err`.
+template <typename F>
+pszerror tile_guard(pszerror const err, F&& f)
+{
+  try {
+    return f();
+  }
+  catch (std::exception const& e) {
+    fprintf(stderr, "%s\n", e.what());
+    return err;
+  }
+}
+
+void tile_report(psz::cpu::sched_report const& r, psz_sched_report* out)
+{
+  if (not out) return;
+  *out = {r.wall_ms, 0, 0, r.nworker(), 0, 0};
+  for (auto w = 0; w < r.nworker(); w++) {
+    out->busy_ms += r.busy_ms[w];
+    out->max_busy_ms = std::max(out->max_busy_ms, r.busy_ms[w]);
+    out->ntask += r.ntask[w], out->nsteal += r.nsteal[w];
+  }
+}
+
+bool tile_head_of(
+    uint8_t const* archive, size_t const bytes, psz::detail::tile_head* head)
+{
+  if (bytes < sizeof(*head) or
+      memcmp(archive, psz::detail::tile_magic, sizeof(head->magic)))
+    return false;
+  memcpy(head, archive, sizeof(*head));
+  return true;
+}
+
+}  // namespace
+
+pszerror psz_tile_compress(
+    void* data, pszdtype const type, pszlen const len, double const eb,
+    int const radius, uint32_t const tile, int const nworker,
+    uint8_t** archive, size_t* bytes, psz_sched_report* report)
+{
+  return tile_guard(CUSZ_FAIL_UNSUPPORTED_PIPELINE, [&] {
+    return tile_dispatch(type, [&](auto* _) {
+      using T = typename std::remove_pointer<decltype(_)>::type;
+
+      psz::tile_archive<T> a;
+      psz_dim3 const len3{(u4)len.x, (u4)len.y, (u4)len.z};
+      tile_report(
+          psz::tile_compress<T>((T*)data, len3, eb, radius, tile, a, nworker),
+          report);
+
+      std::vector<u1> out;
+      a.to_bytes(out);
+      auto p = (uint8_t*)malloc(out.size());
+      if (not p)
+        throw std::runtime_error("[psz::error::tile] Out of host memory.");
+      memcpy(p, out.data(), out.size());
+      *archive = p, *bytes = out.size();
+    });
+  });
+}
+
+pszerror psz_tile_info(
+    uint8_t const* archive, size_t const bytes, pszdtype* type, pszlen* len)
+{
+  psz::detail::tile_head head;
+  if (not tile_head_of(archive, bytes, &head)) {
+    fprintf(stderr, "[psz::error::tile] Not a tiled archive.\n");
+    return CUSZ_FAIL_UNSUPPORTED_FORMAT;
+  }
+
+  *type = (pszdtype)head.dtype;
+  *len = {head.len3.x, head.len3.y, head.len3.z, 1};
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_tile_decompress(
+    uint8_t const* archive, size_t const bytes, void* out, int const nworker,
+    psz_sched_report* report)
+{
+  pszdtype type;
+  pszlen len;
+  if (auto err = psz_tile_info(archive, bytes, &type, &len)) return err;
+
+  return tile_guard(CUSZ_FAIL_UNSUPPORTED_FORMAT, [&] {
+    return tile_dispatch(type, [&](auto* _) {
+      using T = typename std::remove_pointer<decltype(_)>::type;
+
+      psz::tile_archive<T> a;
+      a.from_bytes(archive, bytes);
+      tile_report(psz::tile_decompress<T>(a, (T*)out, nworker), report);
+    });
+  });
+}
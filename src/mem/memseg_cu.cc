@@ -13,6 +13,7 @@
 
 #include "busyheader.hh"
 #include "mem/memseg.h"
+#include "utils/par_cpu.hh"
 #include "utils/err.hh"
 
 void pszmem_malloc_cuda(pszmem* m)
@@ -40,17 +41,25 @@ void pszmem_mallochost_cuda(pszmem* m)
     throw std::runtime_error(
         string(m->name) + ": cannot malloc borrowed hptr.");
 
-  if (m->h == nullptr) {
-    if (not m->isaview)
-      CHECK_GPU(cudaMallocHost(&m->h, m->bytes));
-    else
-      throw std::runtime_error(
-          string(m->name) + ": forbidden to malloc a view.");
+  if (m->isaview)
+    throw std::runtime_error(
+        string(m->name) + ": forbidden to malloc a view.");
+  if (m->h != nullptr)
+    throw std::runtime_error(string(m->name) + ": hptr already malloc'ed.");
+
+  if (psz::cpu::numa_touch()) {
+    // first touch by the (pinned) workers places the pages, and then they
+    // are page-locked where they are
+    if (posix_memalign(&m->h, psz::cpu::page_bytes(), m->bytes))
+      throw std::runtime_error(string(m->name) + ": hptr malloc failed.");
+    psz::cpu::first_touch(m->h, m->bytes);
+    CHECK_GPU(cudaHostRegister(m->h, m->bytes, cudaHostRegisterDefault));
+    m->h_registered = true;
   }
   else {
-    throw std::runtime_error(string(m->name) + ": hptr already malloc'ed.");
+    CHECK_GPU(cudaMallocHost(&m->h, m->bytes));
+    memset(m->h, 0x0, m->bytes);
   }
-  memset(m->h, 0x0, m->bytes);
 }
 
 void pszmem_cleardevice_cuda(pszmem* m)
@@ -97,7 +106,12 @@ void pszmem_freehost_cuda(pszmem* m)
     throw std::runtime_error(string(m->name) + ": cannot free borrowed hptr.");
 
   if (m->h) {
-    if (not m->isaview)
+    if (not m->isaview and m->h_registered) {
+      CHECK_GPU(cudaHostUnregister(m->h));
+      free(m->h);
+      m->h_registered = false;
+    }
+    else if (not m->isaview)
       CHECK_GPU(cudaFreeHost(m->h));
     else
       throw std::runtime_error(
@@ -13,6 +13,7 @@
 
 #include "busyheader.hh"
 #include "mem/memseg.h"
+#include "utils/par_cpu.hh"
 
 void pszmem_malloc_hip(pszmem* m)
 {
@@ -39,17 +40,25 @@ void pszmem_mallochost_hip(pszmem* m)
     throw std::runtime_error(
         string(m->name) + ": cannot malloc borrowed hptr.");
 
-  if (m->h == nullptr) {
-    if (not m->isaview)
-      hipHostMalloc(&m->h, m->bytes);
-    else
-      throw std::runtime_error(
-          string(m->name) + ": forbidden to malloc a view.");
+  if (m->isaview)
+    throw std::runtime_error(
+        string(m->name) + ": forbidden to malloc a view.");
+  if (m->h != nullptr)
+    throw std::runtime_error(string(m->name) + ": hptr already malloc'ed.");
+
+  if (psz::cpu::numa_touch()) {
+    // first touch by the (pinned) workers places the pages, and then they
+    // are page-locked where they are
+    if (posix_memalign(&m->h, psz::cpu::page_bytes(), m->bytes))
+      throw std::runtime_error(string(m->name) + ": hptr malloc failed.");
+    psz::cpu::first_touch(m->h, m->bytes);
+    hipHostRegister(m->h, m->bytes, hipHostRegisterDefault);
+    m->h_registered = true;
   }
   else {
-    throw std::runtime_error(string(m->name) + ": hptr already malloc'ed.");
+    hipHostMalloc(&m->h, m->bytes);
+    memset(m->h, 0x0, m->bytes);
   }
-  memset(m->h, 0x0, m->bytes);
 }
 
 void pszmem_cleardevice_hip(pszmem* m) { hipMemset(m->d, 0x0, m->bytes); }
@@ -93,7 +102,12 @@ void pszmem_freehost_hip(pszmem* m)
     throw std::runtime_error(string(m->name) + ": cannot free borrowed hptr.");
 
   if (m->h) {
-    if (not m->isaview)
+    if (not m->isaview and m->h_registered) {
+      hipHostUnregister(m->h);
+      free(m->h);
+      m->h_registered = false;
+    }
+    else if (not m->isaview)
       hipHostFree(m->h);
     else
       throw std::runtime_error(
@@ -12,6 +12,8 @@
 #ifndef CLI_CUH
 #define CLI_CUH
 
+#include <fstream>
+
 #include "busyheader.hh"
 #include "cusz.h"
 #include "cusz/type.h"
@@ -20,10 +22,14 @@
 //
 #include "context.h"
 #include "dryrun.hh"
+#include "kernel/dryrun.hh"
+#include "kernel/estimate.hh"
 #include "mem.hh"
+#include "stat/compare_stream.hh"
 #include "tehm.hh"
 #include "utils/analyzer.hh"
 #include "utils/err.hh"
+#include "utils/numa_cpu.hh"
 #include "utils/query.hh"
 #include "utils/viewer.hh"
 
@@ -82,6 +88,55 @@ class CLI {
     GpuStreamDestroy(stream);
   }
 
+  // The round trip and the quality assessment in one pass on host; no device
+  // buffer is involved.
+  template <typename T>
+  static void do_dryrun_cpu(pszctx* ctx)
+  {
+    auto len = (size_t)ctx->x * ctx->y * ctx->z;
+    auto eb = ctx->eb;
+    auto original = new T[len];
+    T res[4];
+    psz::load_with_extrema<T>(ctx->infile, original, len, res);
+    if (ctx->mode == Rel) eb *= res[3];
+
+    cusz_stats stat;
+    float time;
+    psz::dryrun_assess<T>(original, len, eb, &stat, &time);
+    printf("\n(dryrun on CPU, %.3f ms)\n", time);
+    psz::print_metrics_cross<T>(&stat, 0, false);
+
+    delete[] original;
+  }
+
+  // Both files are streamed slab by slab; neither is loaded as a whole.
+  template <typename T>
+  static void do_compare(pszctx* ctx)
+  {
+    auto report = [](size_t start, cusz_stats const& s) {
+      printf(
+          "  slab @%-14zu len %-12zu PSNR %12.6g  NRMSE %12.6g  max-error "
+          "%12.6g @%zu\n",
+          start, s.len, s.score.PSNR, s.score.NRMSE, s.max_err.abs,
+          s.max_err.idx);
+    };
+
+    cusz_stats stat;
+    printf("\n(streamed comparison, per slab)\n");
+    psz::stream_assess_quality<T>(
+        &stat, ctx->infile, ctx->original_file, psz::STREAM_SLAB_BYTES,
+        report);
+    psz::print_metrics_cross<T>(&stat, 0, false);
+  }
+
+  static bool gpu_present()
+  {
+    int n = 0;
+    auto err = GpuGetDeviceCount(&n);
+    if (err != GpuSuccess) GpuGetLastError();  // not to linger
+    return err == GpuSuccess and n > 0;
+  }
+
  private:
   void write_compressed_to_disk(
       std::string compressed_name, uint8_t* compressed, size_t compressed_len)
@@ -105,15 +160,46 @@ class CLI {
     size_t compressed_len;
     pszheader header;
 
-    input->control({MallocHost, Malloc})
-        ->file(ctx->infile, FromFile)
-        ->control({H2D});
+    // relative eb: the range is taken as the file is loaded
+    auto autotune = ctx->target_cr > 0 or ctx->target_psnr > 0;
+    double rng = 0;
+    input->control({MallocHost, Malloc});
+    if (ctx->mode == Rel and not autotune) {
+      T res[4];
+      psz::load_with_extrema<T>(
+          ctx->infile, input->hptr(), input->m->len, res);
+      rng = res[3];
+    }
+    else
+      input->file(ctx->infile, FromFile);
+    input->control({H2D});
+
+    // adjust eb, in the settings of this run; `ctx` is kept as given
+    auto run = *ctx;
+    if (autotune) {
+      pszestimate est;
+      float time;
+      run.eb = psz::autotune_eb<T>(
+          input->hptr(), psz_dim3{run.x, run.y, run.z}, run.radius,
+          run.target_cr, run.target_psnr, &est, &time);
+      run.mode = Abs;
+      printf(
+          "\n(autotuned) eb = %g, est. CR = %.3f, est. PSNR = %.2f dB "
+          "(%.3f ms)\n",
+          run.eb, est.cr, est.psnr, time);
+    }
+    else if (run.mode == Rel) {
+      run.eb *= rng;
+    }
 
-    // adjust eb
-    if (ctx->mode == Rel) {
-      double _1, _2, rng;
-      input->extrema_scan(_1, _2, rng);
-      ctx->eb *= rng;
+    if (run.use_auto_pred) {
+      auto abs = run;  // `eb` is scaled already
+      abs.mode = Abs;
+      psz_select_predictor(&abs, input->hptr());
+      run.pred_type = abs.pred_type;
+      printf(
+          "\n(auto) predictor = %s\n",
+          run.pred_type == Spline ? "spline3d" : "lorenzo");
     }
 
     TimeRecord timerecord;
@@ -125,7 +211,7 @@ class CLI {
     //     .est_cr = ctx->report_cr_est};
     pszlen uncomp_len = pszlen{ctx->x, ctx->y, ctx->z, 1};
 
-    psz_compress_init(compressor, uncomp_len, ctx);
+    psz_compress_init(compressor, uncomp_len, &run);
 
     psz_compress(
         compressor, input->dptr(), uncomp_len, &compressed, &compressed_len,
@@ -150,13 +236,31 @@ class CLI {
 
     // all lengths in metadata
     auto compressed_len = psz_utils::filesize(ctx->infile);
+    size_t offset = 0;
+
+    // the preview is an archive of its own; only that segment is read
+    if (ctx->use_preview) {
+      cusz_header h;
+      std::ifstream archive(ctx->infile, std::ios::binary);
+      archive.read(reinterpret_cast<char*>(&h), sizeof(cusz_header));
+      offset = h.entry[cusz_header::PREVIEW];
+      compressed_len = h.entry[cusz_header::PREVIEW + 1] - offset;
+      if (compressed_len == 0)
+        throw std::runtime_error("[psz::error] No preview in the archive.");
+    }
 
     auto compressed =
         new pszmem_cxx<uint8_t>(compressed_len, 1, 1, "compressed");
 
-    compressed->control({MallocHost, Malloc})
-        ->file(ctx->infile, FromFile)
-        ->control({H2D});
+    compressed->control({MallocHost, Malloc});
+    if (ctx->use_preview) {
+      std::ifstream archive(ctx->infile, std::ios::binary);
+      archive.seekg(offset);
+      archive.read((char*)compressed->hptr(), compressed_len);
+    }
+    else
+      compressed->file(ctx->infile, FromFile);
+    compressed->control({H2D});
 
     auto header = new cusz_header;
     memcpy(header, compressed->hptr(), sizeof(cusz_header));
@@ -179,11 +283,16 @@ class CLI {
     if (ctx->report_time)
       TimeRecordViewer::view_decompression(
           &timerecord, decompressed->m->bytes);
-    psz::view(header, decompressed, original, ctx->original_file);
+    if (not ctx->use_preview)
+      psz::view(
+          header, decompressed, original, ctx->original_file,
+          ctx->report_spatial);
 
     if (not ctx->skip_tofile)
       decompressed->control({D2H})->file(
-          std::string(basename + ".cuszx").c_str(), ToFile);
+          std::string(basename + (ctx->use_preview ? ".cuszp" : ".cuszx"))
+              .c_str(),
+          ToFile);
 
     // decompressed->control({FreeHost, Free});
     delete decompressed;
@@ -197,14 +306,27 @@ class CLI {
     // TODO disable predictor selection; to specify in another way
     // auto predictor = ctx->predictor;
 
+    // for the host workers and host buffers of this run, incl. its
+    // compressor, initialized from `ctx`
+    psz::cpu::placement_scope place(ctx->cpu_pin, ctx->use_numa_touch);
+
+    // dryrun runs alone (see context); on a GPU-less node, it runs on host
+    if (ctx->task_dryrun and (ctx->use_cpu_dryrun or not gpu_present())) {
+      do_dryrun_cpu<T>(ctx);
+      return;
+    }
+    if (ctx->task_compare) {
+      do_compare<T>(ctx);
+      return;
+    }
+
     cusz_framework* framework = pszdefault_framework();
-    cusz_compressor* compressor = cusz_create(framework, F4);
+    cusz_compressor* compressor = cusz_create(framework, PszType<T>::type);
 
     GpuStreamT stream;
     CHECK_GPU(GpuStreamCreate(&stream));
 
-    // TODO enable f8
-    if (ctx->task_dryrun) do_dryrun<float>(ctx);
+    if (ctx->task_dryrun) do_dryrun<T>(ctx);
     if (ctx->task_construct) do_construct(ctx, compressor, stream);
     if (ctx->task_reconstruct) do_reconstruct(ctx, compressor, stream);
 
@@ -212,6 +334,23 @@ class CLI {
   }
 };
 
+// The input type of reconstruction is from the archive, not from `-t`.
+inline pszdtype cli_dtype(pszctx* ctx)
+{
+  if (ctx->task_construct or ctx->task_dryrun or ctx->task_compare)
+    return ctx->dtype;
+
+  cusz_header header;
+  std::ifstream archive(ctx->infile, std::ios::binary);
+  archive.read(reinterpret_cast<char*>(&header), sizeof(cusz_header));
+  if (not archive or not header.known())
+    throw std::runtime_error(
+        "[psz::error] " + std::string(ctx->infile) +
+        " is not an archive, or of an unknown format version.");
+
+  return header.dtype == F8 ? F8 : F4;
+}
+
 }  // namespace cusz
 
 #endif
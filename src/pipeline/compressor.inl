@@ -14,16 +14,25 @@
 #ifndef A2519F0E_602B_4798_A8EF_9641123095D9
 #define A2519F0E_602B_4798_A8EF_9641123095D9
 
+#include "ans/ans.hh"
 #include "busyheader.hh"
 #include "compressor.hh"
 #include "cusz/type.h"
 #include "header.h"
 #include "hf/hf.hh"
 #include "kernel.hh"
+#include "kernel/binning.hh"
+#include "kernel/hist.hh"
+#include "kernel/l23_half.hh"
+#include "kernel/l23_int.hh"
+#include "kernel/logtr.hh"
+#include "kernel/prog.hh"
+#include "kernel/rle.hh"
 #include "mem.hh"
 #include "port.hh"
 #include "utils/config.hh"
 #include "utils/err.hh"
+#include "utils/timer.hh"
 
 #define PRINT_ENTRY(VAR)                                    \
   printf(                                                   \
@@ -31,12 +40,323 @@
       header.entry[cusz_header::VAR]);
 
 namespace cusz {
+namespace detail {
+
+// Lorenzo runs on GPU for FP32/FP64 input, and on host for integer and
+// half-precision input, whose quant-codes and outliers go back to device as
+// if from `psz_comp_l23r`.
+struct lrz_gpu {};
+struct lrz_int {};
+struct lrz_half {};
+
+template <typename T>
+struct lrz_path {
+  using type = typename std::conditional<
+      std::is_integral<T>::value, lrz_int, lrz_gpu>::type;
+};
+template <>
+struct lrz_path<f2> {
+  using type = lrz_half;
+};
+template <>
+struct lrz_path<bf2> {
+  using type = lrz_half;
+};
+
+template <typename T>
+using spl_unsupported =
+    std::integral_constant<bool, not std::is_floating_point<T>::value>;
+
+template <typename T, typename E, typename FP, typename Mem>
+void lrz_construct(
+    lrz_gpu, T* in, dim3 len3, double eb, int radius, Mem* mem, float* time,
+    void* stream)
+{
+  // `psz_comp_l23r` with compaction in place of `psz_comp_l23` (no `r`)
+  psz_comp_l23r<T, E>(
+      in, len3, eb, radius, mem->ectrl_lrz(), (void*)mem->compact, time,
+      stream);
+}
+
+template <typename T, typename E, typename Mem, typename Kernel>
+void lrz_construct_host(T* in, Mem* mem, void* stream, Kernel&& kernel)
+{
+  auto len = mem->len;
+  auto compact = mem->compact;
+  size_t num;
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(mem->oc->hptr(), in, sizeof(T) * len, GpuMemcpyD2H));
+
+  kernel(
+      mem->oc->hptr(), mem->el->hptr(), compact->h_val, compact->h_idx, &num,
+      compact->reserved_len);
+
+  compact->h_num = num;
+  CHECK_GPU(GpuMemcpy(
+      mem->ectrl_lrz(), mem->el->hptr(), sizeof(E) * len, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      compact->d_val, compact->h_val, sizeof(T) * num, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      compact->d_idx, compact->h_idx, sizeof(u4) * num, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      compact->d_num, &compact->h_num, sizeof(u4), GpuMemcpyH2D));
+}
+
+// exact; `eb` is truncated to an integer, and 0 is lossless
+template <typename T, typename E, typename FP, typename Mem>
+void lrz_construct(
+    lrz_int, T* in, dim3 len3, double eb, int radius, Mem* mem, float* time,
+    void* stream)
+{
+  lrz_construct_host<T, E>(
+      in, mem, stream,
+      [&](T* data, E* eq, T* val, u4* idx, size_t* num, size_t max) {
+        psz::l23_int_construct<T, E>(
+            data, psz_dim3{len3.x, len3.y, len3.z}, (u8)eb, radius, eq, val,
+            idx, num, max, time);
+      });
+}
+
+template <typename T, typename E, typename FP, typename Mem>
+void lrz_construct(
+    lrz_half, T* in, dim3 len3, double eb, int radius, Mem* mem, float* time,
+    void* stream)
+{
+  lrz_construct_host<T, E>(
+      in, mem, stream,
+      [&](T* data, E* eq, T* val, u4* idx, size_t* num, size_t max) {
+        psz::l23_half_construct<T, E>(
+            data, psz_dim3{len3.x, len3.y, len3.z}, eb, radius, eq, val, idx,
+            num, max, time);
+      });
+}
+
+template <typename T, typename E, typename FP, typename M, typename Mem>
+void lrz_reconstruct(
+    lrz_gpu, T* d_spval, M* d_spidx, int splen, dim3 len3, double eb,
+    int radius, T* d_xdata, Mem* mem, float* time_sp, float* time,
+    void* stream)
+{
+  // outliers are scattered in place of the reconstructed data
+  psz::spv_scatter<PROPER_GPU_BACKEND, T, M>(
+      d_spval, d_spidx, splen, d_xdata, time_sp, stream);
+  psz_decomp_l23<T, E, FP>(
+      mem->ectrl_lrz(), len3, d_xdata, eb, radius, d_xdata, time, stream);
+}
+
+template <typename T, typename E, typename M, typename Mem, typename Kernel>
+void lrz_reconstruct_host(
+    T* d_spval, M* d_spidx, int splen, T* d_xdata, Mem* mem, void* stream,
+    Kernel&& kernel)
+{
+  auto len = mem->len;
+  auto compact = mem->compact;
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(
+      mem->el->hptr(), mem->ectrl_lrz(), sizeof(E) * len, GpuMemcpyD2H));
+  CHECK_GPU(GpuMemcpy(
+      compact->h_val, d_spval, sizeof(T) * splen, GpuMemcpyD2H));
+  CHECK_GPU(GpuMemcpy(
+      compact->h_idx, d_spidx, sizeof(M) * splen, GpuMemcpyD2H));
+
+  kernel(mem->el->hptr(), compact->h_val, compact->h_idx, mem->oc->hptr());
+
+  CHECK_GPU(GpuMemcpy(
+      d_xdata, mem->oc->hptr(), sizeof(T) * len, GpuMemcpyH2D));
+}
+
+template <typename T, typename E, typename FP, typename M, typename Mem>
+void lrz_reconstruct(
+    lrz_int, T* d_spval, M* d_spidx, int splen, dim3 len3, double eb,
+    int radius, T* d_xdata, Mem* mem, float* time_sp, float* time,
+    void* stream)
+{
+  *time_sp = 0;
+  lrz_reconstruct_host<T, E>(
+      d_spval, d_spidx, splen, d_xdata, mem, stream,
+      [&](E* eq, T* val, u4* idx, T* xdata) {
+        psz::l23_int_reconstruct<T, E>(
+            eq, val, idx, splen, psz_dim3{len3.x, len3.y, len3.z}, (u8)eb,
+            radius, xdata, time);
+      });
+}
+
+template <typename T, typename E, typename FP, typename M, typename Mem>
+void lrz_reconstruct(
+    lrz_half, T* d_spval, M* d_spidx, int splen, dim3 len3, double eb,
+    int radius, T* d_xdata, Mem* mem, float* time_sp, float* time,
+    void* stream)
+{
+  *time_sp = 0;
+  lrz_reconstruct_host<T, E>(
+      d_spval, d_spidx, splen, d_xdata, mem, stream,
+      [&](E* eq, T* val, u4* idx, T* xdata) {
+        psz::l23_half_reconstruct<T, E>(
+            eq, val, idx, splen, psz_dim3{len3.x, len3.y, len3.z}, eb,
+            radius, xdata, time);
+      });
+}
+
+template <typename T, typename E, typename Mem>
+void spl_construct(
+    std::false_type, double eb, int radius, Mem* mem, float* time,
+    void* stream)
+{
+  spline_construct(
+      mem->od, mem->ac, mem->es, /* placeholder */ (void*)mem->compact, eb,
+      radius, time, stream);
+}
+
+template <typename T, typename E, typename Mem>
+void spl_construct(std::true_type, double, int, Mem*, float*, void*)
+{
+  throw std::runtime_error(
+      "[psz::error] spline supports only FP32/FP64 input; use Lorenzo.");
+}
+
+template <typename T, typename E>
+void spl_reconstruct(
+    std::false_type, pszmem_cxx<T>* anchor, pszmem_cxx<E>* ectrl,
+    pszmem_cxx<T>* xdata, double eb, int radius, float* time, void* stream)
+{
+  spline_reconstruct(anchor, ectrl, xdata, eb, radius, time, stream);
+}
+
+template <typename T, typename E>
+void spl_reconstruct(
+    std::true_type, pszmem_cxx<T>*, pszmem_cxx<E>*, pszmem_cxx<T>*, double,
+    int, float*, void*)
+{
+  throw std::runtime_error(
+      "[psz::error] spline supports only FP32/FP64 input; use Lorenzo.");
+}
+
+// point-wise relative: the log transform is on host for FP32/FP64 only
+template <typename T>
+f8 log_forward(
+    std::true_type, T* data, szt len, u1* sign, u1* zero, bool* has_sign,
+    bool* has_zero, f8 pwrel, float* time)
+{
+  f8 ymax;
+  psz::log_transform<T>(
+      data, data, len, sign, zero, has_sign, has_zero, &ymax, time);
+  return psz::log_transform_eb<T>(pwrel, ymax);
+}
+
+template <typename T>
+f8 log_forward(std::false_type, T*, szt, u1*, u1*, bool*, bool*, f8, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] point-wise relative mode supports only FP32/FP64 "
+      "input.");
+}
+
+template <typename T>
+void log_backward(
+    std::true_type, T* data, szt len, u1 const* sign, u1 const* zero,
+    float* time)
+{
+  psz::log_inverse<T>(data, data, len, sign, zero, time);
+}
+
+template <typename T>
+void log_backward(std::false_type, T*, szt, u1 const*, u1 const*, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] point-wise relative mode supports only FP32/FP64 "
+      "input.");
+}
+
+template <typename T>
+void bin_forward(
+    std::true_type, T* in, psz_dim3 len3, int bx, int by, T* out,
+    float* time)
+{
+  psz::binning<T>(in, len3, bx, by, out, time);
+}
+
+template <typename T>
+void bin_forward(std::false_type, T*, psz_dim3, int, int, T*, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] binning supports only FP32/FP64 input.");
+}
+
+template <typename T>
+void prog_diff(
+    std::true_type, T const* x, f8 const* xr, T* r, szt len, float* time)
+{
+  psz::prog_residual<T>(x, xr, r, len, time);
+}
+
+template <typename T>
+void prog_diff(std::false_type, T const*, f8 const*, T*, szt, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] progressive layers support only FP32/FP64 input.");
+}
+
+template <typename T>
+void prog_add(std::true_type, f8* xr, T const* r, szt len, float* time)
+{
+  psz::prog_accumulate<T>(xr, r, len, time);
+}
+
+template <typename T>
+void prog_add(std::false_type, f8*, T const*, szt, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] progressive layers support only FP32/FP64 input.");
+}
+
+template <typename T>
+void prog_finish(std::true_type, f8 const* xr, T* x, szt len, float* time)
+{
+  psz::prog_round<T>(xr, x, len, time);
+}
+
+template <typename T>
+void prog_finish(std::false_type, f8 const*, T*, szt, float*)
+{
+  throw std::runtime_error(
+      "[psz::error] progressive layers support only FP32/FP64 input.");
+}
+
+// max - min on host, or 1 if flat; point-wise relative mode is FP-only
+template <typename T>
+f8 host_range(std::true_type, T const* x, szt len)
+{
+  f8 lo = x[0], hi = x[0];
+  for (szt i = 1; i < len; i++)
+    lo = std::min<f8>(lo, x[i]), hi = std::max<f8>(hi, x[i]);
+  return hi > lo ? hi - lo : 1;
+}
+
+template <typename T>
+f8 host_range(std::false_type, T const*, szt)
+{
+  return 1;
+}
+
+}  // namespace detail
 
 template <class C>
 Compressor<C>* Compressor<C>::destroy()
 {
   if (mem) delete mem;
   if (codec) delete codec;
+  if (ans_out) delete ans_out;
+  if (rle_val) delete rle_val;
+  if (rle_len) delete rle_len;
+  if (logmap) delete logmap;
+  if (bin) delete bin;
+  if (preview) delete preview;
+  if (layer) delete layer;
+  if (prog_rec) delete prog_rec;
+  if (prog_res) delete prog_res;
+  if (prog_out) delete prog_out;
 
   return this;
 }
@@ -73,42 +393,29 @@ Compressor<C>* Compressor<C>::init(CONFIG* config, bool debug)
   else
     codec->init(mem->len, booklen, pardeg, debug);
 
+  codec1_type = config->codec1_type;
+
+  if (codec1_type == Rans) {
+    auto elen = config->pred_type == pszpredictor_type::Spline  //
+                    ? mem->len_spl
+                    : mem->len;
+    ans_out = new pszmem_cxx<BYTE>(
+        psz::ans_encoded_bound(elen, booklen, psz::ANS_MIN_SUBLEN), 1, 1,
+        "ans::out");
+    ans_out->control({Malloc, MallocHost});
+  }
+
   return this;
 }
 
+// Prediction and quantization at `eb`, and the histogram of the quant-codes,
+// into the pool; what the codec then works on.
 template <class C>
-Compressor<C>* Compressor<C>::compress(
-    cusz_context* config, T* in, BYTE*& out, size_t& outlen, void* stream,
-    bool dbg_print)
+Compressor<C>* Compressor<C>::predict(
+    cusz_context* config, T* in, double const eb, void* stream)
 {
-  auto const eb = config->eb;
   auto const radius = config->radius;
-  auto const pardeg = config->vle_pardeg;
-
-  auto div = [](auto whole, auto part) { return (whole - 1) / part + 1; };
-
-  len3 = dim3(config->x, config->y, config->z);
-
-  BYTE* d_codec_out{nullptr};
-  size_t codec_outlen{0};
-
-  size_t data_len = config->x * config->y * config->z;
-  auto booklen = radius * 2;
-
-  auto sublen = div(data_len, pardeg);
-
-  auto update_header = [&]() {
-    header.x = len3.x, header.y = len3.y, header.z = len3.z,
-    header.w = 1;  // placeholder
-    header.radius = radius, header.eb = eb;
-    header.vle_pardeg = pardeg;
-    header.splen = splen;
-    header.pred_type = config->pred_type;
-    // header.byte_vle = use_fallback_codec ? 8 : 4;
-  };
-
-  /******************************************************************************/
-
+  auto const booklen = radius * 2;
   auto elen = config->pred_type == pszpredictor_type::Spline  //
                   ? mem->len_spl
                   : len;
@@ -116,21 +423,14 @@ Compressor<C>* Compressor<C>::compress(
   if (config->pred_type == pszpredictor_type::Spline) {
 #ifdef PSZ_USE_CUDA
     mem->od->dptr(in);
-    spline_construct(
-        mem->od, mem->ac, mem->es, /* placeholder */ (void*)mem->compact, eb,
-        radius, &time_pred, stream);
+    detail::spl_construct<T, E>(
+        detail::spl_unsupported<T>{}, eb, radius, mem, &time_pred, stream);
 
     // psz::histogram<PROPER_GPU_BACKEND, E>(
     //     mem->ectrl_spl(), elen, mem->hist(), booklen, &time_hist, stream);
     psz::histsp<PROPER_GPU_BACKEND, E>(
         mem->ectrl_spl(), elen, mem->hist(), booklen, &time_hist, stream);
 
-    codec->build_codebook(mem->ht, booklen, stream);
-
-    if (config->report_cr_est) codec->calculate_CR(mem->es);
-
-    codec->encode(mem->ectrl_spl(), elen, &d_codec_out, &codec_outlen, stream);
-
 #else
     throw runtime_error(
         "[psz::error] spline_construct only works for CUDA version "
@@ -138,9 +438,8 @@ Compressor<C>* Compressor<C>::compress(
 #endif
   }
   else {
-    // `psz_comp_l23r` with compaction in place of `psz_comp_l23` (no `r`)
-    psz_comp_l23r<T, E>(
-        in, len3, eb, radius, mem->ectrl_lrz(), (void*)mem->compact,
+    detail::lrz_construct<T, E, FP>(
+        typename detail::lrz_path<T>::type{}, in, len3, eb, radius, mem,
         &time_pred, stream);
 
     // `psz::histogram` is on for evaluating purpose,
@@ -156,14 +455,156 @@ Compressor<C>* Compressor<C>::compress(
             "used; fallback to the normal version"
          << endl;
 #endif
+  }
+
+  return this;
+}
+
+// The histogram (on host, of `2 * radius` bins) of what `compress` would
+// encode, for the partitions of a field to build one book from.
+template <class C>
+Compressor<C>* Compressor<C>::export_histogram(
+    cusz_context* config, T* in, u4* h_freq, void* stream)
+{
+  double eb = config->eb;
+  if (config->prog_layers > 1)
+    eb *= std::pow(config->prog_ratio, config->prog_layers - 1);
+
+  len3 = dim3(config->x, config->y, config->z);
+
+  logmap_bytes = 0;
+  if (config->mode == PwRel) log_encode(in, eb, stream);
+
+  predict(config, in, eb, stream);
+
+  // with RLE, of the run values, which is what `compress` then encodes
+  nrun = 0;
+  if (config->use_rle) {
+    auto const spline = config->pred_type == pszpredictor_type::Spline;
+    rle_encode(
+        spline ? mem->es : mem->el, spline ? mem->len_spl : len,
+        config->use_rle_force, stream);
+  }
+
+  CHECK_GPU(GpuMemcpyAsync(
+      h_freq, mem->hist(), sizeof(u4) * config->radius * 2, GpuMemcpyD2H,
+      (GpuStreamT)stream));
+  CHECK_GPU(GpuStreamSync(stream));
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::use_book(psz_book const* _book)
+{
+  book = _book;
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::compress(
+    cusz_context* config, T* in, BYTE*& out, size_t& outlen, void* stream,
+    bool dbg_print)
+{
+  double eb = config->eb;
+  auto const radius = config->radius;
+  auto const pardeg = config->vle_pardeg;
+
+  // progressive: the base layer is at the loosest eb
+  if (config->prog_layers > 1) {
+    if (config->mode == PwRel)
+      throw std::runtime_error(
+          "[psz::error] progressive layers do not support point-wise "
+          "relative mode.");
+    eb *= std::pow(config->prog_ratio, config->prog_layers - 1);
+  }
+
+  auto div = [](auto whole, auto part) { return (whole - 1) / part + 1; };
+
+  len3 = dim3(config->x, config->y, config->z);
+
+  BYTE* d_codec_out{nullptr};
+  size_t codec_outlen{0};
 
-    // Huffman encoding
+  size_t data_len = config->x * config->y * config->z;
+  auto booklen = radius * 2;
 
-    codec->build_codebook(mem->ht, booklen, stream);
+  auto sublen = div(data_len, pardeg);
+  auto const shared = book and config->codec1_type != Rans;
 
-    if (config->report_cr_est) codec->calculate_CR(mem->el);
+  auto update_header = [&]() {
+    header.magic = Header::MAGIC, header.version = Header::VERSION;
+    header.x = len3.x, header.y = len3.y, header.z = len3.z,
+    header.w = 1;  // placeholder
+    header.radius = radius, header.eb = eb;
+    header.vle_pardeg = pardeg;
+    header.splen = splen;
+    header.shared_book = shared ? book->id : 0;
+    header.pred_type = config->pred_type;
+    header.codec1_type = config->codec1_type;
+    header.dtype = PszType<T>::type;
+    header.mode = config->mode;
+    // header.byte_vle = use_fallback_codec ? 8 : 4;
+  };
+
+  /******************************************************************************/
 
-    codec->encode(mem->ectrl_lrz(), elen, &d_codec_out, &codec_outlen, stream);
+  // binned preview, from the input as is
+  BYTE* d_preview{nullptr};
+  preview_bytes = 0;
+  if (config->prep_binning)
+    preview_encode(config, in, &d_preview, stream);
+
+  // point-wise relative: compress y = log2|x| with the derived absolute eb
+  logmap_bytes = 0;
+  if (config->mode == PwRel) log_encode(in, eb, stream);
+
+  auto elen = config->pred_type == pszpredictor_type::Spline  //
+                  ? mem->len_spl
+                  : len;
+
+  // Huffman (GPU) by default; rANS (CPU) when specified
+  auto vle_encode = [&](pszmem_cxx<E>* ectrl) {
+    // optional run-length stage; the codec then works on the run values
+    nrun = 0;
+    if (config->use_rle)
+      rle_encode(ectrl, elen, config->use_rle_force, stream);
+    auto vle_len = nrun ? nrun : elen;
+    if (nrun) codec->clear_buffer();
+
+    // a shared book, if given, in place of one of this field's own
+    if (shared) {
+      mem->ht->control({D2H});
+      if (not psz::hf_book_covers(book, mem->ht->hptr()))
+        throw std::runtime_error(
+            "[psz::error] The shared book lacks codewords of this field; it "
+            "is to be built from the histograms of all partitions.");
+      codec->load_book(book, stream);
+    }
+    else if (config->codec1_type != Rans or config->report_cr_est) {
+      codec->load_book(nullptr);
+      codec->build_codebook(mem->ht, booklen, stream);
+    }
+
+    if (config->report_cr_est and not nrun and not shared)
+      codec->calculate_CR(ectrl, sizeof(T));
+
+    if (config->codec1_type == Rans)
+      ans_encode(ectrl, vle_len, &d_codec_out, &codec_outlen, stream);
+    else
+      codec->encode(
+          ectrl->dptr(), vle_len, &d_codec_out, &codec_outlen, stream);
+  };
+
+  predict(config, in, eb, stream);
+
+  if (config->pred_type == pszpredictor_type::Spline) {
+    vle_encode(mem->es);
+  }
+  else {
+    // Huffman/rANS encoding
+
+    vle_encode(mem->el);
 
     // count outliers (by far, already gathered in psz_comp_l23r)
     mem->compact->make_host_accessible((GpuStreamT)stream);
@@ -185,6 +626,9 @@ Compressor<C>* Compressor<C>::compress(
       mem->anchor(), mem->ac->len(),                                         //
       d_codec_out, codec_outlen,                                             //
       mem->compact_val(), mem->compact_idx(), mem->compact->num_outliers(),  //
+      nrun ? rle_len->dptr() : nullptr, nrun,                                //
+      logmap_bytes ? logmap->dptr() : nullptr, logmap_bytes,                 //
+      d_preview, preview_bytes,                                              //
       stream);
 
   // output
@@ -193,6 +637,8 @@ Compressor<C>* Compressor<C>::compress(
   mem->_compressed->m->bytes = outlen;
   out = mem->_compressed->dptr();
 
+  if (config->prog_layers > 1) prog_encode(config, in, out, outlen, stream);
+
   collect_comp_time();
 
   // TODO fallback handling
@@ -205,7 +651,8 @@ template <class C>
 Compressor<C>* Compressor<C>::merge_subfiles(
     pszpredictor_type pred_type, T* d_anchor, szt anchor_len,
     BYTE* d_codec_out, szt codec_outlen, T* d_spval, M* d_spidx, szt splen,
-    void* stream)
+    u2* d_runlen, szt nrun, BYTE* d_logmap, szt logmap_bytes,
+    BYTE* d_preview, szt preview_bytes, void* stream)
 {
   uint32_t nbyte[Header::END];
 
@@ -233,6 +680,10 @@ Compressor<C>* Compressor<C>::merge_subfiles(
     nbyte[Header::ANCHOR] = 0;
     nbyte[Header::SPFMT] = (sizeof(T) + sizeof(M)) * splen;
   }
+  nbyte[Header::RUNLEN] = sizeof(u2) * nrun;
+  nbyte[Header::LOGMAP] = logmap_bytes;
+  nbyte[Header::PREVIEW] = preview_bytes;
+  nbyte[Header::LAYERS] = 0;  // appended by `prog_encode`
 
   header.entry[0] = 0;
   // *.END + 1; need to know the ending position
@@ -266,11 +717,414 @@ Compressor<C>* Compressor<C>::merge_subfiles(
         GpuMemcpyD2D, (GpuStreamT)stream));
   }
 
+  if (nrun) concat_d2d(Header::RUNLEN, d_runlen, 0);
+  if (logmap_bytes) concat_d2d(Header::LOGMAP, d_logmap, 0);
+  if (preview_bytes) concat_d2d(Header::PREVIEW, d_preview, 0);
+
   /* debug */ CHECK_GPU(GpuStreamSync(stream));
 
   return this;
 }
 
+template <class C>
+Compressor<C>* Compressor<C>::ans_encode(
+    pszmem_cxx<E>* ectrl, szt len, BYTE** out, size_t* outlen, void* stream)
+{
+  auto hist = mem->ht;
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(
+      ectrl->hptr(), ectrl->dptr(), sizeof(E) * len, GpuMemcpyD2H));
+  CHECK_GPU(GpuMemcpy(
+      hist->hptr(), hist->dptr(), hist->bytes(), GpuMemcpyD2H));
+
+  psz::ans_encode<CPU, E>(
+      ectrl->hptr(), len, hist->hptr(), hist->len(),
+      psz::ans_tune_sublen(len), ans_out->hptr(), outlen, &time_ans);
+
+  CHECK_GPU(GpuMemcpyAsync(
+      ans_out->dptr(), ans_out->hptr(), *outlen, GpuMemcpyH2D,
+      (GpuStreamT)stream));
+  *out = ans_out->dptr();
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::ans_decode(
+    BYTE* in, szt inlen, pszmem_cxx<E>* ectrl, void* stream)
+{
+  CHECK_GPU(GpuMemcpy(ans_out->hptr(), in, inlen, GpuMemcpyD2H));
+
+  psz::ans_decode<CPU, E>(ans_out->hptr(), ectrl->hptr(), &time_ans);
+
+  CHECK_GPU(GpuMemcpyAsync(
+      ectrl->dptr(), ectrl->hptr(), ectrl->bytes(), GpuMemcpyH2D,
+      (GpuStreamT)stream));
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::rle_reserve(szt n)
+{
+  if (rle_len and rle_len->len() >= n) return this;
+
+  if (rle_val) delete rle_val;
+  if (rle_len) delete rle_len;
+
+  rle_val = new pszmem_cxx<E>(n, 1, 1, "rle::val");
+  rle_len = new pszmem_cxx<u2>(n, 1, 1, "rle::len");
+  rle_val->control({MallocHost});
+  rle_len->control({Malloc, MallocHost});
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::rle_encode(
+    pszmem_cxx<E>* ectrl, szt len, bool force, void* stream)
+{
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(
+      ectrl->hptr(), ectrl->dptr(), sizeof(E) * len, GpuMemcpyD2H));
+
+  szt _nrun;
+  float t;
+  psz::rle_count<CPU, E>(ectrl->hptr(), len, &_nrun, &time_rle);
+
+  nrun = 0;
+  if (not force and _nrun * psz::RLE_AUTO_MIN_AVGRUN > len) return this;
+
+  rle_reserve(_nrun);
+  psz::rle_encode<CPU, E>(
+      ectrl->hptr(), len, rle_val->hptr(), rle_len->hptr(), &nrun, &t);
+  time_rle += t;
+
+  // the codec and its histogram then work on the run values
+  CHECK_GPU(GpuMemcpy(
+      ectrl->dptr(), rle_val->hptr(), sizeof(E) * nrun, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      rle_len->dptr(), rle_len->hptr(), sizeof(u2) * nrun, GpuMemcpyH2D));
+
+  auto hist = mem->ht;
+  memset(hist->hptr(), 0, hist->bytes());
+  psz::histogram<CPU, E>(
+      rle_val->hptr(), nrun, hist->hptr(), hist->len(), &t);
+  hist->control({H2D});
+  time_hist += t;
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::rle_decode(
+    pszmem_cxx<E>* ectrl, szt _nrun, u2* d_runlen, void* stream)
+{
+  nrun = _nrun;
+  rle_reserve(nrun);
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(
+      rle_val->hptr(), ectrl->dptr(), sizeof(E) * nrun, GpuMemcpyD2H));
+  CHECK_GPU(GpuMemcpy(
+      rle_len->hptr(), d_runlen, sizeof(u2) * nrun, GpuMemcpyD2H));
+
+  psz::rle_decode<CPU, E>(
+      rle_val->hptr(), rle_len->hptr(), nrun, ectrl->hptr(), ectrl->len(),
+      &time_rle);
+  ectrl->control({H2D});
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::log_reserve(szt n)
+{
+  if (logmap and logmap->len() >= n) return this;
+
+  if (logmap) delete logmap;
+
+  logmap = new pszmem_cxx<BYTE>(n, 1, 1, "log::map");
+  logmap->control({Malloc, MallocHost});
+
+  return this;
+}
+
+// `in` then points to y = log2|x| in `oc`, and `eb` is the bound on y.
+// The map is a u4 of flags (1: sign, 2: zero) followed by the bitmaps in use.
+template <class C>
+Compressor<C>* Compressor<C>::log_encode(T*& in, double& eb, void* stream)
+{
+  auto bm_bytes = psz::log_bitmap_bytes(len);
+  log_reserve(sizeof(u4) + 2 * bm_bytes);
+
+  auto h_sign = logmap->hptr() + sizeof(u4);
+  auto h_zero = h_sign + bm_bytes;
+  bool has_sign, has_zero;
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(mem->oc->hptr(), in, sizeof(T) * len, GpuMemcpyD2H));
+
+  eb = detail::log_forward<T>(
+      std::is_floating_point<T>{}, mem->oc->hptr(), len, h_sign, h_zero,
+      &has_sign, &has_zero, eb, &time_log);
+
+  u4 flags = (u4)has_sign | (u4)has_zero << 1;
+  memcpy(logmap->hptr(), &flags, sizeof(u4));
+  if (has_zero and not has_sign) memmove(h_sign, h_zero, bm_bytes);
+  logmap_bytes = sizeof(u4) + (has_sign + has_zero) * bm_bytes;
+
+  CHECK_GPU(GpuMemcpy(
+      logmap->dptr(), logmap->hptr(), logmap_bytes, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      mem->oc->dptr(), mem->oc->hptr(), sizeof(T) * len, GpuMemcpyH2D));
+  in = mem->oc->dptr();
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::log_decode(
+    BYTE* d_map, szt map_bytes, T* d_xdata, void* stream)
+{
+  auto bm_bytes = psz::log_bitmap_bytes(len);
+  logmap_bytes = map_bytes;
+  log_reserve(map_bytes);
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(logmap->hptr(), d_map, map_bytes, GpuMemcpyD2H));
+  CHECK_GPU(GpuMemcpy(
+      mem->oc->hptr(), d_xdata, sizeof(T) * len, GpuMemcpyD2H));
+
+  u4 flags;
+  memcpy(&flags, logmap->hptr(), sizeof(u4));
+  auto bm = logmap->hptr() + sizeof(u4);
+  u1 const* h_sign = flags & 1 ? bm : nullptr;
+  u1 const* h_zero = flags & 2 ? (h_sign ? bm + bm_bytes : bm) : nullptr;
+
+  detail::log_backward<T>(
+      std::is_floating_point<T>{}, mem->oc->hptr(), len, h_sign, h_zero,
+      &time_log);
+
+  CHECK_GPU(GpuMemcpy(
+      d_xdata, mem->oc->hptr(), sizeof(T) * len, GpuMemcpyH2D));
+
+  return this;
+}
+
+// The preview is a whole archive of the binned input, at the same eb and in
+// the same mode, hence readable on its own.
+template <class C>
+Compressor<C>* Compressor<C>::preview_encode(
+    cusz_context* config, T* in, BYTE** out, void* stream)
+{
+  int bx, by;
+  psz::binning_factor(config->binning, &bx, &by);
+  auto len3_bin = psz::binning_len3(
+      psz_dim3{config->x, config->y, config->z}, bx, by);
+  szt len_bin = len3_bin.x * len3_bin.y * len3_bin.z;
+
+  if (bin and bin->len() != len_bin) delete bin, bin = nullptr;
+  if (not bin) {
+    bin = new pszmem_cxx<T>(len3_bin.x, len3_bin.y, len3_bin.z, "bin");
+    bin->control({Malloc, MallocHost});
+  }
+
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(mem->oc->hptr(), in, sizeof(T) * len, GpuMemcpyD2H));
+  detail::bin_forward<T>(
+      std::is_floating_point<T>{}, mem->oc->hptr(),
+      psz_dim3{config->x, config->y, config->z}, bx, by, bin->hptr(),
+      &time_preview);
+  CHECK_GPU(GpuMemcpy(
+      bin->dptr(), bin->hptr(), sizeof(T) * len_bin, GpuMemcpyH2D));
+
+  // a single plain archive: none of the stages of the parent's own archive
+  auto ctx = *config;
+  ctx.prep_binning = false, ctx.prog_layers = 1;
+  ctx.use_rle = false, ctx.use_rle_force = false, ctx.report_cr_est = false;
+  if (ctx.mode == PwRel) {
+    // the point-wise bound, as one relative to the range of the preview
+    ctx.mode = Abs;
+    ctx.eb *= detail::host_range<T>(
+        std::is_floating_point<T>{}, bin->hptr(), len_bin);
+  }
+  pszctx_set_rawlen(&ctx, len3_bin.x, len3_bin.y, len3_bin.z, 1);
+  CompressorHelper::autotune_coarse_parhf(&ctx);
+
+  if (preview and preview->len != len_bin) delete preview, preview = nullptr;
+  if (not preview) (preview = new Compressor)->init(&ctx);
+
+  TimeRecord record;
+  preview->compress(&ctx, bin->dptr(), *out, preview_bytes, stream);
+  preview->export_timerecord(&record);
+  for (auto& r : record) time_preview += std::get<1>(r);
+
+  return this;
+}
+
+template <class C>
+Compressor<C>* Compressor<C>::prog_reserve()
+{
+  if (prog_rec and prog_rec->len() == len) return this;
+
+  if (prog_rec) delete prog_rec;
+  if (prog_res) delete prog_res;
+
+  prog_rec = new pszmem_cxx<f8>(len, 1, 1, "prog::rec");
+  prog_res = new pszmem_cxx<T>(len, 1, 1, "prog::res");
+  prog_rec->control({MallocHost});
+  prog_res->control({Malloc, MallocHost});
+
+  return this;
+}
+
+// Layer k > 0 is a whole archive of the residual against the reconstruction
+// through layer k - 1, at an eb `prog_ratio` times tighter; the last one is
+// at the requested eb. The LAYERS segment, the last one, starts with the
+// number of layers and where each ends, so that a reader can stop after any
+// layer by reading only a prefix of the archive.
+template <class C>
+Compressor<C>* Compressor<C>::prog_encode(
+    cusz_context* config, T* in, BYTE*& out, size_t& outlen, void* stream)
+{
+  auto a = hires::now();
+
+  u4 const n = config->prog_layers - 1;
+  auto ctx = *config;
+  ctx.prep_binning = false, ctx.prog_layers = 1;
+
+  if (layer and layer->len != len) delete layer, layer = nullptr;
+  if (not layer) (layer = new Compressor)->init(&ctx);
+  prog_reserve();
+
+  auto x = mem->oc->hptr();
+  auto rec = prog_rec->hptr(), res = prog_res->hptr();
+  float t;
+
+  // the base may be encoded with a shared book; the layers, never
+  auto decode_layer = [&](BYTE* archive, szt bytes, T* to) {
+    Header h;
+    CHECK_GPU(GpuMemcpy(&h, archive, sizeof(Header), GpuMemcpyD2H));
+    layer->use_book(h.shared_book ? book : nullptr);
+    layer->decompress(&h, archive, bytes, prog_res->dptr(), stream);
+    layer->use_book(nullptr);
+    CHECK_GPU(GpuMemcpy(
+        to, prog_res->dptr(), sizeof(T) * len, GpuMemcpyD2H));
+  };
+
+  // in double from the base on, as `prog_decode` does
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(x, in, sizeof(T) * len, GpuMemcpyD2H));
+  decode_layer(out, outlen, res);
+  memset(rec, 0, sizeof(f8) * len);
+  detail::prog_add<T>(std::is_floating_point<T>{}, rec, res, len, &t);
+
+  std::vector<u4> index(1 + n);
+  std::vector<BYTE> seg;
+  index[0] = n;
+
+  for (u4 k = 1; k <= n; k++) {
+    ctx.eb = config->eb * std::pow(config->prog_ratio, n - k);
+    detail::prog_diff<T>(std::is_floating_point<T>{}, x, rec, res, len, &t);
+    CHECK_GPU(GpuMemcpy(
+        prog_res->dptr(), res, sizeof(T) * len, GpuMemcpyH2D));
+
+    BYTE* d_layer;
+    size_t layer_bytes;
+    layer->compress(&ctx, prog_res->dptr(), d_layer, layer_bytes, stream);
+
+    seg.resize(seg.size() + layer_bytes);
+    CHECK_GPU(GpuMemcpy(
+        seg.data() + seg.size() - layer_bytes, d_layer, layer_bytes,
+        GpuMemcpyD2H));
+    index[k] = seg.size();
+
+    // not needed after the last layer
+    if (k < n) {
+      decode_layer(d_layer, layer_bytes, res);
+      detail::prog_add<T>(std::is_floating_point<T>{}, rec, res, len, &t);
+    }
+  }
+
+  auto index_bytes = sizeof(u4) * index.size();
+  auto total = outlen + index_bytes + seg.size();
+  if (not prog_out or prog_out->len() < total) {
+    if (prog_out) delete prog_out;
+    prog_out = new pszmem_cxx<BYTE>(total, 1, 1, "prog::out");
+    prog_out->control({Malloc});
+  }
+
+  header.entry[Header::END] = total;
+  auto d_seg = prog_out->dptr() + outlen;
+  CHECK_GPU(GpuMemcpy(prog_out->dptr(), out, outlen, GpuMemcpyD2D));
+  CHECK_GPU(GpuMemcpy(
+      prog_out->dptr(), &header, sizeof(Header), GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(d_seg, index.data(), index_bytes, GpuMemcpyH2D));
+  CHECK_GPU(GpuMemcpy(
+      d_seg + index_bytes, seg.data(), seg.size(), GpuMemcpyH2D));
+
+  out = prog_out->dptr();
+  outlen = total;
+
+  auto b = hires::now();
+  time_prog = static_cast<duration_t>(b - a).count() * 1000;
+
+  return this;
+}
+
+// Layers are added as long as they are within the `avail` bytes.
+template <class C>
+Compressor<C>* Compressor<C>::prog_decode(
+    BYTE* d_seg, szt avail, T* d_xdata, void* stream)
+{
+  auto a = hires::now();
+
+  u4 n;
+  if (avail < sizeof(u4)) return this;
+  CHECK_GPU(GpuStreamSync(stream));
+  CHECK_GPU(GpuMemcpy(&n, d_seg, sizeof(u4), GpuMemcpyD2H));
+
+  std::vector<u4> end(n);
+  auto index_bytes = sizeof(u4) * (1 + n);
+  if (avail < index_bytes) return this;
+  CHECK_GPU(GpuMemcpy(
+      end.data(), d_seg + sizeof(u4), sizeof(u4) * n, GpuMemcpyD2H));
+
+  // from the base, in double, and rounded to T once at the end
+  prog_reserve();
+  auto rec = prog_rec->hptr(), res = prog_res->hptr();
+  CHECK_GPU(GpuMemcpy(res, d_xdata, sizeof(T) * len, GpuMemcpyD2H));
+  memset(rec, 0, sizeof(f8) * len);
+  float t;
+  detail::prog_add<T>(std::is_floating_point<T>{}, rec, res, len, &t);
+
+  for (u4 k = 0, start = 0; k < n and index_bytes + end[k] <= avail;
+       start = end[k++]) {
+    auto d_layer = d_seg + index_bytes + start;
+    Header h;
+    CHECK_GPU(GpuMemcpy(&h, d_layer, sizeof(Header), GpuMemcpyD2H));
+
+    if (layer and layer->len != len) delete layer, layer = nullptr;
+    if (not layer) (layer = new Compressor)->init(&h);
+
+    layer->decompress(&h, d_layer, end[k] - start, prog_res->dptr(), stream);
+    CHECK_GPU(GpuMemcpy(
+        res, prog_res->dptr(), sizeof(T) * len, GpuMemcpyD2H));
+    detail::prog_add<T>(std::is_floating_point<T>{}, rec, res, len, &t);
+    nlayer++;
+  }
+
+  detail::prog_finish<T>(std::is_floating_point<T>{}, rec, res, len, &t);
+  CHECK_GPU(GpuMemcpy(d_xdata, res, sizeof(T) * len, GpuMemcpyH2D));
+
+  auto b = hires::now();
+  time_prog = static_cast<duration_t>(b - a).count() * 1000;
+
+  return this;
+}
+
 template <class C>
 Compressor<C>* Compressor<C>::dump(
     std::vector<pszmem_dump> list, char const* basename)
@@ -314,7 +1168,8 @@ Compressor<C>* Compressor<C>::clear_buffer()
 
 template <class C>
 Compressor<C>* Compressor<C>::decompress(
-    cusz_header* header, BYTE* in, T* out, void* stream, bool dbg_print)
+    cusz_header* header, BYTE* in, szt inlen, T* out, void* stream,
+    bool dbg_print)
 {
   // TODO host having copy of header when compressing
   if (not header) {
@@ -324,7 +1179,12 @@ Compressor<C>* Compressor<C>::decompress(
     CHECK_GPU(GpuStreamSync(stream));
   }
 
+  if (not header->known())
+    throw std::runtime_error(
+        "[psz::error] Not an archive, or of an unknown format version.");
+
   len3 = dim3(header->x, header->y, header->z);
+  nrun = 0;
 
   // use_fallback_codec = header->byte_vle == 8;
   double const eb = header->eb;
@@ -340,10 +1200,32 @@ Compressor<C>* Compressor<C>::decompress(
   auto d_spval = (T*)access(Header::SPFMT);
   auto d_spidx = (M*)access(Header::SPFMT, header->splen * sizeof(T));
 
-  // wire and aliasing
-  auto d_outlier = out;
+  // wire and aliasing: outliers are scattered in place of the output
   auto d_xdata = out;
 
+  auto nbyte = [&](int FIELD) {
+    return header->entry[FIELD + 1] - header->entry[FIELD];
+  };
+
+  auto vle_decode = [&](pszmem_cxx<E>* ectrl) {
+    if (header->codec1_type == Rans)
+      ans_decode(d_vle, nbyte(Header::VLE), ectrl, stream);
+    else {
+      if (header->shared_book and
+          (not book or book->id != header->shared_book))
+        throw std::runtime_error(
+            "[psz::error] The archive is encoded with shared book " +
+            std::to_string(header->shared_book) + ", which is not given.");
+      codec->load_book(header->shared_book ? book : nullptr, stream);
+      codec->decode(d_vle, ectrl->dptr());
+    }
+
+    if (nbyte(Header::RUNLEN))
+      rle_decode(
+          ectrl, nbyte(Header::RUNLEN) / sizeof(u2),
+          (u2*)access(Header::RUNLEN), stream);
+  };
+
   if (header->pred_type == Spline) {
     mem->xd->dptr(d_xdata);
 
@@ -353,9 +1235,10 @@ Compressor<C>* Compressor<C>::decompress(
     anchor.dptr(d_anchor);
 
 #ifdef PSZ_USE_CUDA
-    codec->decode(d_vle, mem->ectrl_spl());
-    spline_reconstruct(
-        &anchor, mem->es, mem->xd, eb, radius, &time_pred, stream);
+    vle_decode(mem->es);
+    detail::spl_reconstruct<T, E>(
+        detail::spl_unsupported<T>{}, &anchor, mem->es, mem->xd, eb, radius,
+        &time_pred, stream);
 #else
     throw runtime_error(
         "[psz::error] spline_reconstruct only works for CUDA version "
@@ -363,14 +1246,29 @@ Compressor<C>* Compressor<C>::decompress(
 #endif
   }
   else {
-    psz::spv_scatter<PROPER_GPU_BACKEND, T, M>(
-        d_spval, d_spidx, header->splen, d_outlier, &time_sp, stream);
-    codec->decode(d_vle, mem->ectrl_lrz());
-    psz_decomp_l23<T, E, FP>(
-        mem->ectrl_lrz(), len3, d_outlier, eb, radius, d_xdata, &time_pred,
+    vle_decode(mem->el);
+    detail::lrz_reconstruct<T, E, FP>(
+        typename detail::lrz_path<T>::type{}, d_spval, d_spidx,
+        header->splen, len3, eb, radius, d_xdata, mem, &time_sp, &time_pred,
         stream);
   }
 
+  // point-wise relative: from y = log2|x| back to x
+  logmap_bytes = 0;
+  if (nbyte(Header::LOGMAP))
+    log_decode(
+        (BYTE*)access(Header::LOGMAP), nbyte(Header::LOGMAP), d_xdata,
+        stream);
+
+  // progressive: the residual layers within `inlen`, if any
+  nlayer = 0;
+  if (nbyte(Header::LAYERS) and inlen > header->entry[Header::LAYERS])
+    prog_decode(
+        (BYTE*)access(Header::LAYERS),
+        std::min<szt>(inlen, header->entry[Header::END]) -
+            header->entry[Header::LAYERS],
+        d_xdata, stream);
+
   collect_decomp_time();
 
   // clear state for the next decompression after reporting
@@ -409,10 +1307,20 @@ Compressor<C>* Compressor<C>::collect_comp_time()
 
   if (not timerecord.empty()) timerecord.clear();
 
+  if (preview_bytes) COLLECT_TIME("preview", time_preview);
+  if (header.entry[Header::END] > header.entry[Header::LAYERS])
+    COLLECT_TIME("layers", time_prog);
+  if (logmap_bytes) COLLECT_TIME("log", time_log);
   COLLECT_TIME("predict", time_pred);
   COLLECT_TIME("histogram", time_hist);
-  COLLECT_TIME("book", codec->time_book());
-  COLLECT_TIME("huff-enc", codec->time_lossless());
+  if (nrun) COLLECT_TIME("rle", time_rle);
+  if (codec1_type == Rans) {
+    COLLECT_TIME("ans-enc", time_ans);
+  }
+  else {
+    COLLECT_TIME("book", codec->time_book());
+    COLLECT_TIME("huff-enc", codec->time_lossless());
+  }
   COLLECT_TIME("outlier", time_sp);
 
   return this;
@@ -424,8 +1332,16 @@ Compressor<C>* Compressor<C>::collect_decomp_time()
   if (not timerecord.empty()) timerecord.clear();
 
   COLLECT_TIME("outlier", time_sp);
-  COLLECT_TIME("huff-dec", codec->time_lossless());
+  if (codec1_type == Rans) {
+    COLLECT_TIME("ans-dec", time_ans);
+  }
+  else {
+    COLLECT_TIME("huff-dec", codec->time_lossless());
+  }
+  if (nrun) COLLECT_TIME("rle-dec", time_rle);
   COLLECT_TIME("predict", time_pred);
+  if (logmap_bytes) COLLECT_TIME("log-inv", time_log);
+  if (nlayer) COLLECT_TIME("layers", time_prog);
 
   return this;
 }
@@ -20,6 +20,10 @@
   template bool psz::cppstd_error_bounded(           \
       T* a, T* b, size_t const len, double const eb, \
       size_t* first_faulty_idx);                     \
+  template bool psz::cppstd_verify_eb(               \
+      T const* a, T const* b, size_t const len,      \
+      double const eb, size_t* first,                \
+      size_t* count);                                \
   template void psz::cppstd_assess_quality(          \
       cusz_stats* s, T* xdata, T* odata, size_t const len);
 
@@ -0,0 +1,187 @@
+/**
+ * @file compare_stream.cc
+ * @author Jiannan Tian
+ * @brief Out-of-core quality assessment, and the extrema scan fused with
+ * loading, streaming from files.
+ * @version 0.4
+ * @date 2023-09-24
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "stat/compare_stream.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "detail/compare_cpu.inl"
+
+namespace {
+
+[[noreturn]] void stream_error(std::string const& what, char const* fname)
+{
+  throw std::runtime_error(
+      "[psz::error::compare] " + what + " \"" + std::string(fname) + "\".");
+}
+
+// A file opened for reading, mapped one range at a time.
+struct mapped_file {
+  char const* fname;
+  int fd;
+  size_t bytes;
+
+  explicit mapped_file(char const* fname) : fname(fname)
+  {
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) stream_error("Cannot open", fname);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      stream_error("Cannot stat", fname);
+    }
+    bytes = st.st_size;
+  }
+  ~mapped_file() { close(fd); }
+
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+};
+
+// [offset, offset + bytes) of a file; `offset` is aligned to pages.
+struct mapped_range {
+  void* ptr{nullptr};
+  size_t bytes;
+
+  mapped_range(mapped_file const& f, size_t offset, size_t bytes) :
+      bytes(bytes)
+  {
+    ptr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, f.fd, offset);
+    if (ptr == MAP_FAILED) stream_error("Cannot map", f.fname);
+    madvise(ptr, bytes, MADV_SEQUENTIAL);
+  }
+  ~mapped_range() { munmap(ptr, bytes); }
+
+  mapped_range(mapped_range const&) = delete;
+  mapped_range& operator=(mapped_range const&) = delete;
+};
+
+// `xfile` is read only if `xdata` is null.
+template <typename T>
+void stream_assess(
+    pszsummary* s, T const* xdata, char const* xfile, char const* ofile,
+    size_t slab_bytes, psz::slab_report const& per_slab)
+{
+  mapped_file o(ofile);
+  if (o.bytes % sizeof(T) != 0)
+    stream_error("Size is not a multiple of the data type of", ofile);
+  size_t const len = o.bytes / sizeof(T);
+
+  std::unique_ptr<mapped_file> x;
+  if (not xdata) {
+    x.reset(new mapped_file(xfile));
+    if (x->bytes != o.bytes)
+      stream_error("Size differs from that of the original in", xfile);
+  }
+
+  *s = pszsummary{};
+  s->len = len;
+  if (len == 0) return;
+
+  size_t const page = sysconf(_SC_PAGESIZE);
+  slab_bytes = std::max(slab_bytes / page, (size_t)1) * page;
+  size_t const slab_len = slab_bytes / sizeof(T);
+
+  psz::detail::assess_partial total;
+  for (size_t start = 0; start < len; start += slab_len) {
+    auto const n = std::min(slab_len, len - start);
+    auto const offset = start * sizeof(T), bytes = n * sizeof(T);
+
+    mapped_range o_slab(o, offset, bytes);
+    std::unique_ptr<mapped_range> x_slab;
+    if (x) x_slab.reset(new mapped_range(*x, offset, bytes));
+
+    auto p = psz::detail::assess_range<T>(
+        x_slab ? (T const*)x_slab->ptr : xdata + start,
+        (T const*)o_slab.ptr, n);
+    p.max_err_idx += start;
+
+    if (per_slab) {
+      pszsummary slab;
+      psz::detail::assess_finish(&slab, p);
+      per_slab(start, slab);
+    }
+
+    total.merge(p);
+  }
+
+  psz::detail::assess_finish(s, total);
+}
+
+}  // namespace
+
+template <typename T>
+void psz::stream_assess_quality(
+    pszsummary* s, char const* xfile, char const* ofile, size_t slab_bytes,
+    slab_report const& per_slab)
+{
+  stream_assess<T>(s, nullptr, xfile, ofile, slab_bytes, per_slab);
+}
+
+template <typename T>
+void psz::stream_assess_quality(
+    pszsummary* s, T const* xdata, char const* ofile, size_t slab_bytes,
+    slab_report const& per_slab)
+{
+  stream_assess<T>(s, xdata, nullptr, ofile, slab_bytes, per_slab);
+}
+
+template <typename T>
+void psz::load_with_extrema(
+    char const* fname, T* dst, size_t const len, T res[4])
+{
+  using detail::EXTREMA_SUBLEN;
+
+  mapped_file f(fname);
+  if (f.bytes < len * sizeof(T))
+    stream_error("Fewer bytes than the given length in", fname);
+  if (len == 0) return;
+
+  mapped_range m(f, 0, len * sizeof(T));
+  auto src = (T const*)m.ptr;
+
+  auto nchunk = (len - 1) / EXTREMA_SUBLEN + 1;
+  std::vector<detail::extrema_partial> part(nchunk);
+
+  // the chunk is scanned while it is still in cache
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * EXTREMA_SUBLEN;
+    auto n = std::min(EXTREMA_SUBLEN, len - start);
+    std::memcpy(dst + start, src + start, n * sizeof(T));
+    part[c] = detail::extrema_chunk<T>(dst + start, n);
+  });
+
+  detail::extrema_finish<T>(part, len, res);
+}
+
+#define SPECIALIZE_STREAM(T)                                                \
+  template void psz::stream_assess_quality<T>(                              \
+      pszsummary * s, char const* xfile, char const* ofile,                 \
+      size_t slab_bytes, slab_report const& per_slab);                      \
+  template void psz::stream_assess_quality<T>(                              \
+      pszsummary * s, T const* xdata, char const* ofile, size_t slab_bytes, \
+      slab_report const& per_slab);                                         \
+  template void psz::load_with_extrema<T>(                                  \
+      char const* fname, T* dst, size_t const len, T res[4]);
+
+SPECIALIZE_STREAM(f4);
+SPECIALIZE_STREAM(f8);
+
+#undef SPECIALIZE_STREAM
@@ -13,12 +13,16 @@
 #define C0E747B4_066F_4B04_A3D2_00E1A3B7D682
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <numeric>
+#include <vector>
 
 #include "cusz/type.h"
+#include "utils/par_cpu.hh"
 
 namespace psz {
 
@@ -28,98 +32,355 @@ bool cppstd_identical(T* d1, T* d2, size_t const len)
   return std::equal(d1, d1 + len, d2);
 }
 
+namespace detail {
+
+constexpr size_t EXTREMA_SUBLEN = 1 << 16;
+// independent accumulators, so that the reductions vectorize
+constexpr int EXTREMA_LANE = 8;
+
+struct extrema_partial {
+  double min, max, sum{0};
+
+  void merge(extrema_partial const& p)
+  {
+    min = std::min(min, p.min), max = std::max(max, p.max), sum += p.sum;
+  }
+};
+
+// min, max and the sum (in double) in one pass
+template <typename T>
+extrema_partial extrema_chunk(T const* in, size_t const n)
+{
+  constexpr auto L = EXTREMA_LANE;
+  T mn[L], mx[L];
+  double s[L] = {};
+  std::fill(mn, mn + L, in[0]), std::fill(mx, mx + L, in[0]);
+
+  size_t i = 0;
+  for (; i + L <= n; i += L)
+    for (int l = 0; l < L; l++) {
+      auto v = in[i + l];
+      mn[l] = std::min(mn[l], v), mx[l] = std::max(mx[l], v), s[l] += v;
+    }
+  for (; i < n; i++)
+    mn[0] = std::min(mn[0], in[i]), mx[0] = std::max(mx[0], in[i]),
+    s[0] += in[i];
+
+  extrema_partial p{(double)mn[0], (double)mx[0], 0};
+  for (int l = 0; l < L; l++)
+    p.min = std::min<double>(p.min, mn[l]),
+    p.max = std::max<double>(p.max, mx[l]), p.sum += s[l];
+  return p;
+}
+
+// `res` as of `cppstd_extrema`: min, max, mean and range
+template <typename T>
+void extrema_finish(
+    std::vector<extrema_partial> const& part, size_t const len, T res[4])
+{
+  auto r = part[0];
+  for (size_t c = 1; c < part.size(); c++) r.merge(part[c]);
+  res[0] = r.min;
+  res[1] = r.max;
+  res[2] = r.sum / len;    // average
+  res[3] = r.max - r.min;  // range
+}
+
+}  // namespace detail
+
+// One pass in chunks in parallel, summing in double.
 template <typename T>
 void cppstd_extrema(T* in, szt const len, T res[4])
 {
-  auto res2 = std::minmax_element(in, in + len);
-  res[0] = *res2.first;
-  res[1] = *res2.second;
-  res[3] = res[1] - res[0];  // range
+  using detail::EXTREMA_SUBLEN;
+  auto nchunk = (len - 1) / EXTREMA_SUBLEN + 1;
+  std::vector<detail::extrema_partial> part(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * EXTREMA_SUBLEN;
+    part[c] = detail::extrema_chunk<T>(
+        in + start, std::min(EXTREMA_SUBLEN, len - start));
+  });
+
+  detail::extrema_finish<T>(part, len, res);
+}
+
+namespace detail {
+
+constexpr size_t VERIFY_SUBLEN = 1 << 18;
+constexpr size_t VERIFY_BLK = 1024;
+constexpr size_t VERIFY_NONE = std::numeric_limits<size_t>::max();
+
+// Violations in [start, start + n), counted a block at a time without a
+// branch per element; unless `count_all`, it stops after the block of the
+// first one.
+template <typename T>
+size_t verify_chunk(
+    T const* a, T const* b, size_t const start, size_t const n,
+    double const eb, bool const count_all, size_t& first)
+{
+  // NaN fails the bound
+  auto bad = [&](size_t i) {
+    return not(std::fabs((double)a[i] - (double)b[i]) <= eb);
+  };
+
+  size_t count = 0;
+  first = VERIFY_NONE;
+  for (auto blk = start; blk < start + n; blk += VERIFY_BLK) {
+    auto const end = std::min(blk + VERIFY_BLK, start + n);
+
+    size_t nbad = 0;
+    for (auto i = blk; i < end; i++) nbad += bad(i);
+    if (nbad == 0) continue;
+
+    if (first == VERIFY_NONE)
+      for (auto i = blk; i < end; i++)
+        if (bad(i)) {
+          first = i;
+          break;
+        }
+    count += nbad;
+    if (not count_all) break;
+  }
+  return count;
+}
+
+}  // namespace detail
+
+// Chunks go to threads in order; without `count`, those after the lowest one
+// known to fail are skipped, which keeps the first violation exact.
+template <typename T>
+bool cppstd_verify_eb(
+    T const* a, T const* b, size_t const len, double const eb, size_t* first,
+    size_t* count)
+{
+  using detail::VERIFY_SUBLEN;
+  if (len == 0) {
+    if (count) *count = 0;
+    return true;
+  }
+
+  auto const nchunk = (len - 1) / VERIFY_SUBLEN + 1;
+  auto const count_all = count != nullptr;
+  std::atomic<size_t> lowest{nchunk};
+  std::vector<size_t> nbad(nchunk, 0), first_bad(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    if (not count_all and c > lowest.load(std::memory_order_relaxed)) return;
+
+    auto start = c * VERIFY_SUBLEN;
+    auto n = std::min(VERIFY_SUBLEN, len - start);
+    nbad[c] =
+        detail::verify_chunk<T>(a, b, start, n, eb, count_all, first_bad[c]);
+
+    if (nbad[c] and not count_all) {
+      auto cur = lowest.load();
+      while (c < cur and not lowest.compare_exchange_weak(cur, c))
+        ;
+    }
+  });
+
+  size_t total = 0, first_ = detail::VERIFY_NONE;
+  for (size_t c = 0; c < nchunk; c++) {
+    if (nbad[c] and first_ == detail::VERIFY_NONE) first_ = first_bad[c];
+    total += nbad[c];
+  }
 
-  auto sum = std::accumulate(in, in + len, (T)0.0);
-  res[2] = sum / len;  // average
+  if (first and total) *first = first_;
+  if (count) *count = total;
+  return total == 0;
 }
 
+// with a margin of 0.1% for the rounding of the round trip
 template <typename T>
 bool cppstd_error_bounded(
     T* a, T* b, size_t const len, double const eb,
     size_t* first_faulty_idx = nullptr)
 {
-  // debugging
+  return cppstd_verify_eb<T>(
+      a, b, len, 1.001 * eb, first_faulty_idx, nullptr);
+}
 
-  bool eb_ed = true;
-  for (size_t i = 0; i < len; i++) {
-    if (fabs(a[i] - b[i]) > 1.001 * eb) {
-      if (first_faulty_idx) *first_faulty_idx = i;
-      return false;
-    }
+namespace detail {
+
+constexpr size_t ASSESS_SUBLEN = 1 << 16;
+constexpr size_t ASSESS_BLK = 256;
+// lanes of accumulators, as in `extrema_chunk`
+constexpr int ASSESS_LANE = 8;
+
+// The moments of a chunk about its own means, merged pairwise (Chan et al.)
+// so that the result does not depend on magnitudes far from the mean; the
+// sum of squared errors is merged with Kahan compensation.
+struct assess_partial {
+  double n{0}, mean_o{0}, mean_x{0}, m2_o{0}, m2_x{0}, c_ox{0};
+  double sum_e2{0}, comp_e2{0};
+  double max_o{-HUGE_VAL}, min_o{HUGE_VAL}, max_x{-HUGE_VAL}, min_x{HUGE_VAL};
+  double max_err{-1}, max_pwrrel{0};
+  size_t max_err_idx{0};
+
+  // `p` follows this one in index order; a default one is empty
+  void merge(assess_partial const& p)
+  {
+    auto n_ = n + p.n;
+    auto d_o = p.mean_o - mean_o, d_x = p.mean_x - mean_x;
+    auto w = n * p.n / n_;
+    m2_o += p.m2_o + d_o * d_o * w;
+    m2_x += p.m2_x + d_x * d_x * w;
+    c_ox += p.c_ox + d_o * d_x * w;
+    mean_o += d_o * p.n / n_, mean_x += d_x * p.n / n_;
+    n = n_;
+
+    auto y = p.sum_e2 - comp_e2, t = sum_e2 + y;
+    comp_e2 = (t - sum_e2) - y, sum_e2 = t;
+
+    max_o = std::max(max_o, p.max_o), min_o = std::min(min_o, p.min_o);
+    max_x = std::max(max_x, p.max_x), min_x = std::min(min_x, p.min_x);
+    max_pwrrel = std::max(max_pwrrel, p.max_pwrrel);
+    // the first of the largest
+    if (p.max_err > max_err) max_err = p.max_err, max_err_idx = p.max_err_idx;
   }
-  return true;
+};
+
+// Over [start, start + n) of `odata`, with the reconstructed values of a
+// block of `m` at `i` as `recon(i, m, buf)` gives them: in place, or in
+// `buf` when they are made on the fly.
+template <typename T, typename Recon>
+void assess_chunk_by(
+    T const* odata, size_t const start, size_t const n, Recon recon,
+    assess_partial& p)
+{
+  constexpr auto L = ASSESS_LANE;
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+
+  T buf[ASSESS_BLK];
+
+  // shifted by the first of the chunk, against cancellation
+  double const sh_o = odata[start], sh_x = *recon(start, 1, buf);
+
+  double s_o[L] = {}, s_x[L] = {}, s_oo[L] = {}, s_xx[L] = {}, s_ox[L] = {},
+         s_e2[L] = {}, mx_pw[L] = {};
+  double mx_o[L], mn_o[L], mx_x[L], mn_x[L];
+  std::fill(mx_o, mx_o + L, -inf), std::fill(mx_x, mx_x + L, -inf);
+  std::fill(mn_o, mn_o + L, inf), std::fill(mn_x, mn_x + L, inf);
+
+  double err[ASSESS_BLK];
+
+  for (size_t b = 0; b < n; b += ASSESS_BLK) {
+    auto const m = std::min(ASSESS_BLK, n - b);
+    auto const o = odata + start + b;
+    auto const x = recon(start + b, m, buf);
+
+    auto acc = [&](size_t j, int l) {
+      double od = o[j], xd = x[j];
+      double e = std::fabs(xd - od);
+      double od_ = od - sh_o, xd_ = xd - sh_x;
+      err[j] = e;
+      s_o[l] += od_, s_x[l] += xd_;
+      s_oo[l] += od_ * od_, s_xx[l] += xd_ * xd_, s_ox[l] += od_ * xd_;
+      s_e2[l] += e * e;
+      mx_o[l] = std::max(mx_o[l], od), mn_o[l] = std::min(mn_o[l], od);
+      mx_x[l] = std::max(mx_x[l], xd), mn_x[l] = std::min(mn_x[l], xd);
+      mx_pw[l] = std::max(mx_pw[l], od != 0 ? e / std::fabs(od) : 0.0);
+    };
+
+    size_t j = 0;
+    for (; j + L <= m; j += L)
+      for (int l = 0; l < L; l++) acc(j + l, l);
+    for (; j < m; j++) acc(j, j % L);
+
+    auto it = std::max_element(err, err + m);
+    if (*it > p.max_err)
+      p.max_err = *it, p.max_err_idx = start + b + (it - err);
+  }
+
+  double S_o = 0, S_x = 0, S_oo = 0, S_xx = 0, S_ox = 0;
+  p.max_o = p.max_x = -inf, p.min_o = p.min_x = inf;
+  for (int l = 0; l < L; l++) {
+    S_o += s_o[l], S_x += s_x[l];
+    S_oo += s_oo[l], S_xx += s_xx[l], S_ox += s_ox[l];
+    p.sum_e2 += s_e2[l];
+    p.max_o = std::max(p.max_o, mx_o[l]), p.min_o = std::min(p.min_o, mn_o[l]);
+    p.max_x = std::max(p.max_x, mx_x[l]), p.min_x = std::min(p.min_x, mn_x[l]);
+    p.max_pwrrel = std::max(p.max_pwrrel, mx_pw[l]);
+  }
+
+  p.n = n;
+  p.mean_o = sh_o + S_o / n, p.mean_x = sh_x + S_x / n;
+  p.m2_o = std::max(S_oo - S_o * S_o / n, 0.0);
+  p.m2_x = std::max(S_xx - S_x * S_x / n, 0.0);
+  p.c_ox = S_ox - S_o * S_x / n;
+}
+
+// `assess_chunk_by` over [0, len) in parallel, merged in index order
+template <typename T, typename Recon>
+assess_partial assess_range_by(
+    T const* odata, size_t const len, Recon const& recon)
+{
+  auto nchunk = (len - 1) / ASSESS_SUBLEN + 1;
+  std::vector<assess_partial> part(nchunk);
+
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * ASSESS_SUBLEN;
+    auto n = std::min(ASSESS_SUBLEN, len - start);
+    assess_chunk_by<T>(odata, start, n, recon, part[c]);
+  });
+
+  // keeping the first of the largest errors
+  auto r = part[0];
+  for (size_t c = 1; c < nchunk; c++) r.merge(part[c]);
+  return r;
 }
 
 template <typename T>
-void cppstd_assess_quality(cusz_stats* s, T* xdata, T* odata, size_t const len)
+assess_partial assess_range(T const* xdata, T const* odata, size_t const len)
 {
-  double max_odata = odata[0], min_odata = odata[0];
-  double max_xdata = xdata[0], min_xdata = xdata[0];
-  double max_abserr = max_abserr = fabs(xdata[0] - odata[0]);
-
-  double sum_0 = 0, sum_x = 0;
-  for (size_t i = 0; i < len; i++) sum_0 += odata[i], sum_x += xdata[i];
-
-  double mean_odata = sum_0 / len, mean_xdata = sum_x / len;
-  double sum_var_odata = 0, sum_var_xdata = 0, sum_err2 = 0, sum_corr = 0,
-         rel_abserr = 0;
-
-  double max_pwrrel_abserr = 0;
-  size_t max_abserr_index = 0;
-  for (size_t i = 0; i < len; i++) {
-    max_odata = max_odata < odata[i] ? odata[i] : max_odata;
-    min_odata = min_odata > odata[i] ? odata[i] : min_odata;
-
-    max_xdata = max_xdata < odata[i] ? odata[i] : max_xdata;
-    min_xdata = min_xdata > xdata[i] ? xdata[i] : min_xdata;
-
-    float abserr = fabs(xdata[i] - odata[i]);
-    if (odata[i] != 0) {
-      rel_abserr = abserr / fabs(odata[i]);
-      max_pwrrel_abserr =
-          max_pwrrel_abserr < rel_abserr ? rel_abserr : max_pwrrel_abserr;
-    }
-    max_abserr_index = max_abserr < abserr ? i : max_abserr_index;
-    max_abserr = max_abserr < abserr ? abserr : max_abserr;
-    sum_corr += (odata[i] - mean_odata) * (xdata[i] - mean_xdata);
-    sum_var_odata += (odata[i] - mean_odata) * (odata[i] - mean_odata);
-    sum_var_xdata += (xdata[i] - mean_xdata) * (xdata[i] - mean_xdata);
-    sum_err2 += abserr * abserr;
-  }
-  double std_odata = sqrt(sum_var_odata / len);
-  double std_xdata = sqrt(sum_var_xdata / len);
-  double ee = sum_corr / len;
+  return assess_range_by<T>(
+      odata, len, [&](size_t i, size_t, T*) { return xdata + i; });
+}
 
-  s->len = len;
+inline void assess_finish(cusz_stats* s, assess_partial const& r)
+{
+  double const len = r.n;
+  double std_odata = sqrt(r.m2_o / len);
+  double std_xdata = sqrt(r.m2_x / len);
+  double ee = r.c_ox / len;
+
+  s->len = r.n;
 
-  s->odata.max = max_odata;
-  s->odata.min = min_odata;
-  s->odata.rng = max_odata - min_odata;
+  s->odata.max = r.max_o;
+  s->odata.min = r.min_o;
+  s->odata.rng = r.max_o - r.min_o;
   s->odata.std = std_odata;
 
-  s->xdata.max = max_xdata;
-  s->xdata.min = min_xdata;
-  s->xdata.rng = max_xdata - min_xdata;
+  s->xdata.max = r.max_x;
+  s->xdata.min = r.min_x;
+  s->xdata.rng = r.max_x - r.min_x;
   s->xdata.std = std_xdata;
 
-  s->max_err.idx = max_abserr_index;
-  s->max_err.abs = max_abserr;
-  s->max_err.rel = max_abserr / s->odata.rng;
-  s->max_err.pwrrel = max_pwrrel_abserr;
+  s->max_err.idx = r.max_err_idx;
+  s->max_err.abs = r.max_err;
+  s->max_err.rel = r.max_err / s->odata.rng;
+  s->max_err.pwrrel = r.max_pwrrel;
 
   s->score.coeff = ee / std_odata / std_xdata;
-  s->score.MSE = sum_err2 / len;
+  s->score.MSE = r.sum_e2 / len;
   s->score.NRMSE = sqrt(s->score.MSE) / s->odata.rng;
   s->score.PSNR = 20 * log10(s->odata.rng) - 10 * log10(s->score.MSE);
 }
 
+}  // namespace detail
+
+// One pass over both arrays, in chunks in parallel.
+template <typename T>
+void cppstd_assess_quality(cusz_stats* s, T* xdata, T* odata, size_t const len)
+{
+  *s = cusz_stats{};
+  s->len = len;
+  if (len == 0) return;
+
+  detail::assess_finish(s, detail::assess_range<T>(xdata, odata, len));
+}
+
 }  // namespace psz
 
 #endif /* C0E747B4_066F_4B04_A3D2_00E1A3B7D682 */
@@ -0,0 +1,361 @@
+/**
+ * @file spatial_cpu.cc
+ * @author Jiannan Tian
+ * @brief Spatial quality metrics on host: SSIM, and the autocorrelation and
+ * spectrum of the error.
+ * @version 0.4
+ * @date 2023-09-25
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include "stat/spatial_cpu.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/par_cpu.hh"
+#include "utils/timer.hh"
+
+namespace psz {
+namespace detail {
+
+constexpr size_t SPATIAL_SUBLEN = 1 << 16;
+// rows of x (or groups of lines) to a task
+constexpr size_t SPATIAL_ROWS = 16;
+// lines along y or z are taken this many at a time, from consecutive x
+constexpr size_t SPATIAL_LANE = 16;
+
+constexpr auto NaN = std::numeric_limits<f8>::quiet_NaN();
+
+template <typename T>
+void minmax(T const* in, size_t const len, f8& min, f8& max)
+{
+  auto nchunk = (len - 1) / SPATIAL_SUBLEN + 1;
+  std::vector<f8> mn(nchunk), mx(nchunk);
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * SPATIAL_SUBLEN;
+    auto r = std::minmax_element(
+        in + start, in + std::min(len, start + SPATIAL_SUBLEN));
+    mn[c] = *r.first, mx[c] = *r.second;
+  });
+  min = *std::min_element(mn.begin(), mn.end());
+  max = *std::max_element(mx.begin(), mx.end());
+}
+
+// the mean and (population) variance of the error
+template <typename T>
+void error_moments(
+    T const* xdata, T const* odata, size_t const len, f8& mean, f8& var)
+{
+  auto nchunk = (len - 1) / SPATIAL_SUBLEN + 1;
+  std::vector<f8> s1(nchunk), s2(nchunk);
+  psz::cpu::parallel_for(nchunk, [&](size_t c) {
+    auto start = c * SPATIAL_SUBLEN;
+    auto end = std::min(len, start + SPATIAL_SUBLEN);
+    f8 a = 0, b = 0;
+    for (auto i = start; i < end; i++) {
+      f8 e = (f8)xdata[i] - odata[i];
+      a += e, b += e * e;
+    }
+    s1[c] = a, s2[c] = b;
+  });
+  f8 a = 0, b = 0;
+  for (size_t c = 0; c < nchunk; c++) a += s1[c], b += s2[c];
+  mean = a / len;
+  var = std::max(b / len - mean * mean, 0.0);
+}
+
+template <typename T>
+f8 ssim_cpu(
+    T const* xdata, T const* odata, psz_dim3 const len3, int const window,
+    int const shift)
+{
+  if (window < 1 or shift < 1)
+    throw std::runtime_error(
+        "[psz::error::ssim] The window and the shift must be positive.");
+
+  size_t const nx = len3.x, ny = len3.y, nz = len3.z;
+  size_t const wx = std::min<size_t>(window, nx),
+               wy = std::min<size_t>(window, ny),
+               wz = std::min<size_t>(window, nz);
+  size_t const s = shift;
+  auto nwin = [s](size_t n, size_t w) { return (n - w) / s + 1; };
+  size_t const mx = nwin(nx, wx), my = nwin(ny, wy), mz = nwin(nz, wz);
+
+  f8 min, max;
+  minmax(odata, nx * ny * nz, min, max);
+  auto const rng = max - min, sh = (max + min) / 2;
+  auto const C1 = (0.01 * rng) * (0.01 * rng),
+             C2 = (0.03 * rng) * (0.03 * rng);
+  f8 const n = wx * wy * wz;
+
+  // The box sums are separable: those over (z, y) are kept per x for a row
+  // of windows, and those along x come from their prefix sums. Along y, the
+  // (z, y) sums run: the rows leaving the window are taken out and those
+  // entering it are added, so that each plane is read about once per window
+  // along z. Moments are of the data less the mid-range, against
+  // cancellation. With few windows along z (e.g., 2D), their rows along y
+  // are split in bands, each starting its running sums anew.
+  auto const nband = std::min<size_t>(
+      my, (4 * (size_t)psz::cpu::nthread() - 1) / mz + 1);
+  auto const band = (my - 1) / nband + 1;
+  std::vector<f8> sum(mz * nband, 0.0);
+  psz::cpu::parallel_for(mz * nband, [&](size_t u) {
+    auto const iz = u / nband, iy0 = u % nband * band;
+    auto const iy1 = std::min(iy0 + band, my);
+    enum { A, B, AA, BB, AB, NMOMENT };
+    std::vector<f8> r(NMOMENT * nx, 0.0), p(NMOMENT * (nx + 1));
+    f8 acc = 0;
+
+    // the rows [y0, y1) of the window along z, into `r` with the sign of `w`
+    auto rows = [&](size_t y0, size_t y1, f8 w) {
+      for (auto z = iz * s; z < iz * s + wz; z++)
+        for (auto y = y0; y < y1; y++) {
+          auto o = odata + (z * ny + y) * nx, x = xdata + (z * ny + y) * nx;
+          for (size_t i = 0; i < nx; i++) {
+            f8 a = o[i] - sh, b = x[i] - sh;
+            r[A * nx + i] += w * a, r[B * nx + i] += w * b;
+            r[AA * nx + i] += w * a * a, r[BB * nx + i] += w * b * b;
+            r[AB * nx + i] += w * a * b;
+          }
+        }
+    };
+
+    for (auto iy = iy0; iy < iy1; iy++) {
+      auto y0 = iy * s;
+      if (iy == iy0 or s >= wy) {
+        std::fill(r.begin(), r.end(), 0.0);
+        rows(y0, y0 + wy, 1);
+      }
+      else {
+        rows(y0 - s, y0, -1);
+        rows(y0 - s + wy, y0 + wy, 1);
+      }
+
+      for (int m = 0; m < NMOMENT; m++) {
+        auto pm = p.data() + m * (nx + 1);
+        pm[0] = 0;
+        for (size_t i = 0; i < nx; i++) pm[i + 1] = pm[i] + r[m * nx + i];
+      }
+
+      for (size_t ix = 0; ix < mx; ix++) {
+        auto box = [&](int m) {
+          auto pm = p.data() + m * (nx + 1);
+          return pm[ix * s + wx] - pm[ix * s];
+        };
+        auto mu_a = box(A) / n, mu_b = box(B) / n;
+        auto var_a = std::max(box(AA) / n - mu_a * mu_a, 0.0);
+        auto var_b = std::max(box(BB) / n - mu_b * mu_b, 0.0);
+        auto cov = box(AB) / n - mu_a * mu_b;
+        auto mu_o = mu_a + sh, mu_x = mu_b + sh;
+
+        auto num = (2 * mu_o * mu_x + C1) * (2 * cov + C2);
+        auto den = (mu_o * mu_o + mu_x * mu_x + C1) * (var_a + var_b + C2);
+        acc += den > 0 ? num / den : 1.0;
+      }
+    }
+    sum[u] = acc;
+  });
+
+  f8 total = 0;
+  for (auto v : sum) total += v;
+  return total / ((f8)mx * my * mz);
+}
+
+template <typename T>
+void error_autocorr_cpu(
+    T const* xdata, T const* odata, psz_dim3 const len3, int const* lags,
+    int const nlag, f8* out)
+{
+  size_t const nx = len3.x, ny = len3.y, nz = len3.z;
+  size_t const len = nx * ny * nz;
+  for (auto i = 0; i < nlag; i++)
+    if (lags[i] < 0)
+      throw std::runtime_error(
+          "[psz::error::autocorr] Lags must not be negative.");
+
+  f8 mu, var;
+  error_moments(xdata, odata, len, mu, var);
+
+  auto e = [&](size_t i) { return (f8)xdata[i] - odata[i] - mu; };
+
+  // rows of x, SPATIAL_ROWS to a task
+  auto nrow = ny * nz;
+  auto ntask = (nrow - 1) / SPATIAL_ROWS + 1;
+  std::vector<f8> part(ntask * nlag * 3, 0.0);
+
+  psz::cpu::parallel_for(ntask, [&](size_t t) {
+    auto acc = part.data() + t * nlag * 3;
+    for (auto r = t * SPATIAL_ROWS; r < std::min(nrow, (t + 1) * SPATIAL_ROWS);
+         r++) {
+      auto z = r / ny, y = r % ny, base = r * nx;
+      for (auto i = 0; i < nlag; i++) {
+        size_t k = lags[i];
+        f8 sx = 0, sy = 0, sz = 0;
+        if (k < nx)
+          for (size_t x = 0; x < nx - k; x++)
+            sx += e(base + x) * e(base + x + k);
+        if (y + k < ny)
+          for (size_t x = 0; x < nx; x++)
+            sy += e(base + x) * e(base + k * nx + x);
+        if (z + k < nz)
+          for (size_t x = 0; x < nx; x++)
+            sz += e(base + x) * e(base + k * nx * ny + x);
+        acc[3 * i] += sx, acc[3 * i + 1] += sy, acc[3 * i + 2] += sz;
+      }
+    }
+  });
+
+  size_t const n3[3] = {nx, ny, nz};
+  for (auto i = 0; i < nlag; i++)
+    for (auto a = 0; a < 3; a++) {
+      size_t k = lags[i];
+      if (k >= n3[a] or var == 0) {
+        out[3 * i + a] = NaN;
+        continue;
+      }
+      f8 s = 0;
+      for (size_t t = 0; t < ntask; t++) s += part[(t * nlag + i) * 3 + a];
+      auto npair = (f8)len / n3[a] * (n3[a] - k);
+      out[3 * i + a] = s / npair / var;
+    }
+}
+
+template <typename T>
+void error_spectrum_cpu(
+    T const* xdata, T const* odata, psz_dim3 const len3,
+    f8 out[3][SPECTRUM_NBAND])
+{
+  size_t const nx = len3.x, ny = len3.y, nz = len3.z;
+  size_t const len = nx * ny * nz;
+
+  f8 mu, var;
+  error_moments(xdata, odata, len, mu, var);
+  auto const energy = var * len;
+
+  for (auto a = 0; a < 3; a++) {
+    // lines along the axis, `W` at a time from consecutive x for y and z
+    size_t n, stride, W, ngroup;
+    if (a == 0)
+      n = nx, stride = 1, W = 1, ngroup = ny * nz;
+    else {
+      n = a == 1 ? ny : nz, stride = a == 1 ? nx : nx * ny;
+      W = SPATIAL_LANE;
+      ngroup = (a == 1 ? nz : ny) * ((nx - 1) / W + 1);
+    }
+
+    int nlevel = 0;
+    for (auto m = n; m >= 2 and nlevel < SPECTRUM_NBAND; m /= 2) nlevel++;
+    if (nlevel == 0 or energy == 0) {
+      std::fill(out[a], out[a] + SPECTRUM_NBAND, NaN);
+      continue;
+    }
+
+    auto ntask = (ngroup - 1) / SPATIAL_ROWS + 1;
+    std::vector<f8> part(ntask * SPECTRUM_NBAND, 0.0);
+
+    psz::cpu::parallel_for(ntask, [&](size_t t) {
+      std::vector<f8> buf(n * W);
+      auto E = part.data() + t * SPECTRUM_NBAND;
+      auto const r2 = 1 / std::sqrt(2.0);
+
+      for (auto g = t * SPATIAL_ROWS;
+           g < std::min(ngroup, (t + 1) * SPATIAL_ROWS); g++) {
+        size_t base, w;
+        if (a == 0)
+          base = g * nx, w = 1;
+        else {
+          auto nxg = (nx - 1) / W + 1;
+          auto outer = g / nxg, x0 = (g % nxg) * W;
+          base = (a == 1 ? outer * nx * ny : outer * nx) + x0;
+          w = std::min(W, nx - x0);
+        }
+
+        for (size_t i = 0; i < n; i++)
+          for (size_t l = 0; l < w; l++) {
+            auto j = base + i * stride + l;
+            buf[i * W + l] = (f8)xdata[j] - odata[j] - mu;
+          }
+
+        // in place: the approximation goes to the front half
+        auto m = n;
+        for (auto b = 0; b < nlevel; b++, m /= 2)
+          for (size_t i = 0; i < m / 2; i++)
+            for (size_t l = 0; l < w; l++) {
+              auto a0 = buf[2 * i * W + l], a1 = buf[(2 * i + 1) * W + l];
+              auto d = (a0 - a1) * r2;
+              E[b] += d * d;
+              buf[i * W + l] = (a0 + a1) * r2;
+            }
+      }
+    });
+
+    for (auto b = 0; b < SPECTRUM_NBAND; b++) {
+      if (b >= nlevel) {
+        out[a][b] = NaN;
+        continue;
+      }
+      f8 s = 0;
+      for (size_t t = 0; t < ntask; t++) s += part[t * SPECTRUM_NBAND + b];
+      out[a][b] = s / energy;
+    }
+  }
+}
+
+}  // namespace detail
+}  // namespace psz
+
+template <typename T>
+f8 psz::cppstd_ssim(
+    T const* xdata, T const* odata, psz_dim3 const len3, int const window,
+    int const shift, float* time)
+{
+  auto a = hires::now();
+  auto ssim = detail::ssim_cpu<T>(xdata, odata, len3, window, shift);
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+  return ssim;
+}
+
+template <typename T>
+void psz::cppstd_error_autocorr(
+    T const* xdata, T const* odata, psz_dim3 const len3, int const* lags,
+    int const nlag, f8* out, float* time)
+{
+  auto a = hires::now();
+  detail::error_autocorr_cpu<T>(xdata, odata, len3, lags, nlag, out);
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+template <typename T>
+void psz::cppstd_error_spectrum(
+    T const* xdata, T const* odata, psz_dim3 const len3,
+    f8 out[3][SPECTRUM_NBAND], float* time)
+{
+  auto a = hires::now();
+  detail::error_spectrum_cpu<T>(xdata, odata, len3, out);
+  auto b = hires::now();
+  if (time) *time = static_cast<duration_t>(b - a).count() * 1000;
+}
+
+#define SPECIALIZE_SPATIAL(T)                                               \
+  template f8 psz::cppstd_ssim<T>(                                          \
+      T const* xdata, T const* odata, psz_dim3 const len3,                  \
+      int const window, int const shift, float* time);                      \
+  template void psz::cppstd_error_autocorr<T>(                              \
+      T const* xdata, T const* odata, psz_dim3 const len3, int const* lags, \
+      int const nlag, f8* out, float* time);                                \
+  template void psz::cppstd_error_spectrum<T>(                              \
+      T const* xdata, T const* odata, psz_dim3 const len3,                  \
+      f8 out[3][SPECTRUM_NBAND], float* time);
+
+SPECIALIZE_SPATIAL(f4);
+SPECIALIZE_SPATIAL(f8);
+
+#undef SPECIALIZE_SPATIAL
@@ -0,0 +1,329 @@
+/**
+ * @file subdomain.cc
+ * @author Jiannan Tian
+ * @brief Domain-decomposed compression: the eb and the histogram of the
+ * global field across ranks, subdomain archives, and their merge into one
+ * indexed archive.
+ * @version 0.4
+ * @date 2023-10-01
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "context.h"
+#include "cusz.h"
+#include "cusz/type.h"
+#include "stat/compare_cpu.hh"
+
+namespace {
+
+char const sub_magic[8] = "PSZSUB1";
+char const merged_magic[8] = "PSZMRG1";
+
+struct file_comm {
+  std::string dir;
+  f8 timeout;  // in seconds, for the values of each other rank
+  size_t round{0};
+};
+
+std::string round_file(file_comm const& c, size_t round, int rank)
+{
+  return c.dir + "/" + std::to_string(round) + "." + std::to_string(rank);
+}
+
+// Each rank writes its values for the round, then reads those of all ranks
+// in rank order, so that every rank folds them the same way and ends with
+// the same bits. A rank that has not written within the timeout fails the
+// reduction, rather than holding the others forever.
+int file_allreduce(psz_comm* comm, f8* v, size_t n, psz_reduce_op op)
+{
+  auto c = (file_comm*)comm->impl;
+  auto round = c->round++;
+
+  // written under another name and then renamed, so it is seen whole
+  auto mine = round_file(*c, round, comm->rank);
+  {
+    std::ofstream f(mine + ".tmp", std::ios::binary);
+    f.write((char*)v, n * sizeof(f8));
+    if (not f) return 1;
+  }
+  if (std::rename((mine + ".tmp").c_str(), mine.c_str())) return 1;
+
+  std::vector<f8> acc(n), other(n);
+  for (auto r = 0; r < comm->nrank; r++) {
+    auto src = other.data();
+    if (r == comm->rank)
+      src = v;
+    else {
+      std::ifstream f;
+      auto const fname = round_file(*c, round, r);
+      auto const deadline = std::chrono::steady_clock::now() +
+                            std::chrono::duration<f8>(c->timeout);
+      while (true) {
+        f.open(fname, std::ios::binary);
+        if (f) break;
+        if (std::chrono::steady_clock::now() > deadline) {
+          fprintf(
+              stderr,
+              "[psz::error::comm] rank %d: nothing from rank %d in %g s.\n",
+              comm->rank, r, c->timeout);
+          return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      f.read((char*)other.data(), n * sizeof(f8));
+      if (not f) return 1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      if (r == 0)
+        acc[i] = src[i];
+      else if (op == ReduceSum)
+        acc[i] += src[i];
+      else if (op == ReduceMin)
+        acc[i] = std::min(acc[i], src[i]);
+      else
+        acc[i] = std::max(acc[i], src[i]);
+    }
+  }
+
+  std::copy(acc.begin(), acc.end(), v);
+  return 0;
+}
+
+size_t volume(uint32_t const l[3]) { return (size_t)l[0] * l[1] * l[2]; }
+
+bool overlap(psz_subdomain const& a, psz_subdomain const& b)
+{
+  for (auto d = 0; d < 3; d++)
+    if (a.offset[d] + a.len[d] <= b.offset[d] or
+        b.offset[d] + b.len[d] <= a.offset[d])
+      return false;
+  return true;
+}
+
+bool read_index(std::ifstream& f, std::vector<psz_subdomain>& subs)
+{
+  char magic[8];
+  uint32_t n;
+  f.read(magic, 8);
+  f.read((char*)&n, sizeof(n));
+  if (not f or memcmp(magic, merged_magic, 8)) return false;
+  subs.resize(n);
+  f.read((char*)subs.data(), n * sizeof(psz_subdomain));
+  return (bool)f;
+}
+
+}  // namespace
+
+psz_comm* psz_comm_file_create(
+    char const* dir, int rank, int nrank, double timeout)
+{
+  if (rank < 0 or rank >= nrank)
+    throw std::runtime_error("[psz::error::comm] rank out of range.");
+
+  auto comm = new psz_comm;
+  comm->rank = rank, comm->nrank = nrank;
+  comm->allreduce = file_allreduce;
+  comm->impl = new file_comm{dir, timeout > 0 ? timeout : 60};
+  return comm;
+}
+
+pszerror psz_comm_release(psz_comm* comm)
+{
+  if (comm->allreduce == file_allreduce) delete (file_comm*)comm->impl;
+  delete comm;
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_global_eb(psz_comm* comm, pszctx* ctx, void* data, pszlen len)
+{
+  if (ctx->mode != Rel) return CUSZ_SUCCESS;
+
+  // as one max-reduction of -min and max; an empty subdomain adds nothing
+  auto n = (size_t)len.x * len.y * len.z;
+  f8 v[2] = {
+      -std::numeric_limits<f8>::infinity(),
+      -std::numeric_limits<f8>::infinity()};
+  if (n and ctx->dtype == F4) {
+    f4 res[4];
+    psz::cppstd_extrema<f4>((f4*)data, n, res);
+    v[0] = -res[0], v[1] = res[1];
+  }
+  else if (n and ctx->dtype == F8) {
+    f8 res[4];
+    psz::cppstd_extrema<f8>((f8*)data, n, res);
+    v[0] = -res[0], v[1] = res[1];
+  }
+  else if (ctx->dtype != F4 and ctx->dtype != F8)
+    return CUSZ_FAIL_UNSUPPORTED_DATATYPE;
+
+  if (comm->allreduce(comm, v, 2, ReduceMax))
+    return CUSZ_FAIL_ONDISK_FILE_ERROR;
+
+  ctx->eb *= v[1] + v[0];
+  ctx->mode = Abs;
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_histogram_reduce(psz_comm* comm, uint32_t* freq, int bklen)
+{
+  // counts are exact in double, far beyond what a bin of u4 holds
+  std::vector<f8> v(freq, freq + bklen);
+  if (comm->allreduce(comm, v.data(), bklen, ReduceSum))
+    return CUSZ_FAIL_ONDISK_FILE_ERROR;
+
+  for (auto i = 0; i < bklen; i++) {
+    if (v[i] > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error(
+          "[psz::error::comm] A summed bin overflows the histogram.");
+    freq[i] = v[i];
+  }
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_subdomain_write(
+    char const* fname, psz_subdomain const* sub, void* archive, size_t bytes)
+{
+  auto rec = *sub;
+  rec.begin = sizeof(sub_magic) + sizeof(rec), rec.bytes = bytes;
+
+  std::ofstream f(fname, std::ios::binary);
+  f.write(sub_magic, sizeof(sub_magic));
+  f.write((char*)&rec, sizeof(rec));
+  f.write((char*)archive, bytes);
+  return f ? CUSZ_SUCCESS : CUSZ_FAIL_ONDISK_FILE_ERROR;
+}
+
+pszerror psz_merge(char const* fname, char const** subfiles, int n)
+{
+  std::vector<psz_subdomain> subs(n);
+  for (auto i = 0; i < n; i++) {
+    std::ifstream f(subfiles[i], std::ios::binary);
+    char magic[8];
+    f.read(magic, 8);
+    f.read((char*)&subs[i], sizeof(psz_subdomain));
+    if (not f) return CUSZ_FAIL_ONDISK_FILE_ERROR;
+    if (memcmp(magic, sub_magic, 8))
+      throw std::runtime_error(
+          "[psz::error::merge] " + std::string(subfiles[i]) +
+          " is not a subdomain archive.");
+  }
+
+  // one of each rank, and the boxes tile the global field
+  std::vector<int> order(n);
+  for (auto i = 0; i < n; i++) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return subs[a].rank < subs[b].rank;
+  });
+
+  size_t covered = 0;
+  for (auto k = 0; k < n; k++) {
+    auto& s = subs[order[k]];
+    auto same_global = std::equal(s.global, s.global + 3, subs[0].global);
+    if (s.rank != k or s.nrank != n or not same_global)
+      throw std::runtime_error(
+          "[psz::error::merge] Expected ranks 0 to " + std::to_string(n - 1) +
+          " of one global field.");
+    for (auto d = 0; d < 3; d++)
+      if (s.offset[d] + s.len[d] > s.global[d])
+        throw std::runtime_error(
+            "[psz::error::merge] Subdomain of rank " +
+            std::to_string(s.rank) + " is out of the global field.");
+    for (auto j = 0; j < k; j++)
+      if (overlap(s, subs[order[j]]))
+        throw std::runtime_error(
+            "[psz::error::merge] Subdomains of ranks " +
+            std::to_string(j) + " and " + std::to_string(k) + " overlap.");
+    covered += volume(s.len);
+  }
+  if (n and covered != volume(subs[0].global))
+    throw std::runtime_error(
+        "[psz::error::merge] Subdomains do not cover the global field.");
+
+  // the index, in rank order, and then the archives
+  std::vector<psz_subdomain> index(n);
+  auto begin = sizeof(merged_magic) + sizeof(uint32_t) +
+               n * sizeof(psz_subdomain);
+  for (auto k = 0; k < n; k++) {
+    index[k] = subs[order[k]];
+    index[k].begin = begin;
+    begin += index[k].bytes;
+  }
+
+  std::ofstream out(fname, std::ios::binary);
+  uint32_t count = n;
+  out.write(merged_magic, sizeof(merged_magic));
+  out.write((char*)&count, sizeof(count));
+  out.write((char*)index.data(), n * sizeof(psz_subdomain));
+
+  std::vector<char> buf(1 << 26);
+  for (auto k = 0; k < n; k++) {
+    auto& s = subs[order[k]];
+    std::ifstream f(subfiles[order[k]], std::ios::binary);
+    f.seekg(s.begin);
+    for (size_t left = s.bytes; left and f and out;) {
+      auto chunk = std::min(left, buf.size());
+      f.read(buf.data(), chunk);
+      out.write(buf.data(), chunk);
+      left -= chunk;
+    }
+    if (not f) return CUSZ_FAIL_ONDISK_FILE_ERROR;
+  }
+
+  return out ? CUSZ_SUCCESS : CUSZ_FAIL_ONDISK_FILE_ERROR;
+}
+
+pszerror psz_merged_index(char const* fname, psz_subdomain* subs, int* n)
+{
+  std::ifstream f(fname, std::ios::binary);
+  std::vector<psz_subdomain> index;
+  if (not read_index(f, index)) return CUSZ_FAIL_ONDISK_FILE_ERROR;
+
+  *n = index.size();
+  if (subs) std::copy(index.begin(), index.end(), subs);
+  return CUSZ_SUCCESS;
+}
+
+pszerror psz_merged_read(
+    char const* fname, int k, void* archive, size_t* bytes)
+{
+  std::ifstream f(fname, std::ios::binary);
+  std::vector<psz_subdomain> index;
+  if (not read_index(f, index)) return CUSZ_FAIL_ONDISK_FILE_ERROR;
+  if (k < 0 or k >= (int)index.size())
+    throw std::runtime_error("[psz::error::merge] No such subdomain.");
+
+  *bytes = index[k].bytes;
+  if (not archive) return CUSZ_SUCCESS;
+
+  f.seekg(index[k].begin);
+  f.read((char*)archive, index[k].bytes);
+  return f ? CUSZ_SUCCESS : CUSZ_FAIL_ONDISK_FILE_ERROR;
+}
+
+int psz_subdomain_locate(
+    psz_subdomain const* subs, int n, uint32_t x, uint32_t y, uint32_t z)
+{
+  uint32_t p[3] = {x, y, z};
+  for (auto k = 0; k < n; k++) {
+    auto in = true;
+    for (auto d = 0; d < 3; d++)
+      in = in and p[d] >= subs[k].offset[d] and
+           p[d] < subs[k].offset[d] + subs[k].len[d];
+    if (in) return k;
+  }
+  return -1;
+}
@@ -35,6 +35,74 @@ add_executable(l2_serial src/test_l2_serial.cc)
 target_link_libraries(l2_serial PRIVATE psztestcompile_settings)
 add_test(test_l2_serial l2_serial)
 
+add_executable(l2_ans src/test_l2_ans.cc)
+target_link_libraries(l2_ans PRIVATE psztestcompile_settings pszans_cpu
+                                     pszkernel_ser pszhfbook_ser)
+add_test(test_l2_ans l2_ans)
+
+add_executable(l2_rle src/test_l2_rle.cc)
+target_link_libraries(l2_rle PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_rle l2_rle)
+
+add_executable(l2_l23int src/test_l2_l23int.cc)
+target_link_libraries(l2_l23int PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_l23int l2_l23int)
+
+add_executable(l2_l23half src/test_l2_l23half.cc)
+target_link_libraries(l2_l23half PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_l23half l2_l23half)
+add_executable(l2_logtr src/test_l2_logtr.cc)
+target_link_libraries(l2_logtr PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_logtr l2_logtr)
+add_executable(l2_binning src/test_l2_binning.cc)
+target_link_libraries(l2_binning PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_binning l2_binning)
+add_executable(l2_prog src/test_l2_prog.cc)
+target_link_libraries(l2_prog PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_prog l2_prog)
+add_executable(l2_tile src/test_l2_tile.cc)
+target_link_libraries(l2_tile PRIVATE psztestcompile_settings pszkernel_cpu)
+add_test(test_l2_tile l2_tile)
+
+add_executable(l2_subdomain src/test_l2_subdomain.cc)
+target_link_libraries(l2_subdomain PRIVATE psztestcompile_settings pszutils_ser)
+add_test(test_l2_subdomain l2_subdomain)
+
+add_executable(l2_async src/test_l2_async.cc)
+target_link_libraries(l2_async PRIVATE psztestcompile_settings Threads::Threads)
+add_test(test_l2_async l2_async)
+
+add_executable(l2_sharedbook src/test_l2_sharedbook.cc)
+target_link_libraries(l2_sharedbook PRIVATE psztestcompile_settings
+                                            pszkernel_cpu pszutils_ser)
+add_test(test_l2_sharedbook l2_sharedbook)
+
+add_executable(l2_dryrun src/test_l2_dryrun.cc)
+target_link_libraries(l2_dryrun PRIVATE psztestcompile_settings pszkernel_cpu
+                                        pszstat_ser)
+add_test(test_l2_dryrun l2_dryrun)
+
+add_executable(l2_estimate src/test_l2_estimate.cc)
+target_link_libraries(l2_estimate PRIVATE psztestcompile_settings
+                                          pszkernel_cpu)
+add_test(test_l2_estimate l2_estimate)
+
+add_executable(l2_assess src/test_l2_assess.cc)
+target_link_libraries(l2_assess PRIVATE psztestcompile_settings pszstat_ser)
+add_test(test_l2_assess l2_assess)
+
+add_executable(l2_verify src/test_l2_verify.cc)
+target_link_libraries(l2_verify PRIVATE psztestcompile_settings pszstat_ser)
+add_test(test_l2_verify l2_verify)
+
+add_executable(l2_spatial src/test_l2_spatial.cc)
+target_link_libraries(l2_spatial PRIVATE psztestcompile_settings pszstat_ser)
+add_test(test_l2_spatial l2_spatial)
+
+add_executable(l2_hfbook src/test_l2_hfbook.cc)
+target_link_libraries(l2_hfbook PRIVATE psztestcompile_settings pszhfbook_ser)
+add_test(test_l2_hfbook l2_hfbook)
+
 add_executable(l2_cudaproto src/test_l2_cudaproto_hip.cpp)
 target_link_libraries(
   l2_cudaproto PRIVATE pszcompile_settings psztestcompile_settings pszmem
@@ -65,6 +133,23 @@ target_link_libraries(
           pszmem)
 add_test(test_l3_lorenzosp l3_lorenzosp)
 
+# Level-3 compressor (high-level API)
+add_executable(l3_batch src/test_l3_batch.cc)
+target_link_libraries(l3_batch PRIVATE psztestcompile_settings hipsz)
+add_test(test_l3_batch l3_batch)
+
+add_executable(l3_async src/test_l3_async.cc)
+target_link_libraries(l3_async PRIVATE psztestcompile_settings hipsz)
+add_test(test_l3_async l3_async)
+
+add_executable(l3_reentrant src/test_l3_reentrant.cc)
+target_link_libraries(l3_reentrant PRIVATE psztestcompile_settings hipsz)
+add_test(test_l3_reentrant l3_reentrant)
+
+add_executable(l3_sharedbook src/test_l3_sharedbook.cc)
+target_link_libraries(l3_sharedbook PRIVATE psztestcompile_settings hipsz)
+add_test(test_l3_sharedbook l3_sharedbook)
+
 add_executable(statfn src/test_statfn.cc)
 target_link_libraries(statfn PRIVATE psztestcompile_settings psz_testutils
                                      pszstat_hip pszstat_ser pszmem)
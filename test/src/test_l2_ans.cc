@@ -0,0 +1,121 @@
+/**
+ * @file test_l2_ans.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-12
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <random>
+
+#include "ans/ans.hh"
+#include "busyheader.hh"
+#include "hf/hf_bk.hh"
+#include "hf/hf_word.hh"
+#include "kernel/hist.hh"
+
+using E = u4;
+using H = u4;
+
+int const radius = 512;
+int const bklen = radius * 2;
+
+// quant-codes centered at `radius`, with `p_center` of them hitting the
+// center and the rest two-sided geometric
+void fill_skewed(E* eq, size_t len, double p_center, int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::geometric_distribution<int> g(0.5);
+
+  for (size_t i = 0; i < len; i++) {
+    if (u(gen) < p_center) { eq[i] = radius; }
+    else {
+      auto d = 1 + std::min(g(gen), radius - 2);
+      eq[i] = u(gen) < 0.5 ? radius - d : radius + d;
+    }
+  }
+}
+
+f8 hf_avg_bits(u4* hist, size_t len)
+{
+  auto book = new H[bklen];
+  auto revbook_bytes = sizeof(H) * (2 * 8 * sizeof(H)) + sizeof(E) * bklen;
+  auto revbook = new u1[revbook_bytes];
+  float t;
+  psz::hf_buildbook<CPU, E, H>(
+      hist, bklen, book, revbook, revbook_bytes, &t);
+
+  f8 bits = 0;
+  for (auto i = 0; i < bklen; i++) {
+    if (hist[i] == 0) continue;
+    bits += 1.0 * hist[i] / len * ((PackedWordByWidth<4>*)(&book[i]))->bits;
+  }
+
+  delete[] book;
+  delete[] revbook;
+  return bits;
+}
+
+bool test_roundtrip(
+    size_t len, int sublen, double p_center, bool expect_gain = true)
+{
+  auto eq = new E[len];
+  auto xeq = new E[len];
+  auto hist = new u4[bklen];
+  memset(hist, 0, sizeof(u4) * bklen);
+  memset(xeq, 0, sizeof(E) * len);
+
+  fill_skewed(eq, len, p_center, len);
+
+  float t_hist, t_enc, t_dec;
+  psz::histogram<CPU, E>(eq, len, hist, bklen, &t_hist);
+
+  auto bound = psz::ans_encoded_bound(len, bklen, sublen);
+  auto out = new u1[bound];
+  size_t outlen;
+
+  psz::ans_encode<CPU, E>(eq, len, hist, bklen, sublen, out, &outlen, &t_enc);
+  psz::ans_decode<CPU, E>(out, xeq, &t_dec);
+
+  auto identical = std::equal(eq, eq + len, xeq);
+  auto ans_bits = 8.0 * outlen / len;
+  auto hf_bits = hf_avg_bits(hist, len);
+
+  printf(
+      "len=%zu sublen=%d p_center=%.2f: rANS %.4lf bits/sym (model %.4lf), "
+      "Huffman (serial ref) %.4lf bits/sym\n",
+      len, sublen, p_center, ans_bits, psz::ans_avg_bits(hist, bklen),
+      hf_bits);
+
+  // for skewed histograms rANS should not lose to Huffman
+  auto ok = identical and (not expect_gain or ans_bits < hf_bits);
+  cout << "rANS roundtrip works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] eq;
+  delete[] xeq;
+  delete[] hist;
+  delete[] out;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_roundtrip(1 << 20, 1 << 16, 0.95);
+  all_pass = all_pass and test_roundtrip(1 << 20, 1 << 16, 0.5, false);
+  // tails not aligned to the lanes or the chunk size
+  all_pass = all_pass and test_roundtrip(1000003, 12345, 0.92);
+  all_pass = all_pass and test_roundtrip(37, 16, 0.95, false);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_l2_assess.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-24
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "stat/compare_cpu.hh"
+#include "stat/compare_stream.hh"
+#include "utils/io.hh"
+
+// two passes in long double, as the reference
+template <typename T>
+void reference(pszsummary* s, T* xdata, T* odata, size_t len)
+{
+  long double sum_o = 0, sum_x = 0;
+  for (size_t i = 0; i < len; i++) sum_o += odata[i], sum_x += xdata[i];
+  long double mean_o = sum_o / len, mean_x = sum_x / len;
+
+  long double var_o = 0, var_x = 0, cov = 0, err2 = 0;
+  double max_o = odata[0], min_o = odata[0], max_x = xdata[0],
+         min_x = xdata[0], max_err = -1;
+  size_t idx = 0;
+  for (size_t i = 0; i < len; i++) {
+    long double o = odata[i], x = xdata[i];
+    var_o += (o - mean_o) * (o - mean_o);
+    var_x += (x - mean_x) * (x - mean_x);
+    cov += (o - mean_o) * (x - mean_x);
+    double e = std::fabs((double)xdata[i] - (double)odata[i]);
+    err2 += (long double)e * e;
+    if (e > max_err) max_err = e, idx = i;
+    max_o = std::max<double>(max_o, odata[i]);
+    min_o = std::min<double>(min_o, odata[i]);
+    max_x = std::max<double>(max_x, xdata[i]);
+    min_x = std::min<double>(min_x, xdata[i]);
+  }
+
+  s->len = len;
+  s->odata.max = max_o, s->odata.min = min_o, s->odata.rng = max_o - min_o;
+  s->xdata.max = max_x, s->xdata.min = min_x, s->xdata.rng = max_x - min_x;
+  s->odata.std = std::sqrt(var_o / len), s->xdata.std = std::sqrt(var_x / len);
+  s->max_err.idx = idx, s->max_err.abs = max_err;
+  s->score.coeff = cov / std::sqrt(var_o * var_x);
+  s->score.MSE = err2 / len;
+  s->score.NRMSE = std::sqrt(s->score.MSE) / s->odata.rng;
+  s->score.PSNR = 20 * log10(s->odata.rng) - 10 * log10(s->score.MSE);
+}
+
+template <typename T>
+f8 mean_of(T* x, size_t len)
+{
+  long double sum = 0;
+  for (size_t i = 0; i < len; i++) sum += x[i];
+  return sum / len;
+}
+
+template <typename T>
+bool test_assess(size_t len, double offset)
+{
+  auto x = new T[len];
+  auto o = new T[len];
+
+  // a large offset against a small variation, where one pass of plain sums
+  // would cancel; the error is the largest at a few tied places
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> err(-1e-3, 1e-3);
+  for (size_t i = 0; i < len; i++) {
+    o[i] = offset + sin(0.001 * i) + 0.1 * cos(0.7 * i);
+    x[i] = o[i] + (T)err(gen);
+  }
+  for (auto i : {len / 3, len / 2, len - 1}) x[i] = o[i] + (T)0.5;
+
+  pszsummary ref, s;
+  reference<T>(&ref, x, o, len);
+  psz::cppstd_assess_quality<T>(&s, x, o, len);
+
+  auto close = [](f8 a, f8 b, f8 tol) {
+    return std::fabs(a - b) <= tol * std::max(std::fabs(a), std::fabs(b));
+  };
+  auto ok = s.len == len and s.max_err.idx == ref.max_err.idx and
+            s.max_err.abs == ref.max_err.abs and
+            s.odata.max == ref.odata.max and s.odata.min == ref.odata.min and
+            s.xdata.max == ref.xdata.max and s.xdata.min == ref.xdata.min and
+            close(s.odata.std, ref.odata.std, 1e-9) and
+            close(s.xdata.std, ref.xdata.std, 1e-9) and
+            close(s.score.coeff, ref.score.coeff, 1e-12) and
+            close(s.score.MSE, ref.score.MSE, 1e-12) and
+            close(s.score.NRMSE, ref.score.NRMSE, 1e-12) and
+            close(s.score.PSNR, ref.score.PSNR, 1e-12);
+
+  // streamed from files, in slabs of a few pages and a remainder
+  auto xname = std::string("l2_assess_x.") + typeid(T).name();
+  auto oname = std::string("l2_assess_o.") + typeid(T).name();
+  io::write_array_to_binary<T>(xname, x, len);
+  io::write_array_to_binary<T>(oname, o, len);
+
+  pszsummary st, sx;
+  size_t nslab = 0, slab_len = 0;
+  auto ok_slab = true;
+  psz::stream_assess_quality<T>(
+      &st, xname.c_str(), oname.c_str(), 1 << 16,
+      [&](size_t start, pszsummary const& slab) {
+        ok_slab = ok_slab and start == nslab * slab_len and
+                  slab.max_err.idx >= start and
+                  slab.max_err.idx < start + slab.len;
+        if (nslab++ == 0) slab_len = slab.len;
+      });
+  psz::stream_assess_quality<T>(&sx, x, oname.c_str(), 3 << 20);
+
+  // the extrema, in memory and fused with loading
+  T res[4], res_loaded[4];
+  auto loaded = new T[len];
+  psz::cppstd_extrema<T>(o, len, res);
+  psz::load_with_extrema<T>(oname.c_str(), loaded, len, res_loaded);
+  auto ok_extrema = std::equal(o, o + len, loaded);
+  for (auto r : {res, res_loaded})
+    ok_extrema = ok_extrema and r[0] == (T)ref.odata.min and
+                 r[1] == (T)ref.odata.max and
+                 r[3] == (T)(ref.odata.max - ref.odata.min) and
+                 close(r[2], mean_of(o, len), 1e-6);
+  ok = ok and ok_extrema;
+  delete[] loaded;
+
+  remove(xname.c_str()), remove(oname.c_str());
+
+  for (auto t : {&st, &sx})
+    ok = ok and t->len == len and t->max_err.idx == s.max_err.idx and
+         t->max_err.abs == s.max_err.abs and t->odata.max == s.odata.max and
+         t->xdata.min == s.xdata.min and
+         close(t->score.coeff, s.score.coeff, 1e-12) and
+         close(t->score.NRMSE, s.score.NRMSE, 1e-12) and
+         close(t->score.PSNR, s.score.PSNR, 1e-12);
+  ok = ok and ok_slab and nslab == (len - 1) / slab_len + 1;
+
+  printf(
+      "%s len %zu offset %g: PSNR %.12g (ref %.12g), coeff %.12g (ref "
+      "%.12g), max error at %zu (ref %zu); %zu slabs streamed\n",
+      typeid(T).name(), len, offset, s.score.PSNR, ref.score.PSNR,
+      s.score.coeff, ref.score.coeff, s.max_err.idx, ref.max_err.idx, nslab);
+  cout << "single-pass and streamed assessment, and extrema work as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  delete[] x;
+  delete[] o;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_assess<f4>(1 << 22, 0);
+  all_pass = all_pass and test_assess<f4>(1000003, 100);
+  all_pass = all_pass and test_assess<f8>(1 << 22, 1e6);
+  all_pass = all_pass and test_assess<f8>(77, 1e3);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_l2_async.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-27
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "busyheader.hh"
+#include "utils/async_cpu.hh"
+
+using psz::cpu::executor;
+
+int const ntask = 16;
+
+struct seen {
+  int k;
+  std::atomic<int>* seq;
+  int order{-1};
+  pszerror status{CUSZ_SUCCESS};
+  int polled{0};
+  // for the first: a later task, to wait for from the callback
+  std::future<psz_task*> later;
+  pszerror later_status{CUSZ_SUCCESS};
+  // for the last: that its callback has run
+  std::promise<void> last;
+};
+
+// Notes the order, that the task is done, and releases it; the first tries
+// to wait for a later one, and the last tells the test it is through.
+void on_done(psz_task* task, pszerror status, void* user)
+{
+  auto s = (seen*)user;
+  s->order = (*s->seq)++, s->status = status;
+  s->polled = psz::cpu::task_poll(task);
+  if (s->k == 0) s->later_status = psz::cpu::task_wait(s->later.get());
+  if (s->k == ntask - 1)
+    s->last.set_value();
+  else
+    psz::cpu::task_release(task);
+}
+
+// callbacks in the order of submission, each after its task is done, with
+// the status of the work (incl. that of a throwing one)
+bool test_callback()
+{
+  std::vector<seen> s(ntask);
+  std::atomic<int> seq{0};
+  std::promise<psz_task*> later;
+  s[0].later = later.get_future();
+  auto last_done = s[ntask - 1].last.get_future();
+
+  psz_task* last;
+  for (auto k = 0; k < ntask; k++) {
+    s[k].k = k, s[k].seq = &seq;
+    auto t = executor::get().submit(
+        [k]() -> pszerror {
+          std::this_thread::sleep_for(std::chrono::microseconds(100 * k));
+          if (k == 3) throw std::runtime_error("a failing task");
+          return k == 5 ? CUSZ_FAIL_INCOMPRESSIABLE : CUSZ_SUCCESS;
+        },
+        on_done, &s[k]);
+    if (k == 1) later.set_value(t);
+    if (k == ntask - 1) last = t;
+  }
+  last_done.wait();
+  auto ok = psz::cpu::task_poll(last) == 1 and
+            psz::cpu::task_release(last) == CUSZ_SUCCESS;
+
+  ok = ok and s[0].later_status == CUSZ_FAIL_DATA_NOT_READY;
+  for (auto k = 0; k < ntask; k++) {
+    auto expected = k == 3   ? CUSZ_FAIL_UNSUPPORTED_PIPELINE
+                    : k == 5 ? CUSZ_FAIL_INCOMPRESSIABLE
+                             : CUSZ_SUCCESS;
+    ok = ok and s[k].order == k and s[k].status == expected and
+         s[k].polled == 1;
+  }
+
+  cout << "callbacks in order, each after its task is done, work as "
+          "expected: "
+       << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+// without callbacks: poll before and after, and wait from many threads
+bool test_wait()
+{
+  std::promise<void> gate;
+  auto opened = gate.get_future().share();
+  auto t = executor::get().submit(
+      [opened] {
+        opened.wait();
+        return CUSZ_SUCCESS;
+      },
+      nullptr, nullptr);
+
+  auto ok = psz::cpu::task_poll(t) == 0;
+
+  std::atomic<int> nsuccess{0};
+  std::vector<std::thread> waiters;
+  for (auto i = 0; i < 8; i++)
+    waiters.emplace_back([&] {
+      nsuccess += psz::cpu::task_wait(t) == CUSZ_SUCCESS;
+    });
+  gate.set_value();
+  for (auto& w : waiters) w.join();
+
+  ok = ok and nsuccess == 8 and psz::cpu::task_poll(t) == 1;
+  ok = ok and psz::cpu::task_release(t) == CUSZ_SUCCESS;
+
+  cout << "poll and wait from many threads work as expected: "
+       << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_wait();
+  all_pass = all_pass and test_callback();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
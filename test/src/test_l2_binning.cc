@@ -0,0 +1,90 @@
+/**
+ * @file test_l2_binning.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-21
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/binning.hh"
+
+// one bin at a time, the obvious way
+template <typename T>
+T bin_average(
+    T* in, psz_dim3 len3, int bx, int by, size_t ix, size_t iy, size_t iz)
+{
+  f8 sum = 0;
+  size_t n = 0;
+  for (size_t j = iy * by; j < std::min<size_t>((iy + 1) * by, len3.y); j++)
+    for (size_t i = ix * bx; i < std::min<size_t>((ix + 1) * bx, len3.x);
+         i++, n++)
+      sum += in[(iz * len3.y + j) * len3.x + i];
+  return sum / n;
+}
+
+template <typename T>
+bool test_binning(psz_dim3 len3, pszpreprocess type)
+{
+  int bx, by;
+  psz::binning_factor(type, &bx, &by);
+  auto len3_out = psz::binning_len3(len3, bx, by);
+  size_t len = len3.x * len3.y * len3.z;
+  size_t len_out = len3_out.x * len3_out.y * len3_out.z;
+
+  auto in = new T[len];
+  auto out = new T[len_out];
+  for (size_t i = 0; i < len; i++) in[i] = sin(0.01 * i) + 0.001 * (i % 7);
+
+  float t;
+  psz::binning<T>(in, len3, bx, by, out, &t);
+
+  auto ok = true;
+  for (size_t iz = 0; iz < len3_out.z; iz++)
+    for (size_t iy = 0; iy < len3_out.y; iy++)
+      for (size_t ix = 0; ix < len3_out.x; ix++) {
+        auto id = (iz * len3_out.y + iy) * len3_out.x + ix;
+        ok = ok and out[id] == bin_average(in, len3, bx, by, ix, iy, iz);
+      }
+
+  printf(
+      "%s %ux%ux%u bin %dx%d -> %ux%ux%u\n", typeid(T).name(), len3.x, len3.y,
+      len3.z, bx, by, len3_out.x, len3_out.y, len3_out.z);
+  cout << "binning works as expected: " << (ok ? "yes" : "NO") << endl;
+
+  delete[] in;
+  delete[] out;
+
+  return ok;
+}
+
+template <typename T>
+bool test_type()
+{
+  auto all_pass = true;
+  for (auto type : {Binning2x2, Binning2x1, Binning1x2}) {
+    all_pass = all_pass and test_binning<T>({1000001, 1, 1}, type);
+    all_pass = all_pass and test_binning<T>({3600, 1800, 1}, type);
+    all_pass = all_pass and test_binning<T>({101, 99, 37}, type);
+  }
+  return all_pass;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_type<f4>();
+  all_pass = all_pass and test_type<f8>();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file test_l2_dryrun.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/dryrun.hh"
+#include "stat/compare_cpu.hh"
+
+template <typename T>
+bool test_dryrun(size_t len, f8 eb)
+{
+  auto x = new T[len];
+  auto xr = new T[len];
+  for (size_t i = 0; i < len; i++)
+    x[i] = 100 * sin(0.0001 * i) + cos(0.37 * i) + 3;
+
+  // the round trip, then assessed separately
+  T ebx2 = eb * 2, ebx2_r = 1 / (eb * 2);
+  for (size_t i = 0; i < len; i++) xr[i] = std::round(x[i] * ebx2_r) * ebx2;
+  pszsummary ref, s;
+  psz::cppstd_assess_quality<T>(&ref, xr, x, len);
+
+  float t;
+  psz::dryrun_assess<T>(x, len, eb, &s, &t);
+
+  auto close = [](f8 a, f8 b) {
+    return std::fabs(a - b) <= 1e-6 * std::max(std::fabs(a), std::fabs(b));
+  };
+  auto ok = s.len == len and s.max_err.abs <= eb * (1 + 1e-6) + 1e-5 and
+            close(s.max_err.abs, ref.max_err.abs) and
+            s.max_err.idx == ref.max_err.idx and
+            close(s.max_err.pwrrel, ref.max_err.pwrrel) and
+            close(s.odata.min, ref.odata.min) and
+            close(s.odata.max, ref.odata.max) and
+            close(s.odata.std, ref.odata.std) and
+            close(s.xdata.min, ref.xdata.min) and
+            close(s.xdata.std, ref.xdata.std) and
+            close(s.score.MSE, ref.score.MSE) and
+            close(s.score.PSNR, ref.score.PSNR) and
+            close(s.score.coeff, ref.score.coeff);
+
+  printf(
+      "%s len %zu eb %g: PSNR %g (ref %g), max error %g at %zu, %.3f ms\n",
+      typeid(T).name(), len, eb, s.score.PSNR, ref.score.PSNR,
+      s.max_err.abs, s.max_err.idx, t);
+  cout << "fused dryrun works as expected: " << (ok ? "yes" : "NO") << endl;
+
+  delete[] x;
+  delete[] xr;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_dryrun<f4>(1 << 20, 1e-2);
+  all_pass = all_pass and test_dryrun<f4>(1000003, 1e-1);
+  all_pass = all_pass and test_dryrun<f8>(1 << 20, 1e-4);
+  all_pass = all_pass and test_dryrun<f8>(77, 1e-3);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file test_l2_estimate.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-23
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/dryrun.hh"
+#include "kernel/estimate.hh"
+
+template <typename T>
+void field(T* x, psz_dim3 len3)
+{
+  std::mt19937 gen(7);
+  std::normal_distribution<double> noise(0, 0.01);
+  for (size_t iz = 0; iz < len3.z; iz++)
+    for (size_t iy = 0; iy < len3.y; iy++)
+      for (size_t ix = 0; ix < len3.x; ix++)
+        x[(iz * len3.y + iy) * len3.x + ix] =
+            10 * sin(0.02 * ix) * cos(0.03 * iy) + 5 * sin(0.05 * iz + 1) +
+            noise(gen);
+}
+
+template <typename T>
+bool test_estimate(psz_dim3 len3, int radius)
+{
+  size_t len = (size_t)len3.x * len3.y * len3.z;
+  auto x = new T[len];
+  field(x, len3);
+
+  auto close = [](f8 a, f8 b, f8 tol) {
+    return std::fabs(a - b) <= tol * std::max(std::fabs(a), std::fabs(b));
+  };
+
+  // the samples against the whole field, at a few eb
+  psz::sampler<T> sampled(x, len3), whole(x, len3, 1.0);
+  auto ok_sampled = true;
+  for (auto eb : {1e-4, 1e-3, 1e-2}) {
+    auto s = sampled.lorenzo(eb, radius), w = whole.lorenzo(eb, radius);
+    printf(
+        "  eb %g: CR %.3f (whole %.3f), outlier %.4f (whole %.4f), PSNR "
+        "%.2f (whole %.2f)\n",
+        eb, s.cr, w.cr, s.outlier, w.outlier, s.psnr, w.psnr);
+    ok_sampled = ok_sampled and close(s.cr, w.cr, 0.15) and
+                 std::fabs(s.outlier - w.outlier) < 0.02;
+  }
+
+  // eb for a PSNR target, checked with a full round trip
+  pszestimate est;
+  float t_psnr, t_cr, t_dryrun;
+  auto target_psnr = 80.0;
+  auto eb_psnr =
+      psz::autotune_eb<T>(x, len3, radius, 0, target_psnr, &est, &t_psnr);
+  pszsummary stat;
+  psz::dryrun_assess<T>(x, len, eb_psnr, &stat, &t_dryrun);
+  auto ok_psnr = stat.score.PSNR >= target_psnr - 0.1 and
+                 stat.score.PSNR <= target_psnr + 3;
+
+  // eb for a CR target, checked against the whole field
+  auto target_cr = 10.0;
+  auto eb_cr = psz::autotune_eb<T>(x, len3, radius, target_cr, 0, &est, &t_cr);
+  auto cr = whole.lorenzo(eb_cr, radius).cr;
+  auto ok_cr = close(cr, target_cr, 0.15);
+
+  printf(
+      "%s %ux%ux%u: PSNR %g -> eb %g, PSNR %.2f (%.3f ms); CR %g -> eb %g, "
+      "CR %.2f (%.3f ms); a pass of dryrun %.3f ms\n",
+      typeid(T).name(), len3.x, len3.y, len3.z, target_psnr, eb_psnr,
+      stat.score.PSNR, t_psnr, target_cr, eb_cr, cr, t_cr, t_dryrun);
+
+  // spline on the same samples; the error is about uniform in [-eb, eb]
+  auto ok_spline = true;
+  for (auto eb : {1e-3, 1e-2}) {
+    pszestimate l, sp, w = whole.spline(eb, radius);
+    psz::estimate<T>(x, len3, eb, radius, &l, &sp);
+    auto psnr_uniform = 20 * log10(sampled.range() / eb) + 10 * log10(3.0);
+    printf(
+        "  eb %g: spline CR %.3f (whole %.3f), PSNR %.2f (uniform %.2f); "
+        "Lorenzo CR %.3f\n",
+        eb, sp.cr, w.cr, sp.psnr, psnr_uniform, l.cr);
+    ok_spline = ok_spline and close(sp.cr, w.cr, 0.15) and
+                std::fabs(sp.psnr - psnr_uniform) < 1;
+  }
+
+  // the choice follows the estimates, and is Lorenzo unless 3D
+  pszestimate l, sp;
+  auto pred = psz::select_predictor<T>(x, len3, 1e-3, radius, &l, &sp);
+  auto is_3d = len3.y > 1 and len3.z > 1;
+  auto ok_select = pred == (is_3d and sp.cr > l.cr * 1.02 ? Spline : Lorenzo);
+  printf(
+      "  auto predictor: %s (Lorenzo CR %.3f, spline CR %.3f)\n",
+      pred == Spline ? "spline" : "lorenzo", l.cr, sp.cr);
+
+  auto ok = ok_sampled and ok_psnr and ok_cr and ok_spline and ok_select;
+  cout << "sampled estimate, eb autotuning and predictor selection work as "
+          "expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  delete[] x;
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_estimate<f4>({256, 256, 64}, 512);
+  all_pass = all_pass and test_estimate<f4>({1024, 1024, 1}, 512);
+  all_pass = all_pass and test_estimate<f8>({1 << 22, 1, 1}, 512);
+  all_pass = all_pass and test_estimate<f8>({100, 90, 80}, 128);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_l2_hfbook.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-15
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "busyheader.hh"
+#include "hf/hf_bk.hh"
+#include "hf/hf_word.hh"
+
+using E = u4;
+
+int const bklen = 1024;
+
+// Fibonacci frequencies give the deepest Huffman tree: n symbols, n - 1 bits.
+void fill_fibonacci(u4* freq, int nsym)
+{
+  memset(freq, 0, sizeof(u4) * bklen);
+  u4 a = 1, b = 1;
+  for (auto i = 0; i < nsym; i++) {
+    freq[bklen / 2 - nsym / 2 + i] = a;
+    auto c = a + b;
+    a = b, b = c;
+  }
+}
+
+// serial counterpart of the canonical decoding on GPU
+template <typename H>
+bool roundtrip(u4* freq, H* book, u1* revbook)
+{
+  using PW = PackedWordByWidth<sizeof(H)>;
+  constexpr auto CELL_BITWIDTH = sizeof(H) * 8;
+
+  std::vector<E> in;
+  for (auto i = 0; i < bklen; i++)
+    if (freq[i]) in.insert(in.end(), {(E)i, (E)i});
+  std::shuffle(in.begin(), in.end(), std::mt19937(0));
+
+  std::vector<bool> bits;
+  for (auto sym : in) {
+    auto pw = (PW*)(&book[sym]);
+    for (int b = pw->bits - 1; b >= 0; b--)
+      bits.push_back((((H)pw->word) >> b) & 0x1);
+  }
+
+  auto first = (H*)revbook;
+  auto entry = first + CELL_BITWIDTH;
+  auto keys = (E*)(revbook + sizeof(H) * (2 * CELL_BITWIDTH));
+
+  std::vector<E> out;
+  for (size_t i = 0; i < bits.size();) {
+    H v = bits[i++];
+    auto l = 1;
+    while (v < first[l] and i < bits.size()) v = (v << 1) | bits[i++], ++l;
+    out.push_back(keys[entry[l] + v - first[l]]);
+  }
+
+  return in == out;
+}
+
+template <typename H>
+bool build(u4* freq, H* book, u1* revbook)
+{
+  float t;
+  auto revbook_bytes = sizeof(H) * (2 * 8 * sizeof(H)) + sizeof(E) * bklen;
+  try {
+    psz::hf_buildbook<CPU, E, H>(
+        freq, bklen, book, revbook, revbook_bytes, &t);
+  }
+  catch (std::runtime_error const& e) {
+    return false;
+  }
+  return true;
+}
+
+bool test_width(int nsym)
+{
+  auto freq = new u4[bklen];
+  auto book4 = new u4[bklen];
+  auto book8 = new u8[bklen];
+  auto revbook4 = new u1[sizeof(u4) * 64 + sizeof(E) * bklen];
+  auto revbook8 = new u1[sizeof(u8) * 128 + sizeof(E) * bklen];
+
+  fill_fibonacci(freq, nsym);
+  auto max_bitlen = psz::hf_max_bitlen(freq, bklen);
+
+  auto fits4 = max_bitlen <= PackedWordByWidth<4>::FIELDWIDTH_word;
+  // a u4 book is refused rather than silently overflown
+  auto ok4 = build<u4>(freq, book4, revbook4) == fits4;
+  if (fits4) ok4 = ok4 and roundtrip<u4>(freq, book4, revbook4);
+  auto ok8 = build<u8>(freq, book8, revbook8) and
+             roundtrip<u8>(freq, book8, revbook8);
+
+  auto ok = max_bitlen == nsym - 1 and ok4 and ok8;
+  printf(
+      "%d Fibonacci freqs: max codeword %d bits, %s book\n", nsym, max_bitlen,
+      fits4 ? "u4" : "u8");
+  cout << "Huffman book width works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] freq;
+  delete[] book4;
+  delete[] book8;
+  delete[] revbook4;
+  delete[] revbook8;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_width(20);
+  all_pass = all_pass and test_width(28);  // 27 bits, the u4 limit
+  all_pass = all_pass and test_width(29);
+  all_pass = all_pass and test_width(45);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
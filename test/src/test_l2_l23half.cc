@@ -0,0 +1,153 @@
+/**
+ * @file test_l2_l23half.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-19
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/l23_half.hh"
+#include "utils/half_cpu.hh"
+
+using E = u4;
+
+int const radius = 512;
+
+// smooth field plus noise, with a few values (incl. inf and NaN) that
+// cannot be prequantized
+template <typename T>
+void fill_field(T* data, psz_dim3 len3, f4 amp, f4 offset, int seed)
+{
+  std::mt19937 gen(seed);
+  std::normal_distribution<f4> noise(0, 0.01 * amp);
+  auto len = len3.x * len3.y * len3.z;
+  std::vector<f4> v(len);
+
+  for (size_t z = 0; z < len3.z; z++)
+    for (size_t y = 0; y < len3.y; y++)
+      for (size_t x = 0; x < len3.x; x++)
+        v[(z * len3.y + y) * len3.x + x] =
+            offset + amp * sin(0.05 * x + 0.03 * y + 0.02 * z) +
+            noise(gen);
+
+  v[len / 3] = 1e4 * amp;
+  v[len / 2] = std::numeric_limits<f4>::infinity();
+  v[len / 2 + 1] = std::numeric_limits<f4>::quiet_NaN();
+
+  psz::cpu::from_f4(v.data(), data, len);
+}
+
+template <typename T>
+bool test_roundtrip(psz_dim3 len3, f4 amp, f8 eb, f4 offset = 0)
+{
+  auto len = len3.x * len3.y * len3.z;
+  auto data = new T[len];
+  auto xdata = new T[len];
+  auto eq = new E[len];
+  auto oval = new T[len];
+  auto oidx = new u4[len];
+  fill_field(data, len3, amp, offset, len);
+
+  size_t nout;
+  float t;
+  psz::l23_half_construct<T, E>(
+      data, len3, eb, radius, eq, oval, oidx, &nout, len, &t);
+  psz::l23_half_reconstruct<T, E>(
+      eq, oval, oidx, nout, len3, eb, radius, xdata, &t);
+
+  std::vector<f4> x(len), xx(len);
+  psz::cpu::to_f4(data, x.data(), len);
+  psz::cpu::to_f4(xdata, xx.data(), len);
+
+  f8 maxerr = 0;
+  auto ok = true;
+  for (size_t i = 0; i < len; i++) {
+    if (not std::isfinite(x[i])) {
+      // kept bit by bit
+      ok = ok and data[i].bits == xdata[i].bits;
+      continue;
+    }
+    maxerr = std::max(maxerr, std::fabs((f8)xx[i] - x[i]));
+  }
+
+  // far from 0, prequantized values are wide but their deltas are not
+  ok = ok and maxerr <= eb and (offset == 0 or nout < len / 20);
+  printf(
+      "%s (%u,%u,%u) %g+%g*sin eb=%g: %zu outliers, max error %g\n",
+      std::is_same<T, f2>::value ? "f2" : "bf2", len3.x, len3.y, len3.z,
+      offset, amp, eb, nout, maxerr);
+  cout << "half-precision Lorenzo works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] data;
+  delete[] xdata;
+  delete[] eq;
+  delete[] oval;
+  delete[] oidx;
+
+  return ok;
+}
+
+// the array conversion (F16C, if the CPU has it) against the scalar one,
+// over all binary16 values and back
+bool test_convert()
+{
+  size_t const n = 1 << 16;
+  std::vector<f2> h(n), hh(n);
+  std::vector<f4> x(n);
+  for (size_t i = 0; i < n; i++) h[i].bits = i;
+
+  psz::cpu::to_f4(h.data(), x.data(), n);
+  psz::cpu::from_f4(x.data(), hh.data(), n);
+
+  auto ok = true;
+  for (size_t i = 0; i < n; i++) {
+    auto ref = psz::cpu::half_to_f4(h[i].bits);
+    auto same = psz::cpu::f4_as_u4(ref) == psz::cpu::f4_as_u4(x[i]);
+    ok = ok and (same or (std::isnan(ref) and std::isnan(x[i])));
+    ok = ok and (std::isnan(ref) or hh[i].bits == h[i].bits);
+  }
+
+  cout << "binary16 array conversion works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+template <typename T>
+bool test_type()
+{
+  auto all_pass = true;
+  for (auto eb : {1e-2, 1e-3, 1e-4}) {
+    all_pass = all_pass and test_roundtrip<T>({100000, 1, 1}, 1, eb);
+    all_pass = all_pass and test_roundtrip<T>({500, 300, 1}, 1, eb);
+    all_pass = all_pass and test_roundtrip<T>({70, 50, 40}, 1, eb);
+  }
+  // |x| / 2eb beyond 16 bits for the larger values, and for all but a few
+  all_pass = all_pass and test_roundtrip<T>({500, 300, 1}, 2000, 1e-2);
+  all_pass = all_pass and test_roundtrip<T>({500, 300, 1}, 1, 1e-2, 3000);
+  all_pass = all_pass and test_roundtrip<T>({70, 50, 40}, 1, 1e-4, -5);
+  return all_pass;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_convert();
+  all_pass = all_pass and test_type<f2>();
+  all_pass = all_pass and test_type<bf2>();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
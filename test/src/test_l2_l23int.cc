@@ -0,0 +1,113 @@
+/**
+ * @file test_l2_l23int.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-18
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <limits>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/l23_int.hh"
+
+using E = u4;
+
+int const radius = 512;
+
+// smooth field plus noise, clipped at both ends of the range of T
+template <typename T>
+void fill_field(T* data, psz_dim3 len3, int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> noise(-20, 20);
+  auto tmin = (double)std::numeric_limits<T>::min();
+  auto tmax = (double)std::numeric_limits<T>::max();
+
+  for (size_t z = 0; z < len3.z; z++)
+    for (size_t y = 0; y < len3.y; y++)
+      for (size_t x = 0; x < len3.x; x++) {
+        auto v = (tmax - tmin) * (0.6 * sin(0.05 * x + 0.03 * y + 0.02 * z)) +
+                 (tmax + tmin) / 2 + noise(gen);
+        v = std::min(std::max(v, tmin), tmax);
+        data[(z * len3.y + y) * len3.x + x] = (T)v;
+      }
+}
+
+template <typename T>
+bool test_roundtrip(psz_dim3 len3, u8 eb)
+{
+  auto len = len3.x * len3.y * len3.z;
+  auto data = new T[len];
+  auto xdata = new T[len];
+  auto eq = new E[len];
+  auto oval = new T[len];
+  auto oidx = new u4[len];
+  fill_field(data, len3, len);
+
+  size_t nout;
+  float t;
+  psz::l23_int_construct<T, E>(
+      data, len3, eb, radius, eq, oval, oidx, &nout, len, &t);
+  psz::l23_int_reconstruct<T, E>(
+      eq, oval, oidx, nout, len3, eb, radius, xdata, &t);
+
+  u8 maxerr = 0;
+  for (size_t i = 0; i < len; i++) {
+    auto d = data[i] > xdata[i] ? (u8)data[i] - (u8)xdata[i]
+                                : (u8)xdata[i] - (u8)data[i];
+    maxerr = std::max(maxerr, d);
+  }
+
+  auto ok = maxerr <= eb;
+  printf(
+      "%s (%u,%u,%u) eb=%lu: %zu outliers, max error %lu\n",
+      typeid(T).name(), len3.x, len3.y, len3.z, (unsigned long)eb, nout,
+      (unsigned long)maxerr);
+  cout << "integer Lorenzo works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] data;
+  delete[] xdata;
+  delete[] eq;
+  delete[] oval;
+  delete[] oidx;
+
+  return ok;
+}
+
+template <typename T>
+bool test_type()
+{
+  auto all_pass = true;
+  for (auto eb : {0, 1, 7}) {
+    all_pass = all_pass and test_roundtrip<T>({100000, 1, 1}, eb);
+    all_pass = all_pass and test_roundtrip<T>({500, 300, 1}, eb);
+    all_pass = all_pass and test_roundtrip<T>({9000, 5, 3}, eb);
+    all_pass = all_pass and test_roundtrip<T>({70, 50, 40}, eb);
+  }
+  return all_pass;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_type<u1>();
+  all_pass = all_pass and test_type<i1>();
+  all_pass = all_pass and test_type<u2>();
+  all_pass = all_pass and test_type<i2>();
+  all_pass = all_pass and test_type<u4>();
+  all_pass = all_pass and test_type<i4>();
+  all_pass = all_pass and test_type<i8>();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
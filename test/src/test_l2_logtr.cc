@@ -0,0 +1,110 @@
+/**
+ * @file test_l2_logtr.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-20
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/logtr.hh"
+
+// wide dynamic range, both signs, and exact zeros
+template <typename T>
+void fill_field(T* data, size_t len, bool with_sign, bool with_zero)
+{
+  std::mt19937 gen(len);
+  std::uniform_real_distribution<f8> expo(-20, 20);
+  for (size_t i = 0; i < len; i++) {
+    auto v = std::exp2(expo(gen)) * (1.5 + sin(0.001 * i));
+    if (with_sign and sin(0.0003 * i) < 0) v = -v;
+    if (with_zero and i % 97 == 0) v = 0;
+    data[i] = v;
+  }
+}
+
+// same prequantization and reconstruction in T as the Lorenzo predictor
+template <typename T>
+void prequant_roundtrip(T* y, size_t len, f8 eb)
+{
+  T ebx2 = eb * 2, ebx2_r = 1 / (eb * 2);
+  for (size_t i = 0; i < len; i++) y[i] = std::round(y[i] * ebx2_r) * ebx2;
+}
+
+template <typename T>
+bool test_roundtrip(size_t len, f8 pwrel, bool with_sign, bool with_zero)
+{
+  auto data = new T[len];
+  auto y = new T[len];
+  auto xdata = new T[len];
+  auto sign = new u1[psz::log_bitmap_bytes(len)];
+  auto zero = new u1[psz::log_bitmap_bytes(len)];
+  fill_field(data, len, with_sign, with_zero);
+
+  bool has_sign, has_zero;
+  f8 ymax;
+  float t;
+  psz::log_transform<T>(
+      data, y, len, sign, zero, &has_sign, &has_zero, &ymax, &t);
+  auto eb = psz::log_transform_eb<T>(pwrel, ymax);
+  prequant_roundtrip(y, len, eb);
+  psz::log_inverse<T>(
+      y, xdata, len, has_sign ? sign : nullptr, has_zero ? zero : nullptr,
+      &t);
+
+  f8 maxrel = 0;
+  auto ok = has_sign == with_sign and has_zero == with_zero;
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] == 0)
+      ok = ok and xdata[i] == 0;
+    else
+      maxrel = std::max(maxrel, std::fabs((f8)xdata[i] / data[i] - 1));
+  }
+
+  ok = ok and maxrel <= pwrel;
+  printf(
+      "%s len=%zu pwrel=%g sign=%d zero=%d: log2 eb %g, max rel. error %g\n",
+      typeid(T).name(), len, pwrel, with_sign, with_zero, eb, maxrel);
+  cout << "log transform works as expected: " << (ok ? "yes" : "NO") << endl;
+
+  delete[] data;
+  delete[] y;
+  delete[] xdata;
+  delete[] sign;
+  delete[] zero;
+
+  return ok;
+}
+
+template <typename T>
+bool test_type()
+{
+  auto all_pass = true;
+  for (auto pwrel : {1e-2, 1e-3, 1e-4}) {
+    all_pass = all_pass and test_roundtrip<T>(1000003, pwrel, true, true);
+    all_pass = all_pass and test_roundtrip<T>(1 << 20, pwrel, false, true);
+    all_pass = all_pass and test_roundtrip<T>(1 << 20, pwrel, true, false);
+    all_pass = all_pass and test_roundtrip<T>(77, pwrel, false, false);
+  }
+  return all_pass;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_type<f4>();
+  all_pass = all_pass and test_type<f8>();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
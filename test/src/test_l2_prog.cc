@@ -0,0 +1,95 @@
+/**
+ * @file test_l2_prog.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-22
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "kernel/prog.hh"
+
+// stands in for a layer: prequantization and reconstruction in T, as the
+// Lorenzo predictor does
+template <typename T>
+void lossy_layer(T const* in, T* out, size_t len, f8 eb)
+{
+  T ebx2 = eb * 2, ebx2_r = 1 / (eb * 2);
+  for (size_t i = 0; i < len; i++)
+    out[i] = std::round(in[i] * ebx2_r) * ebx2;
+}
+
+template <typename T>
+bool test_layers(size_t len, f8 eb, f8 ratio, int nlayer)
+{
+  auto x = new T[len];
+  auto xr = new f8[len];  // in double, and rounded to `xt` once per layer
+  auto xt = new T[len];
+  auto r = new T[len];
+  auto rr = new T[len];
+  for (size_t i = 0; i < len; i++)
+    x[i] = 100 * sin(0.0001 * i) + cos(0.37 * i);
+
+  float t;
+  auto ok = true;
+  auto eb_k = eb * std::pow(ratio, nlayer - 1);
+  lossy_layer(x, rr, len, eb_k);
+  std::fill(xr, xr + len, 0);
+  psz::prog_accumulate<T>(xr, rr, len, &t);
+
+  for (auto k = 0; k < nlayer; k++) {
+    if (k > 0) {
+      eb_k /= ratio;
+      psz::prog_residual<T>(x, xr, r, len, &t);
+      lossy_layer(r, rr, len, eb_k);
+      psz::prog_accumulate<T>(xr, rr, len, &t);
+    }
+    psz::prog_round<T>(xr, xt, len, &t);
+
+    f8 maxerr = 0;
+    for (size_t i = 0; i < len; i++)
+      maxerr = std::max(maxerr, std::fabs((f8)x[i] - xt[i]));
+
+    // plus half an ulp of max|x| = 101 (< 128), for the one rounding to T,
+    // whatever the number of layers
+    auto ulp = 128 * std::numeric_limits<T>::epsilon();
+    auto layer_ok = maxerr <= eb_k * (1 + 1e-6) + ulp / 2;
+    printf(
+        "%s layer %d/%d: eb %g, max error %g\n", typeid(T).name(), k + 1,
+        nlayer, eb_k, maxerr);
+    ok = ok and layer_ok;
+  }
+  cout << "progressive layers work as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] x;
+  delete[] xr;
+  delete[] xt;
+  delete[] r;
+  delete[] rr;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_layers<f4>(1 << 20, 1e-3, 10, 3);
+  all_pass = all_pass and test_layers<f4>(1000003, 1e-2, 4, 4);
+  all_pass = all_pass and test_layers<f8>(1 << 20, 1e-6, 10, 5);
+  all_pass = all_pass and test_layers<f8>(1000003, 1e-4, 2, 3);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
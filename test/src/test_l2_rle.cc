@@ -0,0 +1,80 @@
+/**
+ * @file test_l2_rle.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-14
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <random>
+
+#include "busyheader.hh"
+#include "kernel/rle.hh"
+
+using E = u4;
+
+int const radius = 512;
+
+// masked-field-like quant-codes: long center-code runs, with sparse bursts
+// of noise; `maxrun` controls the longest run
+void fill_runs(E* eq, size_t len, size_t maxrun, int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<size_t> runlen(1, maxrun);
+  std::uniform_int_distribution<int> noise(-3, 3);
+
+  for (size_t i = 0; i < len;) {
+    auto n = std::min(runlen(gen), len - i);
+    for (size_t j = 0; j < n; j++) eq[i + j] = radius;
+    i += n;
+    for (auto j = 0; j < 8 and i < len; j++, i++) eq[i] = radius + noise(gen);
+  }
+}
+
+bool test_roundtrip(size_t len, size_t maxrun)
+{
+  auto eq = new E[len];
+  auto xeq = new E[len];
+  fill_runs(eq, len, maxrun, len);
+
+  size_t nrun_counted, nrun;
+  float t;
+  psz::rle_count<CPU, E>(eq, len, &nrun_counted, &t);
+
+  auto val = new E[nrun_counted];
+  auto runlen = new u2[nrun_counted];
+  psz::rle_encode<CPU, E>(eq, len, val, runlen, &nrun, &t);
+  psz::rle_decode<CPU, E>(val, runlen, nrun, xeq, len, &t);
+
+  auto ok = nrun == nrun_counted and std::equal(eq, eq + len, xeq);
+  printf(
+      "len=%zu maxrun=%zu: %zu runs, avg. run %.2lf\n", len, maxrun, nrun,
+      1.0 * len / nrun);
+  cout << "RLE roundtrip works as expected: " << (ok ? "yes" : "NO") << endl;
+
+  delete[] eq;
+  delete[] xeq;
+  delete[] val;
+  delete[] runlen;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_roundtrip(1 << 20, 4096);
+  // runs longer than RLE_MAX_RUN are split
+  all_pass = all_pass and test_roundtrip(1 << 22, 1 << 20);
+  all_pass = all_pass and test_roundtrip(1000003, 2);
+  all_pass = all_pass and test_roundtrip(1, 1);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
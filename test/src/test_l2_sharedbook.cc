@@ -0,0 +1,203 @@
+/**
+ * @file test_l2_sharedbook.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-10-02
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "busyheader.hh"
+#include "cusz.h"
+#include "hf/hf_bk.hh"
+#include "hf/hf_word.hh"
+#include "kernel/hist.hh"
+#include "kernel/l23_int.hh"
+
+using T = i4;
+using E = u4;
+
+int const radius = 512;
+int const bklen = radius * 2;
+int const npart = 4;
+
+psz_dim3 const len3{64, 48, 12};  // of a partition
+size_t const len = (size_t)len3.x * len3.y * len3.z;
+
+// the quant-codes of partition `p`, each with a distinct spread
+std::vector<E> codes_of(int p)
+{
+  std::vector<T> data(len), oval(len);
+  std::vector<E> eq(len);
+  std::vector<u4> oidx(len);
+
+  std::mt19937 gen(p);
+  std::uniform_int_distribution<int> noise(-4 * (p + 1), 4 * (p + 1));
+  for (size_t i = 0; i < len; i++)
+    data[i] = (T)(500 * sin(1e-3 * (i + p * len))) + noise(gen);
+
+  size_t nout;
+  float t;
+  psz::l23_int_construct<T, E>(
+      data.data(), len3, 1, radius, eq.data(), oval.data(), oidx.data(), &nout,
+      len, &t);
+  return eq;
+}
+
+std::vector<u4> hist_of(int p)
+{
+  std::vector<u4> h(bklen, 0);
+  auto eq = codes_of(p);
+  float t;
+  psz::histogram<CPU, E>(eq.data(), len, h.data(), bklen, &t);
+  return h;
+}
+
+f8 bits_of(psz_book const* book, std::vector<u4> const& h)
+{
+  f8 bits = 0;
+  for (auto i = 0; i < bklen; i++)
+    if (h[i])
+      bits += 1.0 * h[i] *
+              (book->encdtype == U4
+                   ? ((PackedWordByWidth<4>*)book->book.data())[i].bits
+                   : ((PackedWordByWidth<8>*)book->book.data())[i].bits);
+  return bits;
+}
+
+// ranks as processes, each with its partition, summing over files
+bool test_reduce(std::vector<u4> const& total)
+{
+  char tmpl[] = "/tmp/psz_sharedbook_XXXXXX";
+  std::string dir = mkdtemp(tmpl);
+
+  std::vector<pid_t> pids;
+  for (auto r = 0; r < npart; r++) {
+    auto pid = fork();
+    if (pid == 0) {
+      auto h = hist_of(r);
+      auto comm = psz_comm_file_create(dir.c_str(), r, npart, 0);
+      psz_histogram_reduce(comm, h.data(), bklen);
+      psz_comm_release(comm);
+      _exit(h == total ? 0 : 1);
+    }
+    pids.push_back(pid);
+  }
+
+  auto ok = true;
+  for (auto pid : pids) {
+    int status;
+    waitpid(pid, &status, 0);
+    ok = ok and WIFEXITED(status) and WEXITSTATUS(status) == 0;
+  }
+  system(("rm -rf " + dir).c_str());
+  return ok;
+}
+
+// the reverse book that decoding picks, as an archive with its own or
+// without one (of the shared book)
+bool test_revbook_of(psz_book const* book)
+{
+  std::vector<u1> own(book->revbook.size()), loaded(book->revbook.size());
+  auto other = book->encdtype == U4 ? ULL : U4;
+
+  auto refused = [&](psz_book const* shared, pszdtype t, int n) {
+    try {
+      psz::hf_revbook_of(own.data(), 0, t, n, shared, loaded.data());
+    }
+    catch (std::runtime_error const&) {
+      return true;
+    }
+    return false;
+  };
+
+  auto bklen = book->bklen;
+  auto t = book->encdtype;
+  return psz::hf_revbook_of(
+             own.data(), own.size(), t, bklen, nullptr, nullptr) ==
+             own.data() and
+         psz::hf_revbook_of(own.data(), 0, t, bklen, book, loaded.data()) ==
+             loaded.data() and
+         refused(nullptr, t, bklen) and refused(book, other, bklen) and
+         refused(book, t, bklen / 2);
+}
+
+int main()
+{
+  std::vector<std::vector<u4>> hists;
+  std::vector<u4> total(bklen, 0);
+  for (auto p = 0; p < npart; p++) {
+    hists.push_back(hist_of(p));
+    for (auto i = 0; i < bklen; i++) total[i] += hists[p][i];
+  }
+
+  auto reduced = test_reduce(total);
+
+  // one book, of the summed histogram, for all partitions
+  auto book = psz_book_create(total.data(), bklen);
+  auto covers = true;
+  f8 shared_bits = 0, own_bits = 0;
+  size_t own_revbook = 0;
+  for (auto p = 0; p < npart; p++) {
+    covers = covers and psz::hf_book_covers(book, hists[p].data());
+    shared_bits += bits_of(book, hists[p]);
+
+    auto own = psz_book_create(hists[p].data(), bklen);
+    own_bits += bits_of(own, hists[p]);
+    own_revbook += own->revbook.size();
+    psz_book_release(own);
+  }
+
+  // a book of one partition leaves out symbols of the noisier ones
+  auto narrow = psz_book_create(hists[0].data(), bklen);
+  auto refused = not psz::hf_book_covers(narrow, hists[npart - 1].data());
+  psz_book_release(narrow);
+
+  // stored once, and loaded back as the same book
+  std::vector<u1> blob(psz_book_bytes(book));
+  psz_book_export(book, blob.data());
+  auto loaded = psz_book_import(blob.data(), blob.size());
+  auto same = psz_book_id(loaded) == psz_book_id(book) and
+              loaded->book == book->book and
+              loaded->revbook == book->revbook;
+  psz_book_release(loaded);
+
+  auto picked = test_revbook_of(book);
+
+  blob[blob.size() / 2] ^= 1;
+  auto corrupted = false;
+  try {
+    psz_book_import(blob.data(), blob.size());
+  }
+  catch (std::runtime_error const&) {
+    corrupted = true;
+  }
+
+  printf(
+      "%d partitions: %.0f bytes of codes with one book, %.0f with their "
+      "own; reverse books %zu bytes, in place of %zu\n",
+      npart, shared_bits / 8, own_bits / 8, book->revbook.size(),
+      own_revbook);
+  psz_book_release(book);
+
+  // near what books of their own give; one reverse book, not `npart`
+  auto ok = reduced and covers and refused and same and corrupted and
+            picked and shared_bits <= 1.05 * own_bits;
+  cout << "shared book over reduced histograms works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  if (ok)
+    return 0;
+  else
+    return -1;
+}
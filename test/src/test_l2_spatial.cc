@@ -0,0 +1,132 @@
+/**
+ * @file test_l2_spatial.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-25
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <random>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "stat/spatial_cpu.hh"
+
+// SSIM window by window, with two passes for each
+template <typename T>
+f8 ssim_reference(T* x, T* o, psz_dim3 len3, size_t window, size_t shift)
+{
+  size_t nx = len3.x, ny = len3.y, nz = len3.z;
+  auto wx = std::min(window, nx), wy = std::min(window, ny),
+       wz = std::min(window, nz);
+  auto mm = std::minmax_element(o, o + nx * ny * nz);
+  f8 rng = *mm.second - *mm.first;
+  f8 C1 = 0.0001 * rng * rng, C2 = 0.0009 * rng * rng;
+
+  f8 sum = 0;
+  size_t count = 0;
+  for (size_t z0 = 0; z0 + wz <= nz; z0 += shift)
+    for (size_t y0 = 0; y0 + wy <= ny; y0 += shift)
+      for (size_t x0 = 0; x0 + wx <= nx; x0 += shift) {
+        auto each = [&](auto f) {
+          for (auto z = z0; z < z0 + wz; z++)
+            for (auto y = y0; y < y0 + wy; y++)
+              for (auto x = x0; x < x0 + wx; x++)
+                f((z * ny + y) * nx + x);
+        };
+        f8 n = wx * wy * wz, mo = 0, mx = 0, vo = 0, vx = 0, c = 0;
+        each([&](size_t i) { mo += o[i], mx += x[i]; });
+        mo /= n, mx /= n;
+        each([&](size_t i) {
+          vo += (o[i] - mo) * (o[i] - mo), vx += (x[i] - mx) * (x[i] - mx);
+          c += (o[i] - mo) * (x[i] - mx);
+        });
+        vo /= n, vx /= n, c /= n;
+        sum += (2 * mo * mx + C1) * (2 * c + C2) /
+               ((mo * mo + mx * mx + C1) * (vo + vx + C2));
+        count++;
+      }
+  return sum / count;
+}
+
+template <typename T>
+bool test_spatial(psz_dim3 len3)
+{
+  size_t nx = len3.x, ny = len3.y, nz = len3.z, len = nx * ny * nz;
+  auto o = new T[len], white = new T[len], smooth = new T[len];
+
+  // white error, and one correlated along x
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> u(-1e-2, 1e-2);
+  for (size_t z = 0; z < nz; z++)
+    for (size_t y = 0; y < ny; y++)
+      for (size_t x = 0; x < nx; x++) {
+        auto i = (z * ny + y) * nx + x;
+        o[i] = 100 + sin(0.05 * x) * cos(0.07 * y) + 0.5 * sin(0.1 * z);
+        white[i] = o[i] + (T)u(gen);
+        smooth[i] = o[i] + (T)(1e-2 * sin(0.01 * x + y + 3 * z));
+      }
+
+  float t_ssim, t_acf, t_spec;
+  auto close = [](f8 a, f8 b, f8 tol) { return std::fabs(a - b) <= tol; };
+
+  auto ssim = psz::cppstd_ssim<T>(white, o, len3, 7, 2, &t_ssim);
+  auto ref = ssim_reference<T>(white, o, len3, 7, 2);
+  auto one = psz::cppstd_ssim<T>(o, o, len3);
+  auto ok_ssim =
+      close(ssim, ref, 1e-9) and close(one, 1, 1e-12) and ssim < 1;
+
+  int lags[] = {1, 2, 4};
+  f8 acf_w[9], acf_s[9];
+  psz::cppstd_error_autocorr<T>(white, o, len3, lags, 3, acf_w, &t_acf);
+  psz::cppstd_error_autocorr<T>(smooth, o, len3, lags, 3, acf_s);
+  auto ok_acf = true;
+  for (auto i = 0; i < 9; i++)
+    if (not std::isnan(acf_w[i]))
+      ok_acf = ok_acf and std::fabs(acf_w[i]) < 0.02;
+  ok_acf = ok_acf and acf_s[0] > 0.99 and acf_s[6] > 0.99;
+
+  f8 sp_w[3][psz::SPECTRUM_NBAND], sp_s[3][psz::SPECTRUM_NBAND];
+  psz::cppstd_error_spectrum<T>(white, o, len3, sp_w, &t_spec);
+  psz::cppstd_error_spectrum<T>(smooth, o, len3, sp_s);
+  auto ok_spec = close(sp_w[0][0], 0.5, 0.02) and
+                 close(sp_w[0][1], 0.25, 0.02) and sp_s[0][0] < 0.01;
+  if (ny > 1) ok_spec = ok_spec and close(sp_w[1][0], 0.5, 0.02);
+  if (nz > 1) ok_spec = ok_spec and close(sp_w[2][0], 0.5, 0.02);
+
+  printf(
+      "%s %zux%zux%zu: SSIM %.12g (ref %.12g, %.3f ms); error ACF at 1 "
+      "along x %.4f, smooth %.4f (%.3f ms); spectrum band 0/1 %.4f/%.4f, "
+      "smooth %.4f (%.3f ms)\n",
+      typeid(T).name(), nx, ny, nz, ssim, ref, t_ssim, acf_w[0], acf_s[0],
+      t_acf, sp_w[0][0], sp_w[0][1], sp_s[0][0], t_spec);
+
+  auto ok = ok_ssim and ok_acf and ok_spec;
+  cout << "SSIM, error autocorrelation and spectrum work as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  delete[] o;
+  delete[] white;
+  delete[] smooth;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_spatial<f4>({67, 45, 33});
+  all_pass = all_pass and test_spatial<f8>({64, 64, 64});
+  all_pass = all_pass and test_spatial<f8>({513, 300, 1});
+  all_pass = all_pass and test_spatial<f4>({100000, 1, 1});
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_l2_subdomain.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-10-01
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "busyheader.hh"
+#include "context.h"
+#include "cusz.h"
+
+using T = f4;
+
+uint32_t const gx = 40, gy = 30, gz = 24;
+f8 const rel_eb = 1e-3;
+
+T value(size_t x, size_t y, size_t z)
+{
+  return 100 * sin(0.1 * x) * cos(0.07 * y) + 3 * z + (z > 20 ? 500 : 0);
+}
+
+// rank `r` of `nrank` holds slabs along z, and uneven halves along x
+psz_subdomain box_of(int r, int nrank)
+{
+  psz_subdomain s{};
+  s.rank = r, s.nrank = nrank;
+  s.global[0] = gx, s.global[1] = gy, s.global[2] = gz;
+  auto nslab = nrank / 2;
+  auto slab = r / 2, half = r % 2;
+  s.offset[0] = half ? 13 : 0, s.len[0] = half ? gx - 13 : 13;
+  s.offset[1] = 0, s.len[1] = gy;
+  s.offset[2] = gz * slab / nslab;
+  s.len[2] = gz * (slab + 1) / nslab - s.offset[2];
+  return s;
+}
+
+// In place of `psz_compress`, which needs a GPU: the codes of a uniform
+// quantizer at the eb, as the archive of the subdomain.
+int run_rank(std::string const& dir, int r, int nrank, f8 expected_eb)
+{
+  auto s = box_of(r, nrank);
+  std::vector<T> data(s.len[0] * s.len[1] * s.len[2]);
+  for (uint32_t z = 0; z < s.len[2]; z++)
+    for (uint32_t y = 0; y < s.len[1]; y++)
+      for (uint32_t x = 0; x < s.len[0]; x++)
+        data[x + s.len[0] * (y + s.len[1] * z)] =
+            value(x + s.offset[0], y + s.offset[1], z + s.offset[2]);
+
+  pszctx ctx;
+  ctx.dtype = F4, ctx.mode = Rel, ctx.eb = rel_eb;
+  auto comm = psz_comm_file_create((dir + "/comm").c_str(), r, nrank, 0);
+  psz_global_eb(comm, &ctx, data.data(), {s.len[0], s.len[1], s.len[2], 1});
+  psz_comm_release(comm);
+
+  std::vector<i4> codes(data.size());
+  for (size_t i = 0; i < data.size(); i++)
+    codes[i] = std::round(data[i] / (2 * ctx.eb));
+
+  auto fname = dir + "/" + std::to_string(r) + ".cuszs";
+  psz_subdomain_write(
+      fname.c_str(), &s, codes.data(), codes.size() * sizeof(i4));
+
+  return ctx.mode == Abs and ctx.eb == expected_eb ? 0 : 1;
+}
+
+bool test_subdomain(int nrank)
+{
+  char tmpl[] = "/tmp/psz_subdomain_XXXXXX";
+  std::string dir = mkdtemp(tmpl);
+  mkdir((dir + "/comm").c_str(), 0700);
+
+  // the eb of the whole field, as the ranks are to agree on
+  T lo = value(0, 0, 0), hi = lo;
+  for (uint32_t z = 0; z < gz; z++)
+    for (uint32_t y = 0; y < gy; y++)
+      for (uint32_t x = 0; x < gx; x++)
+        lo = std::min(lo, value(x, y, z)), hi = std::max(hi, value(x, y, z));
+  auto eb = rel_eb * ((f8)hi - (f8)lo);
+
+  std::vector<pid_t> pids;
+  for (auto r = 0; r < nrank; r++) {
+    auto pid = fork();
+    if (pid == 0) _exit(run_rank(dir, r, nrank, eb));
+    pids.push_back(pid);
+  }
+  auto same_eb = true;
+  for (auto pid : pids) {
+    int status;
+    waitpid(pid, &status, 0);
+    same_eb = same_eb and WIFEXITED(status) and WEXITSTATUS(status) == 0;
+  }
+
+  // merged in reverse, to be put in rank order
+  std::vector<std::string> names;
+  std::vector<char const*> subfiles;
+  for (auto r = nrank - 1; r >= 0; r--)
+    names.push_back(dir + "/" + std::to_string(r) + ".cuszs");
+  for (auto& n : names) subfiles.push_back(n.c_str());
+  auto merged = dir + "/merged.cuszm";
+  auto ok = psz_merge(merged.c_str(), subfiles.data(), nrank) == CUSZ_SUCCESS;
+
+  int n;
+  psz_merged_index(merged.c_str(), nullptr, &n);
+  std::vector<psz_subdomain> subs(n);
+  psz_merged_index(merged.c_str(), subs.data(), &n);
+  ok = ok and n == nrank;
+
+  // each subdomain alone, and each point found in the one that holds it
+  f8 maxerr = 0;
+  for (auto k = 0; ok and k < n; k++) {
+    auto& s = subs[k];
+    ok = s.rank == k;
+    size_t bytes;
+    psz_merged_read(merged.c_str(), k, nullptr, &bytes);
+    std::vector<i4> codes(bytes / sizeof(i4));
+    psz_merged_read(merged.c_str(), k, codes.data(), &bytes);
+
+    for (uint32_t z = 0; z < s.len[2]; z++)
+      for (uint32_t y = 0; y < s.len[1]; y++)
+        for (uint32_t x = 0; x < s.len[0]; x++) {
+          auto X = x + s.offset[0], Y = y + s.offset[1], Z = z + s.offset[2];
+          ok = ok and psz_subdomain_locate(subs.data(), n, X, Y, Z) == k;
+          auto xdata = codes[x + s.len[0] * (y + s.len[1] * z)] * 2 * eb;
+          maxerr = std::max(maxerr, std::abs(xdata - value(X, Y, Z)));
+        }
+  }
+  ok = ok and psz_subdomain_locate(subs.data(), n, gx, 0, 0) == -1;
+
+  // a missing rank is refused
+  auto refused = false;
+  try {
+    psz_merge(merged.c_str(), subfiles.data() + 1, nrank - 1);
+  }
+  catch (std::runtime_error const&) {
+    refused = true;
+  }
+
+  system(("rm -rf " + dir).c_str());
+
+  printf(
+      "%d ranks: global eb %g, max error %g, %d subdomains\n", nrank, eb,
+      maxerr, n);
+  ok = ok and same_eb and refused and maxerr <= eb * (1 + 1e-6);
+  cout << "domain-decomposed compression and merge works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+// a rank left alone gives up after the timeout, with the eb as it was
+bool test_timeout()
+{
+  char tmpl[] = "/tmp/psz_subdomain_XXXXXX";
+  std::string dir = mkdtemp(tmpl);
+
+  pszctx ctx;
+  ctx.dtype = F4, ctx.mode = Rel, ctx.eb = rel_eb;
+  std::vector<T> data(64, 1);
+  std::vector<uint32_t> freq(16, 1);
+
+  auto comm = psz_comm_file_create(dir.c_str(), 1, 3, 0.2);
+  auto a = std::chrono::steady_clock::now();
+  auto eb_err = psz_global_eb(comm, &ctx, data.data(), {64, 1, 1, 1});
+  auto hist_err = psz_histogram_reduce(comm, freq.data(), 16);
+  std::chrono::duration<f8> waited = std::chrono::steady_clock::now() - a;
+  psz_comm_release(comm);
+  system(("rm -rf " + dir).c_str());
+
+  auto ok = eb_err == CUSZ_FAIL_ONDISK_FILE_ERROR and
+            hist_err == CUSZ_FAIL_ONDISK_FILE_ERROR and ctx.mode == Rel and
+            ctx.eb == rel_eb and freq[0] == 1 and waited.count() >= 0.4 and
+            waited.count() < 5;
+  printf("a rank alone: gave up twice in %.2f s\n", waited.count());
+  cout << "timeout of a file reduction works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_subdomain(2);
+  all_pass = all_pass and test_subdomain(6);
+  all_pass = all_pass and test_timeout();
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
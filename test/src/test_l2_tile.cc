@@ -0,0 +1,314 @@
+/**
+ * @file test_l2_tile.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-29
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include "busyheader.hh"
+#include "cusz.h"
+#include "kernel/tile.hh"
+#include "utils/sched_cpu.hh"
+
+int const radius = 512;
+
+// a diamond of dependencies, and that nothing runs before its inputs
+bool test_graph(int nworker)
+{
+  psz::cpu::task_graph g;
+  std::atomic<int> order{0};
+  int at[4];
+  auto a = g.add([&] { at[0] = order++; });
+  auto b = g.add([&] { at[1] = order++; }, {a});
+  auto c = g.add([&] { at[2] = order++; }, {a});
+  g.add([&] { at[3] = order++; }, {b, c});
+
+  auto r = g.run(nworker);
+  size_t ntask = 0;
+  for (auto n : r.ntask) ntask += n;
+
+  auto ok = ntask == 4 and at[0] == 0 and at[3] == 3;
+
+  // a throwing task stops the run, and is rethrown
+  psz::cpu::task_graph h;
+  auto t = h.add([] { throw std::runtime_error("in a task"); });
+  h.add([] {}, {t});
+  try {
+    h.run(nworker);
+    ok = false;
+  }
+  catch (std::runtime_error const&) {
+  }
+
+  // nested in a pool, inline in the calling thread
+  std::atomic<int> nested{0};
+  psz::cpu::parallel_for(
+      nworker,
+      [&](size_t) {
+        psz::cpu::task_graph n;
+        n.add([] {});
+        nested += n.run(nworker).nworker();
+      },
+      nworker);
+  ok = ok and nested == nworker;
+
+  cout << "task graph on " << nworker
+       << " workers works as expected: " << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+void print_report(char const* name, psz::cpu::sched_report const& r)
+{
+  printf(
+      "  %s: %.3f ms on %d workers, utilization %.1f%%\n", name, r.wall_ms,
+      r.nworker(), 100 * r.utilization());
+  for (auto w = 0; w < r.nworker(); w++)
+    printf(
+        "    worker %d: busy %.3f ms, %zu tasks, %zu stolen\n", w,
+        r.busy_ms[w], r.ntask[w], r.nsteal[w]);
+}
+
+// smooth, except for a noisy, outlier-dense band of tiles at the low end
+template <typename T>
+bool test_tile(psz_dim3 len3, u8 eb, u4 tile, int nworker)
+{
+  auto len = (size_t)len3.x * len3.y * len3.z;
+  auto data = new T[len], xdata = new T[len];
+
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> noise(-30000, 30000);
+  auto nslow = len / 8;
+  for (size_t i = 0; i < len; i++)
+    data[i] = i < nslow ? (T)noise(gen) : (T)(1000 * sin(1e-3 * i));
+
+  psz::tile_archive<T> stolen, fixed;
+  auto c_steal = psz::tile_compress<T>(
+      data, len3, eb, radius, tile, stolen, nworker, true);
+  auto c_fixed = psz::tile_compress<T>(
+      data, len3, eb, radius, tile, fixed, nworker, false);
+
+  // the same archive either way
+  auto same = stolen.freq == fixed.freq and
+              stolen.tiles.size() == fixed.tiles.size();
+  for (size_t i = 0; same and i < stolen.tiles.size(); i++)
+    same = stolen.tiles[i].ans == fixed.tiles[i].ans and
+           stolen.tiles[i].outlier_idx == fixed.tiles[i].outlier_idx;
+
+  auto d_steal = psz::tile_decompress<T>(stolen, xdata, nworker);
+
+  u8 maxerr = 0;
+  for (size_t i = 0; i < len; i++)
+    maxerr = std::max(maxerr, (u8)std::abs((i8)data[i] - (i8)xdata[i]));
+
+  printf(
+      "%s (%u,%u,%u) eb=%lu, %zu tiles: CR %.3f, max error %lu\n",
+      typeid(T).name(), len3.x, len3.y, len3.z, (unsigned long)eb,
+      stolen.tiles.size(), 1.0 * len * sizeof(T) / stolen.bytes(),
+      (unsigned long)maxerr);
+  print_report("compress, stealing", c_steal);
+  print_report("compress, static", c_fixed);
+  print_report("decompress, stealing", d_steal);
+
+  auto ok = same and maxerr <= eb;
+  cout << "tiled pipeline on the work-stealing scheduler works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  delete[] data;
+  delete[] xdata;
+  return ok;
+}
+
+// through the C API and a contiguous archive; skewed as above, with values
+// no eb can bound kept as is
+template <typename T>
+bool test_tile_float(pszdtype type, psz_dim3 len3, f8 eb, u4 tile)
+{
+  auto len = (size_t)len3.x * len3.y * len3.z;
+  auto data = new T[len], xdata = new T[len];
+
+  std::mt19937 gen(5);
+  std::normal_distribution<T> noise(0, 100);
+  auto nslow = len / 8;
+  for (size_t i = 0; i < len; i++)
+    data[i] = i < nslow ? noise(gen) : (T)sin(1e-3 * i);
+  data[len / 2] = NAN, data[len / 3] = INFINITY, data[len / 4] = 1e30;
+
+  uint8_t* archive;
+  size_t bytes;
+  pszdtype xtype;
+  pszlen xlen;
+  psz_sched_report c_report, d_report;
+  auto ok = psz_tile_compress(
+                data, type, {len3.x, len3.y, len3.z, 1}, eb, radius, tile,
+                4, &archive, &bytes, &c_report) == CUSZ_SUCCESS;
+  ok = ok and psz_tile_info(archive, bytes, &xtype, &xlen) == CUSZ_SUCCESS;
+  ok = ok and psz_tile_decompress(archive, bytes, xdata, 4, &d_report) ==
+                  CUSZ_SUCCESS;
+
+  f8 maxerr = 0;
+  auto kept = std::isnan(xdata[len / 2]) and xdata[len / 3] == INFINITY and
+              xdata[len / 4] == data[len / 4];
+  for (size_t i = 0; i < len; i++)
+    if (std::isfinite(data[i]))
+      maxerr = std::max(maxerr, std::fabs((f8)xdata[i] - data[i]));
+
+  // two tasks per tile each way, on the 4 workers asked for
+  auto ntile = (len3.z > 1 ? len3.z : len3.y) / tile;
+  auto reported = c_report.nworker == 4 and d_report.nworker == 4 and
+                  c_report.ntask == 3 * ntile + 1 and
+                  d_report.ntask == 2 * ntile and
+                  c_report.max_busy_ms <= c_report.busy_ms and
+                  c_report.busy_ms <= 4 * c_report.wall_ms * (1 + 1e-6);
+
+  // errors as codes, not exceptions, through the C API
+  std::vector<uint8_t> half(archive, archive + bytes / 2);
+  auto truncated = psz_tile_decompress(
+                       half.data(), half.size(), xdata, 4, nullptr) ==
+                   CUSZ_FAIL_UNSUPPORTED_FORMAT;
+  uint8_t* none = nullptr;
+  auto bad_eb = psz_tile_compress(
+                    data, type, {len3.x, len3.y, len3.z, 1}, -1, radius,
+                    tile, 4, &none, &bytes, nullptr) ==
+                    CUSZ_FAIL_UNSUPPORTED_PIPELINE and
+                not none;
+  archive[0] ^= 1;
+  auto refused =
+      psz_tile_info(archive, bytes, &xtype, &xlen) ==
+          CUSZ_FAIL_UNSUPPORTED_FORMAT and
+      psz_tile_decompress(archive, bytes, xdata, 4, nullptr) ==
+          CUSZ_FAIL_UNSUPPORTED_FORMAT;
+  free(archive);
+
+  printf(
+      "%s (%u,%u,%u) eb=%g: CR %.3f, max error %g\n", typeid(T).name(),
+      len3.x, len3.y, len3.z, eb, 1.0 * len * sizeof(T) / bytes, maxerr);
+
+  ok = ok and xtype == type and xlen.x == len3.x and xlen.y == len3.y and
+       xlen.z == len3.z and kept and reported and truncated and bad_eb and
+       refused and maxerr <= eb;
+  cout << "tiled FP pipeline through the C API works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  delete[] data;
+  delete[] xdata;
+  return ok;
+}
+
+// cores from sysfs lists, leases of them, settings per thread, and zeroing
+// by the pinned workers that then take the same blocks
+bool test_numa(pszpin pin, int nworker)
+{
+  auto ok = psz::cpu::detail::parse_cpulist("0-3,8,10-11\n") ==
+            std::vector<int>{0, 1, 2, 3, 8, 10, 11};
+
+  psz::cpu::placement_scope place(pin, true);
+  for (auto w = 0; w < 2 * nworker; w++) {
+    auto c = psz::cpu::core_of(w);
+    ok = ok and (pin == PinNone ? c == -1 : c >= 0);
+  }
+
+  // of this thread only, as of a compressor in a call
+  std::thread([&] {
+    ok = ok and psz::cpu::pinning() == PinNone and
+         not psz::cpu::numa_touch();
+  }).join();
+  {
+    psz::cpu::placement_scope inner(PinNone, false);
+    ok = ok and psz::cpu::pinning() == PinNone;
+  }
+  ok = ok and psz::cpu::pinning() == pin and psz::cpu::numa_touch();
+
+  // pools side by side on distinct cores, and a pool alone as before
+  {
+    psz::cpu::pin_lease a(nworker), b(nworker);
+    for (auto k = 0; k < nworker; k++)
+      for (auto j = 0; j < nworker; j++)
+        ok = ok and (a.slot(k) < 0 or a.slot(k) != b.slot(j));
+    ok = ok and a.slot(-1) == -1 and b.slot(nworker) == -1;
+  }
+  {
+    psz::cpu::pin_lease a(nworker);
+    ok = ok and a.slot(0) == (pin == PinNone ? -1 : 0);
+  }
+
+  auto cores = [] {
+    std::vector<int> v;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    for (auto c = 0; c < CPU_SETSIZE; c++)
+      if (CPU_ISSET(c, &set)) v.push_back(c);
+#endif
+    return v;
+  };
+
+  // the calling thread is not the pool's to pin: pinned, it only waits;
+  // the workers are in its placement
+  auto const caller = std::this_thread::get_id();
+  auto const outer = cores();
+  std::vector<std::vector<int>> at(nworker);
+  std::atomic<int> by_caller{0}, placed{0};
+  psz::cpu::parallel_blocks(nworker, [&](int w) {
+    at[w] = cores();
+    by_caller += std::this_thread::get_id() == caller;
+    placed += psz::cpu::pinning() == pin and psz::cpu::numa_touch();
+  });
+  ok = ok and by_caller == (pin == PinNone ? 1 : 0) and placed == nworker;
+  ok = ok and cores() == outer;
+
+  // block `w` of a loop on the core of block `w` of the touch
+  size_t const n = 4 * nworker;
+  std::vector<std::vector<int>> of(n);
+  psz::cpu::parallel_for(n, [&](size_t i) { of[i] = cores(); }, nworker);
+  for (auto w = 0; w < nworker; w++)
+    for (auto i = n * w / nworker; i < n * (w + 1) / nworker; i++)
+      ok = ok and of[i] == at[w];
+
+  auto bytes = 5 * psz::cpu::page_bytes() + 123;
+  auto buf = new u1[bytes];
+  memset(buf, 0xff, bytes);
+  psz::cpu::first_touch(buf, bytes, nworker);
+  for (size_t i = 0; ok and i < bytes; i++) ok = buf[i] == 0;
+  delete[] buf;
+
+  cout << "pinning (" << pin << ") and first touch on " << nworker
+       << " workers works as expected: " << (ok ? "yes" : "NO") << endl;
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_graph(1);
+  all_pass = all_pass and test_graph(4);
+  all_pass = all_pass and test_tile<i4>({256, 256, 64}, 2, 2, 4);
+  all_pass = all_pass and test_tile<u2>({1000, 800, 1}, 0, 25, 3);
+  all_pass = all_pass and test_tile<i2>({1 << 20, 1, 1}, 5, 1 << 15, 4);
+  all_pass = all_pass and test_tile_float<f4>(F4, {256, 256, 64}, 1e-3, 2);
+  all_pass = all_pass and test_tile_float<f8>(F8, {1000, 800, 1}, 1e-6, 25);
+  all_pass = all_pass and test_numa(PinNone, 3);
+  all_pass = all_pass and test_numa(PinCompact, 4);
+  all_pass = all_pass and test_numa(PinScatter, 4);
+  {
+    psz::cpu::placement_scope place(PinScatter, true);
+    all_pass = all_pass and test_tile<i4>({256, 256, 64}, 2, 2, 4);
+  }
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_l2_verify.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-25
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+
+#include "busyheader.hh"
+#include "stat/compare_cpu.hh"
+#include "utils/timer.hh"
+
+template <typename T>
+bool test_verify(size_t len, f8 eb)
+{
+  auto a = new T[len];
+  auto b = new T[len];
+  for (size_t i = 0; i < len; i++) {
+    a[i] = 10 * sin(0.001 * i);
+    b[i] = a[i] + (T)(0.9 * eb * cos(0.37 * i));
+  }
+
+  auto ok = true;
+  auto check = [&](bool pass, size_t first, size_t count, bool pass_,
+                   size_t first_, size_t count_) {
+    ok = ok and pass == pass_ and (pass or first == first_) and
+         count == count_;
+  };
+
+  size_t first = 0, count = 0;
+  auto a0 = hires::now();
+  auto pass = psz::cppstd_verify_eb<T>(a, b, len, eb, &first, &count);
+  auto a1 = hires::now();
+  check(pass, first, count, true, 0, 0);
+
+  // violations, the last of them NaN; the first is found with or without
+  // counting
+  size_t bad[] = {len - 1, len / 2 + 3, len / 2, len / 3 + 1};
+  for (auto i : bad) b[i] = a[i] + (T)(2 * eb);
+  b[len - 1] = std::numeric_limits<T>::quiet_NaN();
+  pass = psz::cppstd_verify_eb<T>(a, b, len, eb, &first, &count);
+  check(pass, first, count, false, len / 3 + 1, 4);
+
+  size_t first_early = 0;
+  auto b0 = hires::now();
+  pass = psz::cppstd_verify_eb<T>(a, b, len, eb, &first_early);
+  auto b1 = hires::now();
+  check(pass, first_early, 4, false, len / 3 + 1, 4);
+
+  // the margin of `cppstd_error_bounded`
+  size_t first_faulty = 0;
+  auto bounded = psz::cppstd_error_bounded<T>(a, b, len, eb, &first_faulty);
+  ok = ok and not bounded and first_faulty == len / 3 + 1;
+
+  printf(
+      "%s len %zu: full pass %.3f ms, early exit at %zu %.3f ms\n",
+      typeid(T).name(), len, static_cast<duration_t>(a1 - a0).count() * 1000,
+      first_early, static_cast<duration_t>(b1 - b0).count() * 1000);
+  cout << "early-exit verifier works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  delete[] a;
+  delete[] b;
+
+  return ok;
+}
+
+int main()
+{
+  auto all_pass = true;
+
+  all_pass = all_pass and test_verify<f4>(1 << 24, 1e-3);
+  all_pass = all_pass and test_verify<f8>(1000003, 1e-6);
+  all_pass = all_pass and test_verify<f4>(77, 1e-2);
+
+  if (all_pass)
+    return 0;
+  else
+    return -1;
+}
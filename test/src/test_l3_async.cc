@@ -0,0 +1,127 @@
+/**
+ * @file test_l3_async.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-27
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <vector>
+
+#include "busyheader.hh"
+#include "context.h"
+#include "cusz.h"
+#include "port.hh"
+
+using T = f4;
+
+int const ntask = 8;
+f8 const eb = 1e-3;
+pszlen const len{96, 64, 4, 1};
+size_t const n = (size_t)len.x * len.y * len.z;
+
+struct seen {
+  int k;
+  std::atomic<int>* seq;
+  int order{-1};
+  pszerror status{CUSZ_FAIL_UNSUPPORTED_PIPELINE};
+  // for the first: a later task, to wait for from the callback
+  std::future<psz_task*> later;
+  pszerror later_status{CUSZ_SUCCESS};
+  // for the last: that its callback has run
+  std::promise<void> last;
+};
+
+// Each callback notes its order and releases its own task; the first tries
+// to wait for a later one, and the last tells the test it is through.
+void on_compressed(psz_task* task, pszerror status, void* user)
+{
+  auto s = (seen*)user;
+  s->order = (*s->seq)++, s->status = status;
+  if (s->k == 0) s->later_status = psz_task_wait(s->later.get());
+  if (s->k == ntask - 1)
+    s->last.set_value();
+  else
+    psz_task_release(task);
+}
+
+int main()
+{
+  std::vector<T> h_data(n), h_xdata(n);
+  T *d_data[ntask], *d_xdata[ntask];
+  pszcompressor* comp[ntask];
+  GpuStreamT stream[ntask];
+  u1* archive[ntask];
+  size_t bytes[ntask];
+  pszheader header[ntask];
+  seen s[ntask];
+
+  pszctx ctx;
+  ctx.mode = Abs, ctx.eb = eb;
+  std::atomic<int> seq{0};
+
+  for (auto k = 0; k < ntask; k++) {
+    for (size_t i = 0; i < n; i++) h_data[i] = sin(0.001 * (k + 1) * i);
+    GpuMalloc(&d_data[k], n * sizeof(T));
+    GpuMalloc(&d_xdata[k], n * sizeof(T));
+    GpuMemcpy(d_data[k], h_data.data(), n * sizeof(T), GpuMemcpyH2D);
+    GpuStreamCreate(&stream[k]);
+    comp[k] = psz_create(pszdefault_framework(), F4);
+    psz_compress_init(comp[k], len, &ctx);
+    s[k].k = k, s[k].seq = &seq;
+  }
+
+  std::promise<psz_task*> later;
+  s[0].later = later.get_future();
+  auto last_done = s[ntask - 1].last.get_future();
+
+  psz_task* last;
+  for (auto k = 0; k < ntask; k++) {
+    auto t = psz_compress_async(
+        comp[k], d_data[k], len, &archive[k], &bytes[k], &header[k], nullptr,
+        stream[k], on_compressed, &s[k]);
+    if (k == 1) later.set_value(t);
+    if (k == ntask - 1) last = t;
+  }
+  last_done.wait();
+  auto polled = psz_task_poll(last);
+  psz_task_release(last);
+
+  // in the order of submission, and done before each callback
+  auto ok = polled == 1 and s[0].later_status == CUSZ_FAIL_DATA_NOT_READY;
+  for (auto k = 0; k < ntask; k++)
+    ok = ok and s[k].order == k and s[k].status == CUSZ_SUCCESS;
+
+  // back, with a wait in place of a callback
+  f8 maxerr = 0;
+  for (auto k = 0; k < ntask; k++) {
+    psz_decompress_init(comp[k], &header[k]);
+    auto t = psz_decompress_async(
+        comp[k], archive[k], bytes[k], d_xdata[k], len, nullptr, stream[k],
+        nullptr, nullptr);
+    ok = ok and psz_task_wait(t) == CUSZ_SUCCESS and psz_task_poll(t) == 1;
+    psz_task_release(t);
+
+    GpuMemcpy(h_xdata.data(), d_xdata[k], n * sizeof(T), GpuMemcpyD2H);
+    for (size_t i = 0; i < n; i++)
+      maxerr = std::max(
+          maxerr, std::fabs((f8)h_xdata[i] - sin(0.001 * (k + 1) * i)));
+
+    psz_release(comp[k]);
+    GpuStreamDestroy(stream[k]);
+    GpuFree(d_data[k]), GpuFree(d_xdata[k]);
+  }
+  ok = ok and maxerr <= eb * (1 + 1e-3);
+
+  printf("%d tasks: max error %g\n", ntask, maxerr);
+  cout << "asynchronous compression works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  return ok ? 0 : -1;
+}
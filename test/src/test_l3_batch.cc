@@ -0,0 +1,125 @@
+/**
+ * @file test_l3_batch.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-26
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "busyheader.hh"
+#include "context.h"
+#include "cusz.h"
+#include "port.hh"
+
+using T = f4;
+
+size_t const nfield = 300;
+f8 const eb = 1e-3;
+
+// a few shapes in turn, so that workers both reuse and re-initialize
+pszlen len_of(size_t i)
+{
+  static pszlen const shapes[] = {
+      {64, 32, 1, 1}, {40, 40, 8, 1}, {1000, 1, 1, 1}, {17, 23, 11, 1}};
+  return shapes[i % 4];
+}
+
+size_t volume(pszlen l) { return (size_t)l.x * l.y * l.z; }
+
+// The max error of the archive of field `i` against `h_data`, decompressed
+// on its own.
+f8 round_trip(u1* archive, size_t bytes, T* h_data, size_t len)
+{
+  pszheader header;
+  memcpy(&header, archive, sizeof(header));
+
+  u1* d_archive;
+  T *d_xdata, *h_xdata = new T[len];
+  GpuMalloc(&d_archive, bytes), GpuMalloc(&d_xdata, len * sizeof(T));
+  GpuMemcpy(d_archive, archive, bytes, GpuMemcpyH2D);
+
+  GpuStreamT stream;
+  GpuStreamCreate(&stream);
+  auto comp = psz_create(pszdefault_framework(), F4);
+  psz_decompress_init(comp, &header);
+  psz_decompress(
+      comp, d_archive, bytes, d_xdata, {header.x, header.y, header.z, 1},
+      nullptr, stream);
+  GpuStreamSync(stream);
+  GpuMemcpy(h_xdata, d_xdata, len * sizeof(T), GpuMemcpyD2H);
+
+  f8 maxerr = 0;
+  for (size_t i = 0; i < len; i++)
+    maxerr = std::max(maxerr, std::fabs((f8)h_xdata[i] - h_data[i]));
+
+  psz_release(comp);
+  GpuStreamDestroy(stream);
+  GpuFree(d_archive), GpuFree(d_xdata);
+  delete[] h_xdata;
+  return maxerr;
+}
+
+int main()
+{
+  std::vector<std::vector<T>> h_data(nfield);
+  std::vector<T*> d_data(nfield);
+  std::vector<psz_field> fields(nfield);
+
+  for (size_t i = 0; i < nfield; i++) {
+    auto len = volume(len_of(i));
+    h_data[i].resize(len);
+    for (size_t j = 0; j < len; j++)
+      h_data[i][j] = sin(0.01 * (i + 1) * j) + 0.001 * (j % 7);
+    GpuMalloc(&d_data[i], len * sizeof(T));
+    GpuMemcpy(d_data[i], h_data[i].data(), len * sizeof(T), GpuMemcpyH2D);
+    fields[i] = psz_field{d_data[i], len_of(i), eb};
+  }
+
+  pszctx ctx;
+  ctx.mode = Abs, ctx.eb = eb;
+  auto batch = psz_batch_create(pszdefault_framework(), F4, &ctx, 4);
+
+  // twice over the same workers, to the same archives
+  auto first = psz_batch_compress(batch, fields.data(), nfield);
+  std::vector<std::vector<u1>> archives(nfield);
+  for (size_t i = 0; i < nfield; i++) {
+    archives[i].assign(
+        fields[i].archive, fields[i].archive + fields[i].archive_bytes);
+    free(fields[i].archive);
+  }
+  auto second = psz_batch_compress(batch, fields.data(), nfield);
+  psz_batch_release(batch);
+
+  auto ok = first == CUSZ_SUCCESS and second == CUSZ_SUCCESS;
+  size_t nbad = 0;
+  f8 maxerr = 0;
+  for (size_t i = 0; i < nfield; i++) {
+    auto& f = fields[i];
+    auto same = f.status == CUSZ_SUCCESS and f.archive and
+                f.archive_bytes == archives[i].size() and
+                memcmp(f.archive, archives[i].data(), f.archive_bytes) == 0;
+    auto err = same ? round_trip(
+                          f.archive, f.archive_bytes, h_data[i].data(),
+                          h_data[i].size())
+                    : INFINITY;
+    if (not same or err > eb * (1 + 1e-6)) nbad++;
+    maxerr = std::max(maxerr, err);
+
+    free(f.archive);
+    GpuFree(d_data[i]);
+  }
+  ok = ok and nbad == 0;
+
+  printf("%zu fields, twice: %zu bad, max error %g\n", nfield, nbad, maxerr);
+  cout << "batch compression works as expected: " << (ok ? "yes" : "NO")
+       << endl;
+
+  return ok ? 0 : -1;
+}
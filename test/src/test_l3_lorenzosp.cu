@@ -28,7 +28,9 @@ bool batch_run_testcase(uint32_t x, uint32_t y, uint32_t z)
   // all_pass = all_pass and testcase<float, float>(x, y, z, eb, 512);
   // all_pass = all_pass and testcase<double, uint8_t>(x, y, z, eb, 128);
   // all_pass = all_pass and testcase<double, uint16_t>(x, y, z, eb, 512);
-  // all_pass = all_pass and testcase<double, uint32_t>(x, y, z, eb, 512);
+  all_pass = all_pass and testcase<double, uint32_t>(x, y, z, eb, 512);
+  // too tight for FP32 prequantization
+  all_pass = all_pass and testcase<double, uint32_t>(x, y, z, 1e-10, 512);
   // all_pass = all_pass and testcase<double, float>(x, y, z, eb, 512);
 
   // all_pass = all_pass and testcase<float, int32_t>(x, y, z, eb, 512);
@@ -0,0 +1,116 @@
+/**
+ * @file test_l3_reentrant.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-09-28
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "busyheader.hh"
+#include "context.h"
+#include "cusz.h"
+#include "port.hh"
+
+int const nthread = 64;
+
+// what a field is compressed to, to compare across runs
+struct result {
+  size_t bytes{0};
+  f8 eb{0}, maxerr{INFINITY};
+};
+
+// distinct in type, shape, values and eb for each thread
+template <typename T>
+void compress_one(int id, pszdtype type, result& r)
+{
+  pszlen len{(u4)(64 + id), 48, (u4)(8 + id % 5), 1};
+  auto n = (size_t)len.x * len.y * len.z;
+  r.eb = 1e-4 * (1 + id % 7);
+
+  std::vector<T> h_data(n), h_xdata(n);
+  for (size_t z = 0; z < len.z; z++)
+    for (size_t y = 0; y < len.y; y++)
+      for (size_t x = 0; x < len.x; x++)
+        h_data[(z * len.y + y) * len.x + x] =
+            sin(0.01 * (id + 1) * x + 0.02 * y + 0.03 * z) + 0.01 * id;
+
+  T *d_data, *d_xdata;
+  GpuMalloc(&d_data, n * sizeof(T)), GpuMalloc(&d_xdata, n * sizeof(T));
+  GpuMemcpy(d_data, h_data.data(), n * sizeof(T), GpuMemcpyH2D);
+  GpuStreamT stream;
+  GpuStreamCreate(&stream);
+
+  // the context and the header are the caller's to change after init
+  pszctx ctx;
+  ctx.mode = Abs, ctx.eb = r.eb;
+  auto comp = psz_create(pszdefault_framework(), type);
+  psz_compress_init(comp, len, &ctx);
+  ctx.eb = 1e3;
+
+  u1* d_archive;
+  pszheader header;
+  psz_compress(
+      comp, d_data, len, &d_archive, &r.bytes, &header, nullptr, stream);
+
+  psz_decompress_init(comp, &header);
+  memset(&header, 0, sizeof(header));
+  psz_decompress(comp, d_archive, r.bytes, d_xdata, len, nullptr, stream);
+  GpuStreamSync(stream);
+  GpuMemcpy(h_xdata.data(), d_xdata, n * sizeof(T), GpuMemcpyD2H);
+
+  r.maxerr = 0;
+  for (size_t i = 0; i < n; i++)
+    r.maxerr = std::max(r.maxerr, std::fabs((f8)h_xdata[i] - h_data[i]));
+
+  psz_release(comp);
+  GpuStreamDestroy(stream);
+  GpuFree(d_data), GpuFree(d_xdata);
+}
+
+void run(int id, result& r)
+{
+  if (id % 2)
+    compress_one<f8>(id, F8, r);
+  else
+    compress_one<f4>(id, F4, r);
+}
+
+int main()
+{
+  // each field alone, and then all at once, one thread for each
+  std::vector<result> serial(nthread), concurrent(nthread);
+  for (auto i = 0; i < nthread; i++) run(i, serial[i]);
+
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < nthread; i++)
+    threads.emplace_back(run, i, std::ref(concurrent[i]));
+  for (auto& t : threads) t.join();
+
+  auto ok = true;
+  for (auto i = 0; i < nthread; i++) {
+    auto &a = serial[i], &b = concurrent[i];
+    auto bounded = [](result const& r) {
+      return r.maxerr <= r.eb * (1 + 1e-3);
+    };
+    if (a.bytes != b.bytes or not bounded(a) or not bounded(b)) {
+      printf(
+          "  field %d: %zu/%zu bytes, max error %g/%g at eb %g\n", i, a.bytes,
+          b.bytes, a.maxerr, b.maxerr, a.eb);
+      ok = false;
+    }
+  }
+
+  cout << nthread
+       << " threads, each with its own compressor, work as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  return ok ? 0 : -1;
+}
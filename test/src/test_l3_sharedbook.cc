@@ -0,0 +1,96 @@
+/**
+ * @file test_l3_sharedbook.cc
+ * @author Jiannan Tian
+ * @brief
+ * @version 0.4
+ * @date 2023-10-04
+ *
+ * (C) 2023 by Indiana University, Argonne National Laboratory
+ *
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "busyheader.hh"
+#include "context.h"
+#include "cusz.h"
+#include "port.hh"
+
+using T = f4;
+
+int const npart = 4;
+f8 const eb = 1e-4;
+pszlen const len{96, 64, 8, 1};  // of a partition
+size_t const n = (size_t)len.x * len.y * len.z;
+
+// Partitions of one field encoded with one book, each in progressive layers
+// that keep books of their own; decompressed in full with the book given.
+int main()
+{
+  pszctx ctx;
+  ctx.mode = Abs, ctx.eb = eb;
+  ctx.prog_layers = 3, ctx.prog_ratio = 10;
+
+  std::vector<std::vector<T>> h_data(npart, std::vector<T>(n));
+  std::vector<T> h_xdata(n);
+  T *d_data[npart], *d_xdata;
+  pszcompressor* comp[npart];
+  GpuStreamT stream;
+  GpuStreamCreate(&stream);
+  GpuMalloc(&d_xdata, n * sizeof(T));
+
+  std::vector<u4> freq(2 * ctx.radius, 0), part(2 * ctx.radius);
+  for (auto p = 0; p < npart; p++) {
+    for (size_t i = 0; i < n; i++)
+      h_data[p][i] = sin(0.002 * (p + 1) * i) + 0.01 * cos(0.3 * i);
+    GpuMalloc(&d_data[p], n * sizeof(T));
+    GpuMemcpy(d_data[p], h_data[p].data(), n * sizeof(T), GpuMemcpyH2D);
+
+    comp[p] = psz_create(pszdefault_framework(), F4);
+    psz_compress_init(comp[p], len, &ctx);
+    psz_compress_histogram(comp[p], d_data[p], len, part.data(), stream);
+    for (size_t b = 0; b < freq.size(); b++) freq[b] += part[b];
+  }
+  auto book = psz_book_create(freq.data(), 2 * ctx.radius);
+
+  auto ok = true;
+  f8 maxerr = 0;
+  for (auto p = 0; p < npart; p++) {
+    u1* d_archive;
+    size_t bytes;
+    pszheader header;
+    psz_use_book(comp[p], book);
+    auto err = psz_compress(
+        comp[p], d_data[p], len, &d_archive, &bytes, &header, nullptr,
+        stream);
+    ok = ok and err == CUSZ_SUCCESS and
+         header.shared_book == psz_book_id(book);
+
+    auto decomp = psz_create(pszdefault_framework(), F4);
+    psz_decompress_init(decomp, &header);
+    psz_use_book(decomp, book);
+    psz_decompress(decomp, d_archive, bytes, d_xdata, len, nullptr, stream);
+    GpuStreamSync(stream);
+    GpuMemcpy(h_xdata.data(), d_xdata, n * sizeof(T), GpuMemcpyD2H);
+    for (size_t i = 0; i < n; i++)
+      maxerr = std::max(maxerr, std::fabs((f8)h_xdata[i] - h_data[p][i]));
+
+    psz_release(decomp);
+    psz_release(comp[p]);
+    GpuFree(d_data[p]);
+  }
+  ok = ok and maxerr <= eb * (1 + 1e-3);
+
+  psz_book_release(book);
+  GpuFree(d_xdata);
+  GpuStreamDestroy(stream);
+
+  printf(
+      "%d partitions, %d layers each: max error %g\n", npart,
+      ctx.prog_layers, maxerr);
+  cout << "shared book with progressive layers works as expected: "
+       << (ok ? "yes" : "NO") << endl;
+
+  return ok ? 0 : -1;
+}